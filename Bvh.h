@@ -0,0 +1,506 @@
+#pragma once
+#ifndef BVH_H
+#define BVH_H
+
+#include <glm/glm.hpp>
+#include <Frustum.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+
+struct BoundingBox
+{
+	glm::vec3 min = glm::vec3(FLT_MAX);
+	glm::vec3 max = glm::vec3(-FLT_MAX);
+
+	BoundingBox() {}
+	BoundingBox(const glm::vec3& boxMin, const glm::vec3& boxMax) : min(boxMin), max(boxMax) {}
+
+	void grow(const glm::vec3& p)
+	{
+		min = glm::min(min, p);
+		max = glm::max(max, p);
+	}
+
+	void grow(const BoundingBox& box)
+	{
+		min = glm::min(min, box.min);
+		max = glm::max(max, box.max);
+	}
+
+	glm::vec3 center() const { return (min + max) * 0.5f; }
+
+	// half the surface area, all the SAH cares about is the ratio between boxes
+	float area() const
+	{
+		if (min.x > max.x)
+			return 0.0f;
+		glm::vec3 e = max - min;
+		return e.x * e.y + e.y * e.z + e.z * e.x;
+	}
+};
+
+// 32 bytes. a leaf (count > 0) holds objectIndices[leftFirst, leftFirst + count),
+// an inner node's children are nodes[leftFirst] and nodes[leftFirst + 1]
+struct BvhNode
+{
+	glm::vec3 boxMin;
+	unsigned int leftFirst;
+	glm::vec3 boxMax;
+	unsigned int count;
+
+	bool isLeaf() const { return count > 0; }
+};
+
+// Bounding volume hierarchy over object bounding boxes, built top down with a binned surface area heuristic.
+// children always come after their parent in nodes, which is what makes refit() a single backwards pass.
+//
+// moving objects: refit() keeps the tree and just grows/shrinks the boxes, which is cheap but lets the
+// tree get worse as things move further. rebuildDegraded() then rebuilds only the subtrees whose box grew
+// too much compared to when they were built.
+class Bvh
+{
+public:
+	std::vector<BvhNode> nodes;
+	std::vector<unsigned int> objectIndices;
+
+	void build(const std::vector<BoundingBox>& boxes)
+	{
+		objectBoxes = boxes;
+		objectIndices.resize(boxes.size());
+		centroids.resize(boxes.size());
+		for (unsigned int i = 0; i < boxes.size(); i++)
+		{
+			objectIndices[i] = i;
+			centroids[i] = boxes[i].center();
+		}
+
+		nodes.clear();
+		builtArea.clear();
+		depths.clear();
+		nodes.reserve(boxes.size() * 2);
+		builtArea.reserve(boxes.size() * 2);
+		depths.reserve(boxes.size() * 2);
+		nodes.push_back(BvhNode());
+		builtArea.push_back(0.0f);
+		depths.push_back(0);
+		freedNodes = 0;
+		subdivide(0, 0, (unsigned int)boxes.size(), 0);
+	}
+
+	// the objects moved but there are still as many of them, boxes[i] is object i
+	void refit(const std::vector<BoundingBox>& boxes)
+	{
+		objectBoxes = boxes;
+		for (unsigned int i = 0; i < boxes.size(); i++)
+			centroids[i] = boxes[i].center();
+
+		for (int n = (int)nodes.size() - 1; n >= 0; n--)
+		{
+			BvhNode& node = nodes[n];
+			BoundingBox box;
+			if (node.isLeaf())
+			{
+				for (unsigned int i = 0; i < node.count; i++)
+					box.grow(objectBoxes[objectIndices[node.leftFirst + i]]);
+			}
+			else
+			{
+				box.grow(BoundingBox(nodes[node.leftFirst].boxMin, nodes[node.leftFirst].boxMax));
+				box.grow(BoundingBox(nodes[node.leftFirst + 1].boxMin, nodes[node.leftFirst + 1].boxMax));
+			}
+			node.boxMin = box.min;
+			node.boxMax = box.max;
+		}
+	}
+
+	// after refit(): rebuilds every subtree whose box is now more than threshold times the area it had
+	// when it was built. returns how many subtrees were rebuilt
+	unsigned int rebuildDegraded(float threshold = 2.0f)
+	{
+		if (nodes.empty())
+			return 0;
+		if (nodeArea(0) > threshold * builtArea[0])
+		{
+			build(objectBoxes);
+			return 1;
+		}
+
+		unsigned int rebuilt = 0;
+		std::vector<unsigned int> stack(1, 0);
+		while (!stack.empty())
+		{
+			unsigned int n = stack.back();
+			stack.pop_back();
+			if (nodes[n].isLeaf())
+				continue;
+
+			if (nodeArea(n) > threshold * builtArea[n])
+			{
+				// the subtree's objects are one contiguous range, its old nodes just stop being used
+				unsigned int first, count;
+				objectRange(n, first, count);
+				freedNodes += subtreeNodeCount(n) - 1;
+				subdivide(n, first, count, depths[n]);
+				rebuilt++;
+				continue;
+			}
+			stack.push_back(nodes[n].leftFirst);
+			stack.push_back(nodes[n].leftFirst + 1);
+		}
+
+		// too many dead nodes in the array, start over
+		if (freedNodes > nodes.size() / 2)
+			build(objectBoxes);
+		return rebuilt;
+	}
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- queries
+	// ---------------------------------------------------------
+
+	// appends every object whose box intersects the frustum
+	void queryFrustum(const Frustum& frustum, std::vector<unsigned int>& out) const
+	{
+		if (nodes.empty() || objectIndices.empty())
+			return;
+		unsigned int stack[MAX_DEPTH * 2];
+		int top = 0;
+		stack[top++] = 0;
+		while (top > 0)
+		{
+			unsigned int n = stack[--top];
+			const BvhNode& node = nodes[n];
+			if (!frustum.intersectsAABB(node.boxMin, node.boxMax))
+				continue;
+
+			// completely inside, everything below goes in without any more tests
+			if (frustum.containsAABB(node.boxMin, node.boxMax))
+			{
+				appendSubtree(n, out);
+				continue;
+			}
+
+			if (node.isLeaf())
+			{
+				for (unsigned int i = 0; i < node.count; i++)
+				{
+					unsigned int object = objectIndices[node.leftFirst + i];
+					if (frustum.intersectsAABB(objectBoxes[object].min, objectBoxes[object].max))
+						out.push_back(object);
+				}
+			}
+			else
+			{
+				stack[top++] = node.leftFirst;
+				stack[top++] = node.leftFirst + 1;
+			}
+		}
+	}
+
+	// closest object box hit by the ray within maxDistance. direction doesn't need to be normalized,
+	// distance is in multiples of it
+	bool raycast(const glm::vec3& origin, const glm::vec3& direction, unsigned int& hitObject, float& hitDistance, float maxDistance = FLT_MAX) const
+	{
+		if (nodes.empty() || objectIndices.empty())
+			return false;
+		glm::vec3 invDir = 1.0f / direction;
+		hitDistance = maxDistance;
+		bool hit = false;
+
+		unsigned int stack[MAX_DEPTH * 2];
+		int top = 0;
+		stack[top++] = 0;
+		while (top > 0)
+		{
+			const BvhNode& node = nodes[stack[--top]];
+			if (rayBox(origin, invDir, node.boxMin, node.boxMax, hitDistance) == FLT_MAX)
+				continue;
+
+			if (node.isLeaf())
+			{
+				for (unsigned int i = 0; i < node.count; i++)
+				{
+					unsigned int object = objectIndices[node.leftFirst + i];
+					float t = rayBox(origin, invDir, objectBoxes[object].min, objectBoxes[object].max, hitDistance);
+					if (t < hitDistance)
+					{
+						hitDistance = t;
+						hitObject = object;
+						hit = true;
+					}
+				}
+				continue;
+			}
+
+			// push the far child first so the near one gets visited first and shrinks hitDistance early
+			unsigned int nearChild = node.leftFirst, farChild = node.leftFirst + 1;
+			float nearT = rayBox(origin, invDir, nodes[nearChild].boxMin, nodes[nearChild].boxMax, hitDistance);
+			float farT = rayBox(origin, invDir, nodes[farChild].boxMin, nodes[farChild].boxMax, hitDistance);
+			if (farT < nearT)
+			{
+				std::swap(nearChild, farChild);
+				std::swap(nearT, farT);
+			}
+			if (farT != FLT_MAX)
+				stack[top++] = farChild;
+			if (nearT != FLT_MAX)
+				stack[top++] = nearChild;
+		}
+		return hit;
+	}
+
+	// appends every object whose box is within radius of center
+	void queryRange(const glm::vec3& center, float radius, std::vector<unsigned int>& out) const
+	{
+		if (nodes.empty() || objectIndices.empty())
+			return;
+		unsigned int stack[MAX_DEPTH * 2];
+		int top = 0;
+		stack[top++] = 0;
+		while (top > 0)
+		{
+			const BvhNode& node = nodes[stack[--top]];
+			if (!sphereBox(center, radius, node.boxMin, node.boxMax))
+				continue;
+
+			if (node.isLeaf())
+			{
+				for (unsigned int i = 0; i < node.count; i++)
+				{
+					unsigned int object = objectIndices[node.leftFirst + i];
+					if (sphereBox(center, radius, objectBoxes[object].min, objectBoxes[object].max))
+						out.push_back(object);
+				}
+			}
+			else
+			{
+				stack[top++] = node.leftFirst;
+				stack[top++] = node.leftFirst + 1;
+			}
+		}
+	}
+
+	// SAH cost of the tree relative to the root, lower is better. inner nodes cost 1, leaves their object count
+	float sahCost() const
+	{
+		if (nodes.empty() || nodeArea(0) == 0.0f)
+			return 0.0f;
+		float cost = 0.0f;
+		std::vector<unsigned int> stack(1, 0);
+		while (!stack.empty())
+		{
+			const BvhNode& node = nodes[stack.back()];
+			stack.pop_back();
+			float area = BoundingBox(node.boxMin, node.boxMax).area();
+			if (node.isLeaf())
+				cost += area * node.count;
+			else
+			{
+				cost += area;
+				stack.push_back(node.leftFirst);
+				stack.push_back(node.leftFirst + 1);
+			}
+		}
+		return cost / nodeArea(0);
+	}
+
+	// nodes still in the tree, leaving out the ones a partial rebuild left behind
+	unsigned int nodeCount() const { return (unsigned int)nodes.size() - freedNodes; }
+
+	// the ray/box and sphere/box tests the queries use, public so a plain loop over the objects
+	// can do exactly the same work for comparison
+	static float rayBox(const glm::vec3& origin, const glm::vec3& invDir, const glm::vec3& boxMin, const glm::vec3& boxMax, float maxDistance)
+	{
+		glm::vec3 t0 = (boxMin - origin) * invDir;
+		glm::vec3 t1 = (boxMax - origin) * invDir;
+		glm::vec3 tNear = glm::min(t0, t1);
+		glm::vec3 tFar = glm::max(t0, t1);
+		float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+		float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+		return enter <= exit ? enter : FLT_MAX;
+	}
+
+	static bool sphereBox(const glm::vec3& center, float radius, const glm::vec3& boxMin, const glm::vec3& boxMax)
+	{
+		glm::vec3 d = center - glm::clamp(center, boxMin, boxMax);
+		return glm::dot(d, d) <= radius * radius;
+	}
+
+private:
+	static const unsigned int BINS = 16;
+	static const unsigned int MAX_LEAF_SIZE = 8;
+	// past this depth nodes get median splits, which keeps the tree shallow enough for fixed size traversal stacks
+	static const unsigned int SAH_DEPTH = 40;
+	static const unsigned int MAX_DEPTH = SAH_DEPTH + 32;
+
+	std::vector<BoundingBox> objectBoxes;
+	std::vector<glm::vec3> centroids;
+	std::vector<float> builtArea; // area of each node when it was built
+	std::vector<unsigned char> depths;
+	unsigned int freedNodes = 0;
+
+	float nodeArea(unsigned int n) const
+	{
+		return BoundingBox(nodes[n].boxMin, nodes[n].boxMax).area();
+	}
+
+	// builds the subtree of objects [first, first + count) into nodes[nodeIndex], the children get appended
+	void subdivide(unsigned int nodeIndex, unsigned int first, unsigned int count, unsigned int depth)
+	{
+		BoundingBox box, centroidBox;
+		for (unsigned int i = first; i < first + count; i++)
+		{
+			box.grow(objectBoxes[objectIndices[i]]);
+			centroidBox.grow(centroids[objectIndices[i]]);
+		}
+		nodes[nodeIndex].boxMin = box.min;
+		nodes[nodeIndex].boxMax = box.max;
+		nodes[nodeIndex].leftFirst = first;
+		nodes[nodeIndex].count = count;
+		builtArea[nodeIndex] = box.area();
+		depths[nodeIndex] = (unsigned char)depth;
+		if (count <= 2)
+			return;
+		if (depth >= SAH_DEPTH)
+		{
+			if (count > MAX_LEAF_SIZE)
+				splitMedian(nodeIndex, first, count, centroidBox, depth);
+			return;
+		}
+
+		// find the cheapest split plane on the bin boundaries of every axis
+		int bestAxis = -1;
+		unsigned int bestSplit = 0;
+		float bestCost = FLT_MAX;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float axisMin = centroidBox.min[axis];
+			float extent = centroidBox.max[axis] - axisMin;
+			if (extent <= 0.0f)
+				continue;
+
+			BoundingBox binBoxes[BINS];
+			unsigned int binCounts[BINS] = {};
+			float scale = BINS / extent;
+			for (unsigned int i = first; i < first + count; i++)
+			{
+				unsigned int object = objectIndices[i];
+				unsigned int bin = std::min(BINS - 1, (unsigned int)((centroids[object][axis] - axisMin) * scale));
+				binCounts[bin]++;
+				binBoxes[bin].grow(objectBoxes[object]);
+			}
+
+			// sweep from both sides to get the area and count left and right of every plane
+			float leftArea[BINS - 1], rightArea[BINS - 1];
+			unsigned int leftCount[BINS - 1], rightCount[BINS - 1];
+			BoundingBox leftBox, rightBox;
+			unsigned int leftSum = 0, rightSum = 0;
+			for (unsigned int i = 0; i < BINS - 1; i++)
+			{
+				leftSum += binCounts[i];
+				leftBox.grow(binBoxes[i]);
+				leftCount[i] = leftSum;
+				leftArea[i] = leftBox.area();
+
+				rightSum += binCounts[BINS - 1 - i];
+				rightBox.grow(binBoxes[BINS - 1 - i]);
+				rightCount[BINS - 2 - i] = rightSum;
+				rightArea[BINS - 2 - i] = rightBox.area();
+			}
+
+			for (unsigned int i = 0; i < BINS - 1; i++)
+			{
+				if (leftCount[i] == 0 || rightCount[i] == 0)
+					continue;
+				float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = i;
+				}
+			}
+		}
+
+		// splitting has to beat testing every object here (plus one traversal step)
+		float leafCost = count * box.area();
+		if (bestAxis < 0 || bestCost + box.area() >= leafCost)
+		{
+			if (count <= MAX_LEAF_SIZE)
+				return;
+			// too big for a leaf anyway, fall back to a median split
+			if (bestAxis < 0)
+			{
+				splitMedian(nodeIndex, first, count, centroidBox, depth);
+				return;
+			}
+		}
+
+		float axisMin = centroidBox.min[bestAxis];
+		float scale = BINS / (centroidBox.max[bestAxis] - axisMin);
+		unsigned int* begin = objectIndices.data() + first;
+		unsigned int* middle = std::partition(begin, begin + count, [&](unsigned int object)
+			{
+				return std::min(BINS - 1, (unsigned int)((centroids[object][bestAxis] - axisMin) * scale)) <= bestSplit;
+			});
+		unsigned int leftCount = (unsigned int)(middle - begin);
+		if (leftCount == 0 || leftCount == count)
+			leftCount = count / 2;
+		splitChildren(nodeIndex, first, count, leftCount, depth);
+	}
+
+	// half the objects on each side, along the longest axis of their centers
+	void splitMedian(unsigned int nodeIndex, unsigned int first, unsigned int count, const BoundingBox& centroidBox, unsigned int depth)
+	{
+		glm::vec3 extent = centroidBox.max - centroidBox.min;
+		int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+		unsigned int* begin = objectIndices.data() + first;
+		std::nth_element(begin, begin + count / 2, begin + count, [&](unsigned int a, unsigned int b)
+			{
+				return centroids[a][axis] < centroids[b][axis];
+			});
+		splitChildren(nodeIndex, first, count, count / 2, depth);
+	}
+
+	void splitChildren(unsigned int nodeIndex, unsigned int first, unsigned int count, unsigned int leftCount, unsigned int depth)
+	{
+		unsigned int left = (unsigned int)nodes.size();
+		nodes.resize(nodes.size() + 2);
+		builtArea.resize(builtArea.size() + 2);
+		depths.resize(depths.size() + 2);
+		nodes[nodeIndex].leftFirst = left;
+		nodes[nodeIndex].count = 0;
+		subdivide(left, first, leftCount, depth + 1);
+		subdivide(left + 1, first + leftCount, count - leftCount, depth + 1);
+	}
+
+	// an inner node's objects go from its leftmost leaf to the end of its rightmost one
+	void objectRange(unsigned int n, unsigned int& first, unsigned int& count) const
+	{
+		unsigned int leftmost = n, rightmost = n;
+		while (!nodes[leftmost].isLeaf())
+			leftmost = nodes[leftmost].leftFirst;
+		while (!nodes[rightmost].isLeaf())
+			rightmost = nodes[rightmost].leftFirst + 1;
+		first = nodes[leftmost].leftFirst;
+		count = nodes[rightmost].leftFirst + nodes[rightmost].count - first;
+	}
+
+	unsigned int subtreeNodeCount(unsigned int n) const
+	{
+		if (nodes[n].isLeaf())
+			return 1;
+		return 1 + subtreeNodeCount(nodes[n].leftFirst) + subtreeNodeCount(nodes[n].leftFirst + 1);
+	}
+
+	void appendSubtree(unsigned int n, std::vector<unsigned int>& out) const
+	{
+		unsigned int first, count;
+		objectRange(n, first, count);
+		out.insert(out.end(), objectIndices.begin() + first, objectIndices.begin() + first + count);
+	}
+};
+
+#endif // !BVH_H
@@ -0,0 +1,186 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <Frustum.h>
+#include <Bvh.h>
+
+// Linear scans against the BVH for the queries the demos need: frustum culling, ray picking
+// and range queries. no window or GL context, it's all on the cpu.
+//
+// usage: BvhBenchmark [--count N] [--queries N]
+// without --count it runs 10k, 100k and 1M objects
+
+// small deterministic generator so every run gets the same scene
+struct Random
+{
+	unsigned int state;
+	Random(unsigned int seed) : state(seed) {}
+	float next()
+	{
+		state = state * 1664525u + 1013904223u;
+		return (state >> 8) * (1.0f / 16777216.0f);
+	}
+	float range(float min, float max) { return min + (max - min) * next(); }
+};
+
+double millisecondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// unit cubes with random rotations, boxed by their bounding sphere. the world grows with the count
+// so the density stays the same
+std::vector<BoundingBox> makeCubes(unsigned int count, float worldSize, Random& random)
+{
+	const float radius = 0.87f;
+	std::vector<BoundingBox> boxes(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		glm::vec3 center(random.range(-worldSize, worldSize), random.range(-worldSize, worldSize), random.range(-worldSize, worldSize));
+		boxes[i] = BoundingBox(center - glm::vec3(radius), center + glm::vec3(radius));
+	}
+	return boxes;
+}
+
+void runBenchmark(unsigned int count, unsigned int queries)
+{
+	Random random(1234u + count);
+	float worldSize = 2.0f * cbrtf((float)count);
+	std::vector<BoundingBox> boxes = makeCubes(count, worldSize, random);
+
+	std::cout << "---- " << count << " objects" << std::endl;
+
+	// ---- build
+	Bvh bvh;
+	auto start = std::chrono::high_resolution_clock::now();
+	bvh.build(boxes);
+	std::cout << "build          " << std::setw(10) << millisecondsSince(start) << " ms, " << bvh.nodeCount()
+		<< " nodes, SAH cost " << bvh.sahCost() << std::endl;
+
+	// ---- frustum culling from a few cameras inside the scene
+	double linearMs = 0.0, bvhMs = 0.0;
+	size_t linearVisible = 0, bvhVisible = 0;
+	std::vector<unsigned int> visible;
+	visible.reserve(count);
+	for (unsigned int q = 0; q < 16; q++)
+	{
+		glm::vec3 eye(random.range(-worldSize, worldSize), random.range(-worldSize, worldSize), random.range(-worldSize, worldSize));
+		glm::vec3 target(random.range(-worldSize, worldSize), random.range(-worldSize, worldSize), random.range(-worldSize, worldSize));
+		glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, worldSize * 0.5f);
+		Frustum frustum(projection * glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+		start = std::chrono::high_resolution_clock::now();
+		for (unsigned int i = 0; i < count; i++)
+			if (frustum.intersectsAABB(boxes[i].min, boxes[i].max))
+				linearVisible++;
+		linearMs += millisecondsSince(start);
+
+		visible.clear();
+		start = std::chrono::high_resolution_clock::now();
+		bvh.queryFrustum(frustum, visible);
+		bvhMs += millisecondsSince(start);
+		bvhVisible += visible.size();
+	}
+	std::cout << "frustum        linear " << std::setw(10) << linearMs / 16 << " ms   bvh " << std::setw(10) << bvhMs / 16
+		<< " ms   (" << linearVisible / 16 << " / " << bvhVisible / 16 << " visible)" << std::endl;
+
+	// ---- ray picking, closest hit
+	linearMs = 0.0;
+	bvhMs = 0.0;
+	unsigned int mismatches = 0;
+	for (unsigned int q = 0; q < queries; q++)
+	{
+		glm::vec3 origin(random.range(-worldSize, worldSize), random.range(-worldSize, worldSize), random.range(-worldSize, worldSize));
+		glm::vec3 direction = glm::normalize(glm::vec3(random.range(-1.0f, 1.0f), random.range(-1.0f, 1.0f), random.range(-1.0f, 1.0f)));
+		glm::vec3 invDir = 1.0f / direction;
+
+		start = std::chrono::high_resolution_clock::now();
+		float linearDistance = FLT_MAX;
+		for (unsigned int i = 0; i < count; i++)
+			linearDistance = std::min(linearDistance, Bvh::rayBox(origin, invDir, boxes[i].min, boxes[i].max, linearDistance));
+		linearMs += millisecondsSince(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		unsigned int hitObject = 0;
+		float bvhDistance = FLT_MAX;
+		bvh.raycast(origin, direction, hitObject, bvhDistance);
+		bvhMs += millisecondsSince(start);
+
+		if (linearDistance != bvhDistance)
+			mismatches++;
+	}
+	std::cout << "raycast        linear " << std::setw(10) << linearMs / queries << " ms   bvh " << std::setw(10) << bvhMs / queries
+		<< " ms   (" << mismatches << " mismatches)" << std::endl;
+
+	// ---- range queries
+	linearMs = 0.0;
+	bvhMs = 0.0;
+	size_t linearFound = 0, bvhFound = 0;
+	std::vector<unsigned int> found;
+	for (unsigned int q = 0; q < queries; q++)
+	{
+		glm::vec3 center(random.range(-worldSize, worldSize), random.range(-worldSize, worldSize), random.range(-worldSize, worldSize));
+		const float radius = 5.0f;
+
+		start = std::chrono::high_resolution_clock::now();
+		for (unsigned int i = 0; i < count; i++)
+			if (Bvh::sphereBox(center, radius, boxes[i].min, boxes[i].max))
+				linearFound++;
+		linearMs += millisecondsSince(start);
+
+		found.clear();
+		start = std::chrono::high_resolution_clock::now();
+		bvh.queryRange(center, radius, found);
+		bvhMs += millisecondsSince(start);
+		bvhFound += found.size();
+	}
+	std::cout << "range          linear " << std::setw(10) << linearMs / queries << " ms   bvh " << std::setw(10) << bvhMs / queries
+		<< " ms   (" << linearFound << " / " << bvhFound << " found)" << std::endl;
+
+	// ---- everything moves a little, then refit and rebuild what got too bad
+	for (unsigned int step = 0; step < 3; step++)
+	{
+		for (unsigned int i = 0; i < count; i++)
+		{
+			glm::vec3 offset(random.range(-2.0f, 2.0f), random.range(-2.0f, 2.0f), random.range(-2.0f, 2.0f));
+			boxes[i] = BoundingBox(boxes[i].min + offset, boxes[i].max + offset);
+		}
+		start = std::chrono::high_resolution_clock::now();
+		bvh.refit(boxes);
+		double refitMs = millisecondsSince(start);
+		float refitCost = bvh.sahCost();
+		start = std::chrono::high_resolution_clock::now();
+		unsigned int rebuilt = bvh.rebuildDegraded();
+		std::cout << "move " << step << "         refit " << std::setw(10) << refitMs << " ms (SAH cost " << refitCost
+			<< ")   rebuild " << std::setw(10) << millisecondsSince(start) << " ms (" << rebuilt << " subtrees, SAH cost " << bvh.sahCost() << ")" << std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned int count = 0;
+	unsigned int queries = 256;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+			count = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--queries") == 0 && i + 1 < argc)
+			queries = (unsigned int)atoi(argv[++i]);
+	}
+
+	std::cout << std::fixed << std::setprecision(3);
+	if (count > 0)
+		runBenchmark(count, queries);
+	else
+	{
+		runBenchmark(10000, queries);
+		runBenchmark(100000, queries);
+		runBenchmark(1000000, queries);
+	}
+	return 0;
+}
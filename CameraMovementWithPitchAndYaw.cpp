@@ -7,11 +7,15 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <SceneGenerator.h>
+#include <Bvh.h>
+#include <FramePacing.h>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
@@ -40,8 +44,15 @@ float lastX = 800.0f / 2.0;
 float lastY = 600.0 / 2.0;
 float fov = 45.0f;
 
-int main()
+// set by a left click, the cube in the middle of the screen gets picked in the render loop
+bool picking = false;
+
+int main(int argc, char* argv[])
 {
+	// --swap <vsync|adaptive|uncapped>, --fps-limit N and --wait-present pick the frame pacing (see FramePacing.h)
+	FramePacingOptions pacing;
+	parseFramePacingOptions(argc, argv, pacing);
+
 	// ---------------------------------------------------------
 	// --------------------------------------------------------- GlAD, GLFW and OpenGL setup
 	// ---------------------------------------------------------
@@ -76,6 +87,7 @@ int main()
 
 	// a callback to know the mouse position and calculate the direction of the camera
 	glfwSetCursorPosCallback(window, mouse_callback);
+	glfwSetMouseButtonCallback(window, mouse_button_callback);
 
 	// to get mouse scroller input
 	glfwSetScrollCallback(window, scroll_callback);
@@ -164,6 +176,27 @@ int main()
 		glm::vec3(-1.3f, 1.0f, -1.5f)
 	};
 
+	// --scene swaps the ten cubes above for a generated scene (see SceneGenerator.h)
+	SceneOptions sceneOptions;
+	std::vector<SceneObject> cubes;
+	if (parseSceneOptions(argc, argv, sceneOptions))
+		cubes = generateScene(sceneOptions);
+	else
+		for (unsigned int i = 0; i < 10; i++)
+			cubes.push_back(SceneObject(cubePositions[i], glm::vec3(0.5f, 1.0f, 0.0f), 20.0f * i + 10));
+	std::cout << cubes.size() << " cubes" << std::endl;
+
+	// bvh over the cubes for culling and picking. cubes are rotated so their bounding spheres get boxed
+	std::vector<BoundingBox> cubeBounds;
+	for (unsigned int i = 0; i < cubes.size(); i++)
+	{
+		float radius = 0.87f * std::max(cubes[i].scale.x, std::max(cubes[i].scale.y, cubes[i].scale.z));
+		cubeBounds.push_back(BoundingBox(cubes[i].position - glm::vec3(radius), cubes[i].position + glm::vec3(radius)));
+	}
+	Bvh cubeBvh;
+	cubeBvh.build(cubeBounds);
+	std::vector<unsigned int> visibleCubes;
+
 	unsigned int VBO, VAO;
 	glGenBuffers(1, &VBO);
 	glGenVertexArrays(1, &VAO);
@@ -270,6 +303,16 @@ int main()
 	glm::mat4 view = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
 	glm::mat4 projection = glm::mat4(1.0f);
 
+	// the swap interval is part of the context, it's set once it's current
+	int swapInterval = applySwapMode(pacing.swapMode);
+	FrameLimiter limiter(pacing.fpsLimit);
+	LatencyTracker latency;
+	std::cout << "swap interval " << swapInterval << ", fps limit " << pacing.fpsLimit << (pacing.waitForPresent ? ", waiting for present" : "") << std::endl;
+
+	double statsStart = glfwGetTime();
+	unsigned int statsFrames = 0;
+	double statsWaitMs = 0.0;
+
 	while (!glfwWindowShouldClose(window))
 	{
 		// ---- Calculating deltaTime
@@ -277,8 +320,9 @@ int main()
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
 
-		// ---- input handler
+		// ---- input handler, the events were polled at the end of the last loop
 		processInput(window);
+		latency.inputSampled();
 
 		// ----- Rendering stuff
 
@@ -296,21 +340,61 @@ int main()
 		ourShader.setMat4("view", view);
 		ourShader.setMat4("projection", projection);
 
+		// the ray goes straight out of the camera, through the middle of the screen
+		if (picking)
+		{
+			picking = false;
+			unsigned int pickedCube;
+			float distance;
+			if (cubeBvh.raycast(cameraPos, cameraFront, pickedCube, distance, 100.0f))
+				std::cout << "picked cube " << pickedCube << " at distance " << distance << std::endl;
+		}
+
+		// only draw the cubes inside the view
+		visibleCubes.clear();
+		cubeBvh.queryFrustum(Frustum(projection * view), visibleCubes);
+
 		ourShader.use();
 		glBindVertexArray(VAO);
-		for (unsigned int i = 0; i < 10; i++)
+		unsigned int boundTexture = 0;
+		for (unsigned int v = 0; v < visibleCubes.size(); v++)
 		{
-			glm::mat4 model = glm::mat4(1.0f);
-			model = glm::translate(model, cubePositions[i]);
-			float angle = 20.0f * i;
-			model = glm::rotate(model, glm::radians(angle + 10), glm::vec3(0.5f, 1.0f, 0.0f));
-			ourShader.setMat4("model", model);
+			unsigned int i = visibleCubes[v];
+			// generated cubes swap which texture is the base and which the overlay
+			if (cubes[i].texture != boundTexture)
+			{
+				boundTexture = cubes[i].texture;
+				glActiveTexture(GL_TEXTURE0);
+				glBindTexture(GL_TEXTURE_2D, boundTexture == 0 ? texture1 : texture2);
+				glActiveTexture(GL_TEXTURE1);
+				glBindTexture(GL_TEXTURE_2D, boundTexture == 0 ? texture2 : texture1);
+			}
+			ourShader.setMat4("model", cubes[i].modelMatrix());
 
 			glDrawArrays(GL_TRIANGLES, 0, 36);
 		}
 
 		// double buffer mechanism to render things smoothly without user seeing the acutal drawings
 		glfwSwapBuffers(window);
+		if (pacing.waitForPresent)
+			glFinish();
+		latency.presented();
+
+		statsFrames++;
+		statsWaitMs += limiter.lastWaitMs();
+		if (glfwGetTime() - statsStart >= 1.0)
+		{
+			std::cout << statsFrames << " fps, limiter wait " << statsWaitMs / statsFrames << " ms/frame (margin " << limiter.marginMs()
+				<< " ms) | input to present avg " << latency.averageMs() << " ms, p99 " << latency.percentileMs(0.99)
+				<< " ms, max " << latency.maxMs() << " ms" << std::endl;
+			statsStart = glfwGetTime();
+			statsFrames = 0;
+			statsWaitMs = 0.0;
+			latency.reset();
+		}
+
+		// sleep off the rest of the frame before polling, so the input the next frame uses is as fresh as it gets
+		limiter.wait();
 		// checks if any events are created
 		glfwPollEvents();
 	}
@@ -389,4 +473,10 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 		fov = 1.0f;
 	else if (fov >= 45.0f)
 		fov = 45.0f;
+}
+
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
+{
+	if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
+		picking = true;
 }
\ No newline at end of file
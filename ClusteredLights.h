@@ -0,0 +1,230 @@
+#pragma once
+#ifndef CLUSTERED_LIGHTS_H
+#define CLUSTERED_LIGHTS_H
+
+#include <JobSystem.h>
+#include <PointLights.h>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+// Clustered light assignment (Olsson et al. 2012): the view frustum is cut into a grid of screen tiles and
+// exponential depth slices, every light is put into the clusters its sphere touches, and a fragment only
+// loops over the lights of the cluster it falls in.
+//
+// build() takes view space lights and fills two arrays the shader reads as texture buffers:
+// clusters, an (offset, count) pair per cluster into indices, and indices, the light numbers one cluster after the other.
+// cluster (x, y, z) is number (z * tilesY + y) * tilesX + x, x and y from the bottom left like gl_FragCoord
+class LightClusters
+{
+public:
+	LightClusters(unsigned int tilesX = 16, unsigned int tilesY = 9, unsigned int slices = 24)
+		: tilesX(tilesX), tilesY(tilesY), slices(slices), totalReferences(0), maxPerCluster(0),
+		projectionX(0.0f), projectionY(0.0f), zNear(0.0f), zFar(0.0f)
+	{
+		clusters.resize(clusterCount() * 2, 0);
+		bounds.resize(clusterCount());
+		sliceLights.resize(slices);
+		sliceIndices.resize(slices);
+	}
+
+	// bins the lights for this projection, spread over the job system. near and far are the ones the
+	// projection was made with, depth slices go exponentially between them
+	void build(const std::vector<PointLight>& viewLights, const glm::mat4& projection, float near, float far, JobSystem& jobs)
+	{
+		if (projection[0][0] != projectionX || projection[1][1] != projectionY || near != zNear || far != zFar)
+			computeBounds(projection[0][0], projection[1][1], near, far);
+
+		// ---- which tiles and slices every light can reach
+		ranges.resize(viewLights.size());
+		jobs.parallelFor((unsigned int)viewLights.size(), 256, [&](unsigned int first, unsigned int last) {
+			for (unsigned int i = first; i < last; i++)
+				ranges[i] = lightRange(viewLights[i]);
+		});
+
+		// ---- lights per slice, in light order so the result is the same for every thread count
+		for (unsigned int z = 0; z < slices; z++)
+			sliceLights[z].clear();
+		for (unsigned int i = 0; i < ranges.size(); i++)
+		{
+			for (int z = ranges[i].z0; z <= ranges[i].z1; z++)
+				sliceLights[z].push_back(i);
+		}
+
+		// ---- every slice on its own, the sphere against each cluster box it might touch.
+		// the offsets are local to the slice for now
+		jobs.parallelFor(slices, 1, [&](unsigned int first, unsigned int last) {
+			for (unsigned int z = first; z < last; z++)
+				binSlice(z, viewLights);
+		});
+
+		// ---- slices one after the other
+		totalReferences = 0;
+		maxPerCluster = 0;
+		for (unsigned int z = 0; z < slices; z++)
+		{
+			unsigned int sliceBase = totalReferences;
+			for (unsigned int c = z * tilesX * tilesY; c < (z + 1) * tilesX * tilesY; c++)
+			{
+				clusters[c * 2] += sliceBase;
+				maxPerCluster = std::max(maxPerCluster, clusters[c * 2 + 1]);
+			}
+			totalReferences += (unsigned int)sliceIndices[z].size();
+		}
+		indices.resize(std::max(1u, totalReferences));
+		for (unsigned int z = 0, offset = 0; z < slices; z++)
+		{
+			if (!sliceIndices[z].empty())
+				memcpy(&indices[offset], sliceIndices[z].data(), sliceIndices[z].size() * sizeof(unsigned int));
+			offset += (unsigned int)sliceIndices[z].size();
+		}
+	}
+
+	unsigned int clusterCount() const { return tilesX * tilesY * slices; }
+
+	// what the shader needs to find its cluster: slice = log(depth) * scale + bias
+	float sliceScale() const { return slices / logf(zFar / zNear); }
+	float sliceBias() const { return -logf(zNear) * sliceScale(); }
+
+	const unsigned int tilesX, tilesY, slices;
+	std::vector<unsigned int> clusters;   // offset, count
+	std::vector<unsigned int> indices;    // never empty, so it can always be uploaded
+
+	// ---- stats of the last build
+	unsigned int totalReferences;
+	unsigned int maxPerCluster;
+
+private:
+	struct Box
+	{
+		glm::vec3 min, max;
+	};
+
+	// inclusive ranges, z0 > z1 when the light is out of the frustum
+	struct Range
+	{
+		int x0, x1, y0, y1, z0, z1;
+	};
+
+	// view space boxes around every cluster, they only change with the projection
+	void computeBounds(float p00, float p11, float near, float far)
+	{
+		projectionX = p00;
+		projectionY = p11;
+		zNear = near;
+		zFar = far;
+		for (unsigned int z = 0; z < slices; z++)
+		{
+			float depth0 = sliceDepth(z), depth1 = sliceDepth(z + 1);
+			for (unsigned int y = 0; y < tilesY; y++)
+			{
+				float ndcY0 = -1.0f + 2.0f * y / tilesY, ndcY1 = -1.0f + 2.0f * (y + 1) / tilesY;
+				for (unsigned int x = 0; x < tilesX; x++)
+				{
+					float ndcX0 = -1.0f + 2.0f * x / tilesX, ndcX1 = -1.0f + 2.0f * (x + 1) / tilesX;
+					// the tile edges are planes through the eye, the box spans both ends of the slice
+					Box& box = bounds[(z * tilesY + y) * tilesX + x];
+					box.min.x = std::min(ndcX0 * depth0, ndcX0 * depth1) / p00;
+					box.max.x = std::max(ndcX1 * depth0, ndcX1 * depth1) / p00;
+					box.min.y = std::min(ndcY0 * depth0, ndcY0 * depth1) / p11;
+					box.max.y = std::max(ndcY1 * depth0, ndcY1 * depth1) / p11;
+					box.min.z = -depth1;
+					box.max.z = -depth0;
+				}
+			}
+		}
+	}
+
+	float sliceDepth(unsigned int z) const { return zNear * powf(zFar / zNear, (float)z / slices); }
+
+	int sliceOf(float depth) const
+	{
+		if (depth <= zNear)
+			return 0;
+		return std::min((int)slices - 1, (int)(logf(depth / zNear) * slices / logf(zFar / zNear)));
+	}
+
+	int tileOf(float ndc, unsigned int tiles) const
+	{
+		return std::max(0, std::min((int)tiles - 1, (int)floorf((ndc * 0.5f + 0.5f) * tiles)));
+	}
+
+	// conservative screen and depth extent of the box around the sphere
+	Range lightRange(const PointLight& light) const
+	{
+		Range range = { 0, (int)tilesX - 1, 0, (int)tilesY - 1, 1, 0 };
+		glm::vec3 center(light.positionRadius);
+		float radius = light.positionRadius.w;
+		float depthMin = -center.z - radius, depthMax = -center.z + radius;
+		if (depthMax < zNear || depthMin > zFar)
+			return range;
+		range.z0 = sliceOf(depthMin);
+		range.z1 = sliceOf(depthMax);
+
+		// with the eye inside the box the projection flips sides, it just covers the whole screen then
+		if (depthMin > zNear)
+		{
+			// x / depth is largest at the near side for positive x and at the far side for negative x, both ends cover it
+			float xMin = std::min((center.x - radius) / depthMin, (center.x - radius) / depthMax) * projectionX;
+			float xMax = std::max((center.x + radius) / depthMin, (center.x + radius) / depthMax) * projectionX;
+			float yMin = std::min((center.y - radius) / depthMin, (center.y - radius) / depthMax) * projectionY;
+			float yMax = std::max((center.y + radius) / depthMin, (center.y + radius) / depthMax) * projectionY;
+			if (xMax < -1.0f || xMin > 1.0f || yMax < -1.0f || yMin > 1.0f)
+			{
+				range.z0 = 1;
+				range.z1 = 0;
+				return range;
+			}
+			range.x0 = tileOf(xMin, tilesX);
+			range.x1 = tileOf(xMax, tilesX);
+			range.y0 = tileOf(yMin, tilesY);
+			range.y1 = tileOf(yMax, tilesY);
+		}
+		return range;
+	}
+
+	void binSlice(unsigned int z, const std::vector<PointLight>& viewLights)
+	{
+		std::vector<unsigned int>& out = sliceIndices[z];
+		out.clear();
+		const std::vector<unsigned int>& candidates = sliceLights[z];
+		for (unsigned int y = 0; y < tilesY; y++)
+		{
+			for (unsigned int x = 0; x < tilesX; x++)
+			{
+				unsigned int cluster = (z * tilesY + y) * tilesX + x;
+				const Box& box = bounds[cluster];
+				unsigned int offset = (unsigned int)out.size();
+				for (size_t n = 0; n < candidates.size(); n++)
+				{
+					unsigned int i = candidates[n];
+					const Range& range = ranges[i];
+					if ((int)x < range.x0 || (int)x > range.x1 || (int)y < range.y0 || (int)y > range.y1)
+						continue;
+					// closest point of the box to the center
+					glm::vec3 center(viewLights[i].positionRadius);
+					glm::vec3 delta = glm::clamp(center, box.min, box.max) - center;
+					float radius = viewLights[i].positionRadius.w;
+					if (glm::dot(delta, delta) <= radius * radius)
+						out.push_back(i);
+				}
+				clusters[cluster * 2] = offset;
+				clusters[cluster * 2 + 1] = (unsigned int)out.size() - offset;
+			}
+		}
+	}
+
+	std::vector<Box> bounds;
+	std::vector<Range> ranges;
+	std::vector<std::vector<unsigned int>> sliceLights;    // candidates per slice
+	std::vector<std::vector<unsigned int>> sliceIndices;   // result per slice before they are joined
+
+	// what bounds was computed for
+	float projectionX, projectionY, zNear, zFar;
+};
+
+#endif // !CLUSTERED_LIGHTS_H
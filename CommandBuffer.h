@@ -0,0 +1,239 @@
+#pragma once
+#ifndef COMMAND_BUFFER_H
+#define COMMAND_BUFFER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <MeshPool.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Draw commands recorded into one linear block of memory, so any thread can record while only the
+// GL thread ever touches the context: workers record into their own CommandBuffer, then the GL thread
+// calls replay() on each of them in order.
+//
+// recording never calls GL, so everything that needs the context (uniform locations, creating objects)
+// has to be looked up on the GL thread first. binds that wouldn't change anything are dropped while
+// recording. reset() keeps the memory, after the first few frames recording doesn't allocate anymore.
+class CommandBuffer
+{
+public:
+	CommandBuffer(size_t reserveBytes = 64 * 1024)
+	{
+		data.reserve(reserveBytes);
+		reset();
+	}
+
+	void reset()
+	{
+		data.clear();
+		commands = 0;
+		program = 0;
+		VAO = 0;
+		memset(textures, 0, sizeof(textures));
+	}
+
+	void bindProgram(unsigned int id)
+	{
+		if (id == program)
+			return;
+		program = id;
+		BindCommand cmd = { 0, id };
+		push(CMD_BIND_PROGRAM, cmd);
+	}
+
+	void bindTexture(unsigned int unit, unsigned int texture)
+	{
+		if (unit < MAX_TEXTURE_UNITS && textures[unit] == texture)
+			return;
+		if (unit < MAX_TEXTURE_UNITS)
+			textures[unit] = texture;
+		BindCommand cmd = { unit, texture };
+		push(CMD_BIND_TEXTURE, cmd);
+	}
+
+	void bindVertexArray(unsigned int id)
+	{
+		if (id == VAO)
+			return;
+		VAO = id;
+		BindCommand cmd = { 0, id };
+		push(CMD_BIND_VERTEX_ARRAY, cmd);
+	}
+
+	// the location has to come from glGetUniformLocation on the GL thread
+	void setMat4(int location, const glm::mat4& value)
+	{
+		Mat4Command cmd;
+		cmd.location = location;
+		memcpy(cmd.value, glm::value_ptr(value), sizeof(cmd.value));
+		push(CMD_SET_MAT4, cmd);
+	}
+
+	void setVec4(int location, const glm::vec4& value)
+	{
+		Vec4Command cmd;
+		cmd.location = location;
+		memcpy(cmd.value, glm::value_ptr(value), sizeof(cmd.value));
+		push(CMD_SET_VEC4, cmd);
+	}
+
+	void drawElements(const MeshHandle& mesh)
+	{
+		DrawElementsCommand cmd = { mesh.indexCount, mesh.firstIndex, mesh.baseVertex };
+		push(CMD_DRAW_ELEMENTS, cmd);
+	}
+
+	void drawArrays(int first, int count)
+	{
+		DrawArraysCommand cmd = { first, count };
+		push(CMD_DRAW_ARRAYS, cmd);
+	}
+
+	// GL thread only
+	void replay() const
+	{
+		const unsigned char* p = data.data();
+		const unsigned char* end = p + data.size();
+		while (p < end)
+		{
+			CommandHeader header;
+			memcpy(&header, p, sizeof(header));
+			const unsigned char* payload = p + sizeof(header);
+			switch (header.type)
+			{
+			case CMD_BIND_PROGRAM:
+			{
+				BindCommand cmd = read<BindCommand>(payload);
+				glUseProgram(cmd.id);
+				break;
+			}
+			case CMD_BIND_TEXTURE:
+			{
+				BindCommand cmd = read<BindCommand>(payload);
+				glActiveTexture(GL_TEXTURE0 + cmd.slot);
+				glBindTexture(GL_TEXTURE_2D, cmd.id);
+				break;
+			}
+			case CMD_BIND_VERTEX_ARRAY:
+			{
+				BindCommand cmd = read<BindCommand>(payload);
+				glBindVertexArray(cmd.id);
+				break;
+			}
+			case CMD_SET_MAT4:
+			{
+				Mat4Command cmd = read<Mat4Command>(payload);
+				glUniformMatrix4fv(cmd.location, 1, GL_FALSE, cmd.value);
+				break;
+			}
+			case CMD_SET_VEC4:
+			{
+				Vec4Command cmd = read<Vec4Command>(payload);
+				glUniform4fv(cmd.location, 1, cmd.value);
+				break;
+			}
+			case CMD_DRAW_ELEMENTS:
+			{
+				DrawElementsCommand cmd = read<DrawElementsCommand>(payload);
+				glDrawElementsBaseVertex(GL_TRIANGLES, cmd.count, GL_UNSIGNED_INT, (void*)(cmd.firstIndex * sizeof(unsigned int)), cmd.baseVertex);
+				break;
+			}
+			case CMD_DRAW_ARRAYS:
+			{
+				DrawArraysCommand cmd = read<DrawArraysCommand>(payload);
+				glDrawArrays(GL_TRIANGLES, cmd.first, cmd.count);
+				break;
+			}
+			}
+			p += header.size;
+		}
+	}
+
+	unsigned int commandCount() const { return commands; }
+	size_t bytesUsed() const { return data.size(); }
+
+private:
+	static const unsigned int MAX_TEXTURE_UNITS = 8;
+
+	enum CommandType
+	{
+		CMD_BIND_PROGRAM,
+		CMD_BIND_TEXTURE,
+		CMD_BIND_VERTEX_ARRAY,
+		CMD_SET_MAT4,
+		CMD_SET_VEC4,
+		CMD_DRAW_ELEMENTS,
+		CMD_DRAW_ARRAYS
+	};
+
+	// every command is a header followed by its payload, size covers both
+	struct CommandHeader
+	{
+		uint32_t type;
+		uint32_t size;
+	};
+
+	struct BindCommand
+	{
+		uint32_t slot;
+		uint32_t id;
+	};
+
+	struct Mat4Command
+	{
+		int32_t location;
+		float value[16];
+	};
+
+	struct Vec4Command
+	{
+		int32_t location;
+		float value[4];
+	};
+
+	struct DrawElementsCommand
+	{
+		uint32_t count;
+		uint32_t firstIndex;
+		int32_t baseVertex;
+	};
+
+	struct DrawArraysCommand
+	{
+		int32_t first;
+		int32_t count;
+	};
+
+	std::vector<unsigned char> data;
+	unsigned int commands;
+
+	// what this buffer has bound so far, to drop binds that change nothing
+	unsigned int program;
+	unsigned int VAO;
+	unsigned int textures[MAX_TEXTURE_UNITS];
+
+	template <typename T>
+	void push(CommandType type, const T& payload)
+	{
+		CommandHeader header = { (uint32_t)type, (uint32_t)(sizeof(CommandHeader) + sizeof(T)) };
+		size_t offset = data.size();
+		data.resize(offset + header.size);
+		memcpy(data.data() + offset, &header, sizeof(header));
+		memcpy(data.data() + offset + sizeof(header), &payload, sizeof(T));
+		commands++;
+	}
+
+	template <typename T>
+	static T read(const unsigned char* payload)
+	{
+		T value;
+		memcpy(&value, payload, sizeof(T));
+		return value;
+	}
+};
+
+#endif // !COMMAND_BUFFER_H
@@ -0,0 +1,393 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <Shader.h>
+#include <Camera.h>
+#include <GLExtensions.h>
+#include <MeshPool.h>
+#include <Frustum.h>
+#include <CommandBuffer.h>
+#include <JobSystem.h>
+#include <FrameArena.h>
+#include <SceneGenerator.h>
+#include <Texture.h>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+const float FAR_PLANE = 300.0f;
+
+// timing
+float deltaTime = 0.0f;	// Time between current frame and last frame
+float lastFrame = 0.0f; // Time of last frame
+
+// camera
+Camera camera(glm::vec3(0.0f, 0.0f, 0.0f));
+float lastX = SCR_WIDTH / 2.0f;
+float lastY = SCR_HEIGHT / 2.0f;
+bool firstMouse = true;
+
+// what a worker needs to know about the GL objects, all looked up on the GL thread before recording starts
+struct RecordState
+{
+	unsigned int programs[2];
+	int modelLocations[2];
+	unsigned int textureSets[4][2];
+	unsigned int VAOs[3];
+	MeshHandle meshes[3];
+};
+
+// per object state packed so that sorting by it groups program, then textures, then mesh
+inline uint32_t stateKey(unsigned int program, unsigned int textureSet, unsigned int mesh)
+{
+	return (program << 16) | (textureSet << 8) | mesh;
+}
+
+// one job of the frame: cull a slice of the scene, sort what's left by state and record it.
+// nothing in here touches GL. the visible list lives in the frame arena of the thread running the job
+void recordSlice(const std::vector<SceneObject>& scene, const std::vector<uint32_t>& keys, size_t first, size_t last,
+	const Frustum& frustum, float time, const RecordState& state, LinearArena& arena, unsigned int& visibleCount, CommandBuffer& commands)
+{
+	commands.reset();
+	ArenaVector<uint64_t> visible((ArenaAllocator<uint64_t>(arena)));
+	visible.reserve(last - first);
+
+	// ---- culling, the bounding sphere of a cube is half its diagonal
+	for (size_t i = first; i < last; i++)
+	{
+		float radius = 0.87f * std::max(scene[i].scale.x, std::max(scene[i].scale.y, scene[i].scale.z));
+		if (frustum.intersectsSphere(scene[i].position, radius))
+			visible.push_back(((uint64_t)keys[i] << 32) | (uint64_t)i);
+	}
+
+	// ---- sorting, the index sits in the low bits so equal states stay in scene order
+	std::sort(visible.begin(), visible.end());
+
+	// ---- recording, the model matrix is built here too so the GL thread only copies it into the uniform
+	for (size_t v = 0; v < visible.size(); v++)
+	{
+		uint32_t key = (uint32_t)(visible[v] >> 32);
+		const SceneObject& object = scene[(size_t)(visible[v] & 0xFFFFFFFFu)];
+		unsigned int program = key >> 16, textureSet = (key >> 8) & 0xFF, mesh = key & 0xFF;
+
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), object.position);
+		model = glm::rotate(model, glm::radians(object.angle + time * 20.0f), object.rotationAxis);
+		model = glm::scale(model, object.scale);
+
+		commands.bindProgram(state.programs[program]);
+		commands.bindTexture(0, state.textureSets[textureSet][0]);
+		commands.bindTexture(1, state.textureSets[textureSet][1]);
+		commands.bindVertexArray(state.VAOs[mesh]);
+		commands.setMat4(state.modelLocations[program], model);
+		commands.drawElements(state.meshes[mesh]);
+	}
+	visibleCount = (unsigned int)visible.size();
+}
+
+int main(int argc, char* argv[])
+{
+	// --threads N threads recording (one per core by default, 1 records on the GL thread itself),
+	// --headless renders into a hidden window, --frames N quits after N frames,
+	// --scene/--count/--seed pick the scene (see SceneGenerator.h)
+	unsigned int threadCount = 0;
+	bool headless = false;
+	int maxFrames = -1;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			threadCount = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--headless") == 0)
+			headless = true;
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+			maxFrames = atoi(argv[++i]);
+	}
+	SceneOptions sceneOptions;
+	sceneOptions.count = 50000;
+	parseSceneOptions(argc, argv, sceneOptions);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- GlAD, GLFW and OpenGL setup
+	// ---------------------------------------------------------
+
+	// initilize the glfw library
+	glfwInit();
+
+	// ----- Setting glfw options
+
+	// nothing here needs more than 3.3
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+	// we specify that we only want the core features of OpenGL
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	// headless runs still need a context, they just never show the window
+	if (headless)
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	// -----
+
+	// creating our window and configuring it's width, height and name
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	// we tell the glfw that set our window to the current thread's context.
+	// this stays the only thread that ever makes a GL call
+	glfwMakeContextCurrent(window);
+
+	// a callback to resize the window when the user resized the window
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	if (!headless)
+	{
+		// a callback to know the mouse position and calculate the direction of the camera
+		glfwSetCursorPosCallback(window, mouse_callback);
+
+		// to get mouse scroller input
+		glfwSetScrollCallback(window, scroll_callback);
+
+		// tell GLFW to capture our mouse
+		glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	}
+
+	// GLAD initilization
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initilize GLAD" << std::endl;
+		return -1;
+	}
+	loadGLExtensions();
+
+	// configure global opengl state
+	// -----------------------------
+	// for z buffer
+	glEnable(GL_DEPTH_TEST);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Shaders, meshes & textures
+	// ---------------------------------------------------------
+
+	Shader mixShader("textureShader.verts", "textureShader.frags");
+	Shader singleShader("textureShader.verts", "singleTexture.frags");
+	Shader* shaders[2] = { &mixShader, &singleShader };
+
+	// one pool per mesh so every mesh has its own VAO
+	MeshPool cubePool(1024, 1024), prismPool(1024, 1024), spherePool(1024, 4096);
+	MeshPool* pools[3] = { &cubePool, &prismPool, &spherePool };
+
+	// the workers are up before anything gets loaded so decoding the images is spread over them too,
+	// only the uploads have to happen here
+	JobSystem jobs(threadCount);
+	const char* imagePaths[4] = { "container.jpg", "awesomeface.png", "Image.jpg", "star.png" };
+	TextureImage decoded[4];
+	jobs.parallelFor(4, 1, [&](unsigned int first, unsigned int last) {
+		for (unsigned int i = first; i < last; i++)
+			decoded[i] = decodeTexture(imagePaths[i], i % 2 == 1);
+	});
+	unsigned int images[4];
+	for (int i = 0; i < 4; i++)
+		images[i] = uploadTexture(decoded[i]);
+
+	RecordState state;
+	for (int s = 0; s < 2; s++)
+	{
+		shaders[s]->use();
+		shaders[s]->setInt("texture1", 0);
+		shaders[s]->setInt("texture2", 1);
+		state.programs[s] = shaders[s]->ID;
+		state.modelLocations[s] = glGetUniformLocation(shaders[s]->ID, "model");
+	}
+	unsigned int textureSets[4][2] = { { images[0], images[1] }, { images[2], images[3] }, { images[1], images[0] }, { images[3], images[2] } };
+	memcpy(state.textureSets, textureSets, sizeof(textureSets));
+	state.meshes[0] = cubePool.add(makeCube());
+	state.meshes[1] = prismPool.add(makePrism(6));
+	state.meshes[2] = spherePool.add(makeSphere(8, 16));
+	for (int p = 0; p < 3; p++)
+		state.VAOs[p] = pools[p]->VAO;
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Scene
+	// ---------------------------------------------------------
+
+	sceneOptions.textureCount = 4;
+	std::vector<SceneObject> scene = generateScene(sceneOptions);
+	std::vector<uint32_t> keys(scene.size());
+	for (unsigned int i = 0; i < scene.size(); i++)
+		keys[i] = stateKey((i / 3) % 2, scene[i].texture, i % 3);
+
+	// a few slices per thread so the threads that got mostly culled slices can steal the rest.
+	// every slice has its own buffers, nothing is shared while recording
+	unsigned int sliceCount = jobs.threadCount() == 1 ? 1 : jobs.threadCount() * 4;
+	std::vector<CommandBuffer> commandBuffers(sliceCount);
+	std::vector<unsigned int> visibleCounts(sliceCount);
+	FrameArena frameArena(jobs.threadCount(), 4 << 20);
+	std::cout << scene.size() << " objects, recording on " << jobs.threadCount() << " thread(s)" << std::endl;
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- our render loop (smth like update in unity!)
+	// ---------------------------------------------------------
+
+	glm::mat4 view = glm::mat4(1.0f);
+	glm::mat4 projection = glm::mat4(1.0f);
+
+	double statsStart = glfwGetTime();
+	unsigned int statsFrames = 0;
+	double statsRecordMs = 0.0, statsReplayMs = 0.0;
+	int frame = 0;
+
+	while (!glfwWindowShouldClose(window) && (maxFrames < 0 || frame < maxFrames))
+	{
+		// ---- Calculating deltaTime
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// ---- input handler
+		processInput(window);
+
+		// without a mouse the camera just turns around so the visible set keeps changing
+		if (headless)
+			camera.ProcessMouseMovement(20.0f, 0.0f, true);
+
+		view = camera.GetViewMatrix();
+		projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, FAR_PLANE);
+		Frustum frustum(projection * view);
+
+		frameArena.beginFrame();
+
+		// ---- record, one job per contiguous slice of the scene. the GL thread helps out until they're done
+		auto recordStart = std::chrono::high_resolution_clock::now();
+		size_t chunk = (scene.size() + sliceCount - 1) / sliceCount;
+		jobs.parallelFor(sliceCount, 1, [&](unsigned int firstSlice, unsigned int lastSlice) {
+			for (unsigned int s = firstSlice; s < lastSlice; s++)
+			{
+				size_t first = std::min(scene.size(), s * chunk), last = std::min(scene.size(), first + chunk);
+				recordSlice(scene, keys, first, last, frustum, currentFrame, state, frameArena.arena(jobs.threadIndex()), visibleCounts[s], commandBuffers[s]);
+			}
+		});
+		statsRecordMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - recordStart).count();
+
+		// ----- Rendering stuff
+
+		// seting the clear color
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		// clear the window color buffer bit and z buffer bit
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// view and projection are the same for every object, set them once per program
+		for (int s = 0; s < 2; s++)
+		{
+			shaders[s]->use();
+			shaders[s]->setMat4("view", view);
+			shaders[s]->setMat4("projection", projection);
+		}
+
+		// ---- replay in slice order, every buffer starts from no known state so it rebinds what it needs
+		auto replayStart = std::chrono::high_resolution_clock::now();
+		for (unsigned int s = 0; s < sliceCount; s++)
+			commandBuffers[s].replay();
+		statsReplayMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - replayStart).count();
+
+		frame++;
+		statsFrames++;
+		if (glfwGetTime() - statsStart >= 1.0 || frame == maxFrames)
+		{
+			unsigned int visibleCount = 0, commandCount = 0;
+			size_t bytes = 0;
+			for (unsigned int s = 0; s < sliceCount; s++)
+			{
+				visibleCount += visibleCounts[s];
+				commandCount += commandBuffers[s].commandCount();
+				bytes += commandBuffers[s].bytesUsed();
+			}
+			std::cout << visibleCount << " visible, " << commandCount << " commands (" << bytes / 1024 << " KB)"
+				<< ", frame arena " << frameArena.frameBytes() / 1024 << " KB (peak " << frameArena.peakFrameBytes() / 1024
+				<< " KB, " << frameArena.growCount() << " grows)"
+				<< " | record " << statsRecordMs / statsFrames << " ms, replay " << statsReplayMs / statsFrames
+				<< " ms, " << statsFrames << " fps" << std::endl;
+			statsStart = glfwGetTime();
+			statsFrames = 0;
+			statsRecordMs = 0.0;
+			statsReplayMs = 0.0;
+		}
+
+		// double buffer mechanism to render things smoothly without user seeing the acutal drawings
+		glfwSwapBuffers(window);
+		// checks if any events are created
+		glfwPollEvents();
+	}
+
+	// optional: de-allocate all resources once they've outlived their purpose:
+	// ------------------------------------------------------------------------
+	for (int p = 0; p < 3; p++)
+		pools[p]->destroy();
+	for (int s = 0; s < 2; s++)
+		glDeleteProgram(shaders[s]->ID);
+	glDeleteTextures(4, images);
+
+	// glfw: terminate, clearing all previously allocated GLFW resources.
+	// ------------------------------------------------------------------
+	glfwTerminate();
+
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+}
+
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(RIGHT, deltaTime);
+}
+
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+	if (firstMouse) // initially set to true
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	float xoffset = xpos - lastX;
+	float yoffset = lastY - ypos; // reversed since y-coordinates range from bottom to top
+	lastX = xpos;
+	lastY = ypos;
+
+	camera.ProcessMouseMovement(xoffset, yoffset, true);
+}
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.ProcessMouseScroll(yoffset);
+}
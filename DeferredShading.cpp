@@ -0,0 +1,837 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <Shader.h>
+#include <Camera.h>
+#include <GLExtensions.h>
+#include <MeshPool.h>
+#include <SceneGenerator.h>
+#include <PointLights.h>
+#include <ClusteredLights.h>
+#include <JobSystem.h>
+#include <DynamicResolution.h>
+#include <RenderTargetPool.h>
+#include <PostStack.h>
+#include <RenderGraph.h>
+#include <Texture.h>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+const float NEAR_PLANE = 0.1f;
+const float FAR_PLANE = 300.0f;
+const glm::vec3 AMBIENT = glm::vec3(0.06f);
+const glm::vec3 SKY_COLOR = glm::vec3(0.02f, 0.03f, 0.05f);
+
+// F goes through the three ways of shading the lights
+enum ShadingMode
+{
+	SHADING_DEFERRED,
+	SHADING_FORWARD,
+	SHADING_CLUSTERED,
+	SHADING_MODE_COUNT
+};
+const char* shadingModeNames[SHADING_MODE_COUNT] = { "deferred", "forward", "clustered" };
+ShadingMode shadingMode = SHADING_DEFERRED;
+
+// the render targets follow the framebuffer size
+bool targetsDirty = false;
+
+// B, G and X switch bloom, grading and FXAA, U the fusing of the post passes
+PostSettings postSettings;
+// M switches memory aliasing in the render target pool
+bool targetAliasing = true;
+
+// timing
+float deltaTime = 0.0f;	// Time between current frame and last frame
+float lastFrame = 0.0f; // Time of last frame
+
+// camera
+Camera camera(glm::vec3(0.0f, 25.0f, 60.0f), glm::vec3(0.0f, 1.0f, 0.0f), -90.0f, -20.0f);
+float lastX = SCR_WIDTH / 2.0f;
+float lastY = SCR_HEIGHT / 2.0f;
+bool firstMouse = true;
+
+// The g-buffer and the HDR buffer the lights add up in.
+//
+// g-buffer: RGBA8 albedo, RG16F octahedral view space normal and a depth texture the lighting reconstructs
+// positions from, 12 bytes per pixel. its textures come out of the render target pool every frame and go
+// back after the lighting, so the post passes can use the same memory. the HDR buffer has its own depth
+// buffer (the g-buffer depth is copied in) so the light volumes can depth test while the shader samples the
+// g-buffer depth. with samples > 1 there's also a multisampled HDR buffer the forward modes draw into and resolve from
+struct RenderTargets
+{
+	int width = 0, height = 0, samples = 1;
+	unsigned int gBuffer = 0;
+	unsigned int hdrBuffer = 0, hdrColor = 0, hdrDepth = 0;
+	unsigned int msaaBuffer = 0, msaaColor = 0, msaaDepth = 0;
+
+	bool create(int framebufferWidth, int framebufferHeight, int sampleCount)
+	{
+		width = std::max(1, framebufferWidth);
+		height = std::max(1, framebufferHeight);
+		samples = std::max(1, sampleCount);
+
+		// the attachments come with attachGBuffer()
+		glGenFramebuffers(1, &gBuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+		const GLenum attachments[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+		glDrawBuffers(2, attachments);
+
+		glGenFramebuffers(1, &hdrBuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, hdrBuffer);
+		hdrColor = createTexture(GL_RGBA16F, GL_RGBA, GL_FLOAT);
+		// the present pass filters it when it upscales
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, hdrColor, 0);
+		// same format as the g-buffer depth, blitting depth needs that
+		glGenRenderbuffers(1, &hdrDepth);
+		glBindRenderbuffer(GL_RENDERBUFFER, hdrDepth);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, hdrDepth);
+		bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+		// renderbuffers are enough, it's only ever blitted out of
+		if (samples > 1)
+		{
+			glGenFramebuffers(1, &msaaBuffer);
+			glBindFramebuffer(GL_FRAMEBUFFER, msaaBuffer);
+			glGenRenderbuffers(1, &msaaColor);
+			glBindRenderbuffer(GL_RENDERBUFFER, msaaColor);
+			glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA16F, width, height);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, msaaColor);
+			glGenRenderbuffers(1, &msaaDepth);
+			glBindRenderbuffer(GL_RENDERBUFFER, msaaDepth);
+			glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH24_STENCIL8, width, height);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, msaaDepth);
+			complete = complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+		}
+
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		if (!complete)
+			std::cout << "ERROR::DEFERRED::FRAMEBUFFER_NOT_COMPLETE" << std::endl;
+		return complete;
+	}
+
+	void destroy()
+	{
+		glDeleteTextures(1, &hdrColor);
+		unsigned int renderbuffers[3] = { hdrDepth, msaaColor, msaaDepth };
+		glDeleteRenderbuffers(3, renderbuffers);
+		unsigned int framebuffers[3] = { gBuffer, hdrBuffer, msaaBuffer };
+		glDeleteFramebuffers(3, framebuffers);
+		gBuffer = hdrBuffer = hdrColor = hdrDepth = 0;
+		msaaBuffer = msaaColor = msaaDepth = 0;
+	}
+
+	// this frame's g-buffer textures into gBuffer, which stays bound. attached every frame, the pool can
+	// hand out other textures (or delete and remake them) between frames
+	void attachGBuffer(const RenderTarget* albedo, const RenderTarget* normal, const RenderTarget* depth)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedo->texture, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normal->texture, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depth->texture, 0);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			std::cout << "ERROR::DEFERRED::FRAMEBUFFER_NOT_COMPLETE" << std::endl;
+	}
+
+	// where the forward modes draw, resolve() gets it into hdrColor afterwards
+	unsigned int forwardTarget() const { return samples > 1 ? msaaBuffer : hdrBuffer; }
+
+	// only the bottom left renderWidth x renderHeight, the rest isn't rendered into with dynamic resolution
+	void resolve(int renderWidth, int renderHeight)
+	{
+		if (samples == 1)
+			return;
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, msaaBuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, hdrBuffer);
+		glBlitFramebuffer(0, 0, renderWidth, renderHeight, 0, 0, renderWidth, renderHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	}
+
+	// bytes per pixel of everything above but the pooled g-buffer, for the stats
+	int bytesPerPixel() const { return 8 + 4 + (samples > 1 ? samples * (8 + 4) : 0); }
+
+private:
+	unsigned int createTexture(GLenum internalFormat, GLenum format, GLenum type)
+	{
+		unsigned int texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
+		// read one to one with the screen, filtering would only blend neighbours
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		return texture;
+	}
+};
+
+int main(int argc, char* argv[])
+{
+	// --forward / --clustered start with that kind of shading (F switches), --lights N point lights,
+	// --msaa N samples for the forward modes, --threads N threads binning the clustered lights (one per core by default),
+	// --budget MS scales the resolution to keep the gpu time of the scene under MS (0 renders at full size),
+	// --min-scale S is the lowest it goes, --headless renders into a hidden window, --frames N quits after N frames,
+	// --scene/--count/--seed pick the scene (see SceneGenerator.h), --no-bloom / --no-grade / --no-fxaa / --no-fuse
+	// start with that part of the post stack off, --no-aliasing only reuses render targets of the same size and format
+	bool headless = false;
+	int maxFrames = -1;
+	unsigned int lightCount = 1024;
+	int msaaSamples = 1;
+	unsigned int threadCount = 0;
+	float budgetMs = 12.0f;
+	float minScale = 0.5f;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--forward") == 0)
+			shadingMode = SHADING_FORWARD;
+		else if (strcmp(argv[i], "--clustered") == 0)
+			shadingMode = SHADING_CLUSTERED;
+		else if (strcmp(argv[i], "--msaa") == 0 && i + 1 < argc)
+			msaaSamples = std::max(1, atoi(argv[++i]));
+		else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			threadCount = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc)
+			budgetMs = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--min-scale") == 0 && i + 1 < argc)
+			minScale = std::min(1.0f, std::max(0.1f, (float)atof(argv[++i])));
+		else if (strcmp(argv[i], "--no-bloom") == 0)
+			postSettings.bloom = false;
+		else if (strcmp(argv[i], "--no-grade") == 0)
+			postSettings.grade = false;
+		else if (strcmp(argv[i], "--no-fxaa") == 0)
+			postSettings.fxaa = false;
+		else if (strcmp(argv[i], "--no-fuse") == 0)
+			postSettings.fuse = false;
+		else if (strcmp(argv[i], "--no-aliasing") == 0)
+			targetAliasing = false;
+		else if (strcmp(argv[i], "--lights") == 0 && i + 1 < argc)
+			lightCount = (unsigned int)std::max(1, atoi(argv[++i]));
+		else if (strcmp(argv[i], "--headless") == 0)
+			headless = true;
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+			maxFrames = atoi(argv[++i]);
+	}
+	SceneOptions sceneOptions;
+	sceneOptions.layout = SCENE_CITY;
+	sceneOptions.count = 4000;
+	parseSceneOptions(argc, argv, sceneOptions);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- GlAD, GLFW and OpenGL setup
+	// ---------------------------------------------------------
+
+	// initilize the glfw library
+	glfwInit();
+
+	// ----- Setting glfw options
+
+	// multiple render targets, float textures and texture buffers are all in 3.3
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+	// we specify that we only want the core features of OpenGL
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	// headless runs still need a context, they just never show the window
+	if (headless)
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	// -----
+
+	// creating our window and configuring it's width, height and name
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	// we tell the glfw that set our window to the current thread's context
+	glfwMakeContextCurrent(window);
+
+	// a callback to resize the window when the user resized the window
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	// for toggles that should only fire once per key press
+	glfwSetKeyCallback(window, key_callback);
+
+	if (!headless)
+	{
+		// a callback to know the mouse position and calculate the direction of the camera
+		glfwSetCursorPosCallback(window, mouse_callback);
+
+		// to get mouse scroller input
+		glfwSetScrollCallback(window, scroll_callback);
+
+		// tell GLFW to capture our mouse
+		glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	}
+
+	// GLAD initilization
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initilize GLAD" << std::endl;
+		return -1;
+	}
+	loadGLExtensions();
+
+	// configure global opengl state
+	// -----------------------------
+	// for z buffer
+	glEnable(GL_DEPTH_TEST);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Shaders, meshes & textures
+	// ---------------------------------------------------------
+
+	Shader geometryShader("deferredGeometry.verts", "deferredGeometry.frags");
+	Shader ambientShader("fullscreen.verts", "deferredAmbient.frags");
+	Shader lightShader("lightVolume.verts", "lightVolume.frags");
+	Shader forwardShader("deferredGeometry.verts", "forwardLights.frags");
+	Shader clusteredShader("deferredGeometry.verts", "clusteredLights.frags");
+
+	geometryShader.use();
+	geometryShader.setInt("texture1", 0);
+	geometryShader.setInt("texture2", 1);
+	ambientShader.use();
+	ambientShader.setInt("gAlbedo", 0);
+	ambientShader.setInt("gDepth", 1);
+	ambientShader.setVec3("ambient", AMBIENT);
+	ambientShader.setVec3("skyColor", SKY_COLOR);
+	lightShader.use();
+	lightShader.setInt("gAlbedo", 0);
+	lightShader.setInt("gNormal", 1);
+	lightShader.setInt("gDepth", 2);
+	forwardShader.use();
+	forwardShader.setInt("texture1", 0);
+	forwardShader.setInt("texture2", 1);
+	forwardShader.setInt("lights", 2);
+	forwardShader.setVec3("ambient", AMBIENT);
+	clusteredShader.use();
+	clusteredShader.setInt("texture1", 0);
+	clusteredShader.setInt("texture2", 1);
+	clusteredShader.setInt("lights", 2);
+	clusteredShader.setInt("clusters", 3);
+	clusteredShader.setInt("lightIndices", 4);
+	clusteredShader.setVec3("ambient", AMBIENT);
+
+	// the model matrix changes every draw, no string lookups for it
+	int geometryModelLocation = glGetUniformLocation(geometryShader.ID, "model");
+	int forwardModelLocation = glGetUniformLocation(forwardShader.ID, "model");
+	int clusteredModelLocation = glGetUniformLocation(clusteredShader.ID, "model");
+
+	// one pool per mesh so every mesh has its own VAO, the light volumes get their own too
+	MeshPool cubePool(1024, 1024), prismPool(1024, 1024), spherePool(1024, 4096), volumePool(1024, 4096);
+	MeshPool* pools[3] = { &cubePool, &prismPool, &spherePool };
+	MeshHandle meshes[3] = { cubePool.add(makeCube()), prismPool.add(makePrism(6)), spherePool.add(makeSphere(8, 16)) };
+	MeshHandle volume = volumePool.add(makeSphere(8, 16));
+
+	unsigned int images[4] = { loadTexture("container.jpg"), loadTexture("awesomeface.png", true), loadTexture("Image.jpg"), loadTexture("star.png", true) };
+	unsigned int textureSets[4][2] = { { images[0], images[1] }, { images[2], images[3] }, { images[1], images[0] }, { images[3], images[2] } };
+
+	// the fullscreen passes make their triangle out of gl_VertexID, core profile still wants a VAO bound
+	unsigned int emptyVAO;
+	glGenVertexArrays(1, &emptyVAO);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Scene & lights
+	// ---------------------------------------------------------
+
+	// the scene never moves, so the draw order is sorted by mesh and texture once
+	sceneOptions.textureCount = 4;
+	std::vector<SceneObject> scene = generateScene(sceneOptions);
+	std::vector<glm::mat4> models(scene.size());
+	std::vector<unsigned int> drawOrder(scene.size());
+	for (unsigned int i = 0; i < scene.size(); i++)
+	{
+		models[i] = scene[i].modelMatrix();
+		drawOrder[i] = i;
+	}
+	std::sort(drawOrder.begin(), drawOrder.end(), [&scene](unsigned int a, unsigned int b) {
+		return a % 3 != b % 3 ? a % 3 < b % 3 : scene[a].texture < scene[b].texture;
+	});
+
+	glm::vec3 boundsMin, boundsMax;
+	sceneBounds(scene, boundsMin, boundsMax);
+	boundsMax.y += 3.0f;
+	PointLightSet lights(lightCount, boundsMin, boundsMax);
+
+	// one buffer of lights, per instance attributes of the light volumes and a texture buffer for forward shading
+	unsigned int lightVBO, lightTBO;
+	glGenBuffers(1, &lightVBO);
+	glBindBuffer(GL_ARRAY_BUFFER, lightVBO);
+	glBufferData(GL_ARRAY_BUFFER, lights.size() * sizeof(PointLight), NULL, GL_STREAM_DRAW);
+	glBindVertexArray(volumePool.VAO);
+	glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(PointLight), (void*)offsetof(PointLight, positionRadius));
+	glEnableVertexAttribArray(3);
+	glVertexAttribDivisor(3, 1);
+	glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(PointLight), (void*)offsetof(PointLight, color));
+	glEnableVertexAttribArray(4);
+	glVertexAttribDivisor(4, 1);
+	glBindVertexArray(0);
+	glGenTextures(1, &lightTBO);
+	glBindTexture(GL_TEXTURE_BUFFER, lightTBO);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, lightVBO);
+
+	// the clusters the lights are binned into on the cpu, and the two texture buffers they go up in every frame
+	JobSystem jobs(threadCount);
+	LightClusters clusters;
+	unsigned int clusterBuffers[2], clusterTBOs[2];
+	glGenBuffers(2, clusterBuffers);
+	glGenTextures(2, clusterTBOs);
+	const GLenum clusterFormats[2] = { GL_RG32UI, GL_R32UI };
+	for (int b = 0; b < 2; b++)
+	{
+		glBindBuffer(GL_TEXTURE_BUFFER, clusterBuffers[b]);
+		glBufferData(GL_TEXTURE_BUFFER, sizeof(unsigned int) * 2, NULL, GL_STREAM_DRAW);
+		glBindTexture(GL_TEXTURE_BUFFER, clusterTBOs[b]);
+		glTexBuffer(GL_TEXTURE_BUFFER, clusterFormats[b], clusterBuffers[b]);
+	}
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	clusteredShader.use();
+	glUniform3i(glGetUniformLocation(clusteredShader.ID, "gridSize"), clusters.tilesX, clusters.tilesY, clusters.slices);
+
+	std::cout << scene.size() << " objects, " << lights.size() << " point lights, " << shadingModeNames[shadingMode]
+		<< ", " << clusters.clusterCount() << " clusters binned on " << jobs.threadCount() << " thread(s) (F switches)" << std::endl;
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- our render loop (smth like update in unity!)
+	// ---------------------------------------------------------
+
+	int framebufferWidth, framebufferHeight;
+	glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+	RenderTargets targets;
+	targets.create(framebufferWidth, framebufferHeight, msaaSamples);
+
+	// gpu time of the geometry and the lighting pass, read back a frame later so it doesn't stall
+	unsigned int passQueries[2][2];
+	glGenQueries(4, &passQueries[0][0]);
+
+	// the g-buffer and everything after the lighting, on targets out of the pool. its own ring of queries for the post passes
+	RenderTargetPool targetPool;
+	PostStack post(targetPool);
+	unsigned int postQueries[2];
+	glGenQueries(2, postQueries);
+
+	// the passes of a frame and what they read and write (see RenderGraph.h), printed when the schedule changes
+	RenderGraph graph(targetPool);
+	std::string lastSchedule;
+
+	// the scale every frame was rendered at, the queries come back a frame later
+	DynamicResolution resolution(budgetMs, budgetMs > 0.0f ? minScale : 1.0f);
+	float passScales[2] = { 1.0f, 1.0f };
+
+	// draws every object with the bound program, only rebinding when the mesh or the textures change
+	auto drawScene = [&](int modelLocation) {
+		int boundMesh = -1, boundTextures = -1;
+		for (unsigned int n = 0; n < drawOrder.size(); n++)
+		{
+			unsigned int i = drawOrder[n];
+			int mesh = i % 3;
+			if (mesh != boundMesh)
+			{
+				glBindVertexArray(pools[mesh]->VAO);
+				boundMesh = mesh;
+			}
+			if ((int)scene[i].texture != boundTextures)
+			{
+				glActiveTexture(GL_TEXTURE0);
+				glBindTexture(GL_TEXTURE_2D, textureSets[scene[i].texture][0]);
+				glActiveTexture(GL_TEXTURE1);
+				glBindTexture(GL_TEXTURE_2D, textureSets[scene[i].texture][1]);
+				boundTextures = scene[i].texture;
+			}
+			glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(models[i]));
+			glDrawElementsBaseVertex(GL_TRIANGLES, meshes[mesh].indexCount, GL_UNSIGNED_INT,
+				(void*)(meshes[mesh].firstIndex * sizeof(unsigned int)), meshes[mesh].baseVertex);
+		}
+	};
+
+	double statsStart = glfwGetTime();
+	unsigned int statsFrames = 0;
+	double statsGeometryMs = 0.0, statsLightingMs = 0.0, statsBinningMs = 0.0, statsPostMs = 0.0;
+	int frame = 0;
+
+	while (!glfwWindowShouldClose(window) && (maxFrames < 0 || frame < maxFrames))
+	{
+		// ---- Calculating deltaTime
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// ---- input handler
+		processInput(window);
+
+		// without a mouse the camera just turns around
+		if (headless)
+			camera.ProcessMouseMovement(20.0f, 0.0f, true);
+
+		if (targetsDirty)
+		{
+			glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+			targets.destroy();
+			targets.create(framebufferWidth, framebufferHeight, msaaSamples);
+			targetsDirty = false;
+		}
+
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)targets.width / (float)targets.height, NEAR_PLANE, FAR_PLANE);
+
+		// ---- lights of this frame
+		const std::vector<PointLight>& viewLights = lights.update(currentFrame, view);
+
+		// ----- Rendering stuff
+		// ---- only the bottom left of the targets with dynamic resolution, the post stack scales it up
+		unsigned int* queries = passQueries[frame % 2];
+		passScales[frame % 2] = resolution.scale;
+		int renderWidth = resolution.scaled(targets.width), renderHeight = resolution.scaled(targets.height);
+		glViewport(0, 0, renderWidth, renderHeight);
+		targetPool.aliasing = targetAliasing;
+
+		// ---- the frame as a render graph. the passes of every shading mode are in it, but the screen only
+		// depends on the ones of the current mode, the rest (and the targets only they use) are culled
+		graph.reset();
+		RenderTargetDesc albedoDesc = { targets.width, targets.height, GL_RGBA8, 1 };
+		RenderTargetDesc normalDesc = { targets.width, targets.height, GL_RG16F, 1 };
+		RenderTargetDesc depthDesc = { targets.width, targets.height, GL_DEPTH24_STENCIL8, 1 };
+		int gAlbedo = graph.createTarget("g-buffer albedo", albedoDesc);
+		int gNormal = graph.createTarget("g-buffer normal", normalDesc);
+		int gDepth = graph.createTarget("g-buffer depth", depthDesc);
+		int hdr = graph.importTarget("hdr", targets.hdrColor, targets.hdrBuffer, targets.width, targets.height, GL_RGBA16F);
+		int screen = graph.importTarget("screen", 0, 0, framebufferWidth, framebufferHeight);
+		int lightData = graph.importBuffer("lights", lightVBO);
+		// both cluster buffers, they're always written together
+		int clusterData = graph.importBuffer("clusters", clusterBuffers[0]);
+
+		// orphaning so the gpu can keep reading last frame's
+		RenderGraph::PassBuilder uploadPass = graph.addPass("light upload", [&]() {
+			glBindBuffer(GL_ARRAY_BUFFER, lightVBO);
+			glBufferData(GL_ARRAY_BUFFER, viewLights.size() * sizeof(PointLight), NULL, GL_STREAM_DRAW);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, viewLights.size() * sizeof(PointLight), viewLights.data());
+		});
+		lightData = uploadPass.write(lightData, ACCESS_BUFFER_TRANSFER);
+
+		// ---- geometry pass: albedo, normal and depth of the closest surface
+		RenderGraph::PassBuilder geometryPass = graph.addPass("geometry", [&]() {
+			glBeginQuery(GL_TIME_ELAPSED, queries[0]);
+			targets.attachGBuffer(graph.target(gAlbedo), graph.target(gNormal), graph.target(gDepth));
+			glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			geometryShader.use();
+			geometryShader.setMat4("view", view);
+			geometryShader.setMat4("projection", projection);
+			drawScene(geometryModelLocation);
+			glEndQuery(GL_TIME_ELAPSED);
+		});
+		gAlbedo = geometryPass.write(gAlbedo, ACCESS_RENDER_TARGET);
+		gNormal = geometryPass.write(gNormal, ACCESS_RENDER_TARGET);
+		gDepth = geometryPass.write(gDepth, ACCESS_RENDER_TARGET);
+
+		// ---- lighting pass
+		RenderGraph::PassBuilder lightingPass = graph.addPass("lighting", [&]() {
+			glBeginQuery(GL_TIME_ELAPSED, queries[1]);
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, targets.gBuffer);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, targets.hdrBuffer);
+			glBlitFramebuffer(0, 0, renderWidth, renderHeight, 0, 0, renderWidth, renderHeight, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+			glBindFramebuffer(GL_FRAMEBUFFER, targets.hdrBuffer);
+
+			// ambient and sky cover every pixel, so nothing has to be cleared
+			glDisable(GL_DEPTH_TEST);
+			ambientShader.use();
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, graph.target(gAlbedo)->texture);
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D, graph.target(gDepth)->texture);
+			glBindVertexArray(emptyVAO);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+
+			// one sphere per light, added on top. only the back faces are drawn and only where they are behind
+			// the scene, which keeps the pixels a light can't reach out and still works with the camera inside
+			glEnable(GL_DEPTH_TEST);
+			glDepthFunc(GL_GEQUAL);
+			glDepthMask(GL_FALSE);
+			glEnable(GL_CULL_FACE);
+			glCullFace(GL_FRONT);
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_ONE, GL_ONE);
+			lightShader.use();
+			lightShader.setMat4("projection", projection);
+			lightShader.setMat4("inverseProjection", glm::inverse(projection));
+			lightShader.setVec2("screenSize", glm::vec2((float)renderWidth, (float)renderHeight));
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, graph.target(gAlbedo)->texture);
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D, graph.target(gNormal)->texture);
+			glActiveTexture(GL_TEXTURE2);
+			glBindTexture(GL_TEXTURE_2D, graph.target(gDepth)->texture);
+			glBindVertexArray(volumePool.VAO);
+			glDrawElementsInstancedBaseVertex(GL_TRIANGLES, volume.indexCount, GL_UNSIGNED_INT,
+				(void*)(volume.firstIndex * sizeof(unsigned int)), (GLsizei)viewLights.size(), volume.baseVertex);
+
+			glDisable(GL_BLEND);
+			glDisable(GL_CULL_FACE);
+			glCullFace(GL_BACK);
+			glDepthMask(GL_TRUE);
+			glDepthFunc(GL_LESS);
+			glEndQuery(GL_TIME_ELAPSED);
+		});
+		lightingPass.read(gAlbedo, ACCESS_TEXTURE).read(gNormal, ACCESS_TEXTURE).read(gDepth, ACCESS_TEXTURE | ACCESS_RENDER_TARGET)
+			.read(lightData, ACCESS_VERTEX);
+		int deferredHdr = lightingPass.write(hdr, ACCESS_RENDER_TARGET);
+
+		// ---- lights into clusters on the cpu, then up into the texture buffers
+		RenderGraph::PassBuilder binningPass = graph.addPass("cluster binning", [&]() {
+			double binningStart = glfwGetTime();
+			clusters.build(viewLights, projection, NEAR_PLANE, FAR_PLANE, jobs);
+			statsBinningMs += (glfwGetTime() - binningStart) * 1000.0;
+			const std::vector<unsigned int>* clusterLists[2] = { &clusters.clusters, &clusters.indices };
+			for (int b = 0; b < 2; b++)
+			{
+				glBindBuffer(GL_TEXTURE_BUFFER, clusterBuffers[b]);
+				glBufferData(GL_TEXTURE_BUFFER, clusterLists[b]->size() * sizeof(unsigned int), clusterLists[b]->data(), GL_STREAM_DRAW);
+			}
+		});
+		clusterData = binningPass.write(clusterData, ACCESS_BUFFER_TRANSFER);
+
+		// ---- forward: every fragment loops over every light, or only over the ones of its cluster
+		auto drawForward = [&](bool clustered) {
+			glBeginQuery(GL_TIME_ELAPSED, queries[0]);
+			glBindFramebuffer(GL_FRAMEBUFFER, targets.forwardTarget());
+			glClearColor(SKY_COLOR.x, SKY_COLOR.y, SKY_COLOR.z, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			glActiveTexture(GL_TEXTURE2);
+			glBindTexture(GL_TEXTURE_BUFFER, lightTBO);
+			if (clustered)
+			{
+				clusteredShader.use();
+				clusteredShader.setMat4("view", view);
+				clusteredShader.setMat4("projection", projection);
+				clusteredShader.setVec2("screenSize", glm::vec2((float)renderWidth, (float)renderHeight));
+				clusteredShader.setFloat("sliceScale", clusters.sliceScale());
+				clusteredShader.setFloat("sliceBias", clusters.sliceBias());
+				glActiveTexture(GL_TEXTURE3);
+				glBindTexture(GL_TEXTURE_BUFFER, clusterTBOs[0]);
+				glActiveTexture(GL_TEXTURE4);
+				glBindTexture(GL_TEXTURE_BUFFER, clusterTBOs[1]);
+				drawScene(clusteredModelLocation);
+			}
+			else
+			{
+				forwardShader.use();
+				forwardShader.setMat4("view", view);
+				forwardShader.setMat4("projection", projection);
+				forwardShader.setInt("lightCount", (int)viewLights.size());
+				drawScene(forwardModelLocation);
+			}
+			glEndQuery(GL_TIME_ELAPSED);
+
+			// the lighting happened during the draws, this query only has the msaa resolve in it
+			glBeginQuery(GL_TIME_ELAPSED, queries[1]);
+			targets.resolve(renderWidth, renderHeight);
+			glEndQuery(GL_TIME_ELAPSED);
+		};
+		RenderGraph::PassBuilder forwardPass = graph.addPass("forward", [&]() { drawForward(false); });
+		forwardPass.read(lightData, ACCESS_TEXTURE);
+		int forwardHdr = forwardPass.write(hdr, ACCESS_RENDER_TARGET);
+		RenderGraph::PassBuilder clusteredPass = graph.addPass("clustered forward", [&]() { drawForward(true); });
+		clusteredPass.read(lightData, ACCESS_TEXTURE).read(clusterData, ACCESS_TEXTURE);
+		int clusteredHdr = clusteredPass.write(hdr, ACCESS_RENDER_TARGET);
+
+		// ---- HDR buffer of the current mode through the post stack to the screen
+		int litHdr = shadingMode == SHADING_DEFERRED ? deferredHdr : shadingMode == SHADING_FORWARD ? forwardHdr : clusteredHdr;
+		RenderGraph::PassBuilder postPass = graph.addPass("post", [&]() {
+			glBeginQuery(GL_TIME_ELAPSED, postQueries[frame % 2]);
+			post.settings = postSettings;
+			RenderTarget* output = graph.target(screen);
+			post.run(graph.target(litHdr)->texture, glm::vec2((float)renderWidth / targets.width, (float)renderHeight / targets.height),
+				output->framebuffer, output->desc.width, output->desc.height);
+			glEndQuery(GL_TIME_ELAPSED);
+		});
+		postPass.read(litHdr, ACCESS_TEXTURE);
+		screen = postPass.write(screen, ACCESS_RENDER_TARGET);
+		graph.output(screen);
+
+		graph.compile();
+		graph.execute();
+		targetPool.endFrame();
+		if (graph.scheduleString() != lastSchedule)
+		{
+			lastSchedule = graph.scheduleString();
+			std::cout << "render graph: " << lastSchedule << std::endl;
+		}
+
+		// last frame's timings are done by now, or close to it
+		if (frame > 0)
+		{
+			GLuint64 geometryNs = 0, lightingNs = 0, postNs = 0;
+			glGetQueryObjectui64v(passQueries[(frame - 1) % 2][0], GL_QUERY_RESULT, &geometryNs);
+			glGetQueryObjectui64v(passQueries[(frame - 1) % 2][1], GL_QUERY_RESULT, &lightingNs);
+			glGetQueryObjectui64v(postQueries[(frame - 1) % 2], GL_QUERY_RESULT, &postNs);
+			statsGeometryMs += geometryNs / 1000000.0;
+			statsLightingMs += lightingNs / 1000000.0;
+			statsPostMs += postNs / 1000000.0;
+			if (budgetMs > 0.0f)
+				resolution.update((geometryNs + lightingNs) / 1000000.0f, passScales[(frame - 1) % 2]);
+		}
+
+		frame++;
+		statsFrames++;
+		if (glfwGetTime() - statsStart >= 1.0 || frame == maxFrames)
+		{
+			bool deferred = shadingMode == SHADING_DEFERRED;
+			std::cout << shadingModeNames[shadingMode] << ", " << lights.size() << " lights: "
+				<< (deferred ? "geometry " : "draws ") << statsGeometryMs / statsFrames << " ms";
+			if (deferred)
+				std::cout << ", lighting " << statsLightingMs / statsFrames << " ms";
+			else if (targets.samples > 1)
+				std::cout << ", " << targets.samples << "x msaa resolve " << statsLightingMs / statsFrames << " ms";
+			if (shadingMode == SHADING_CLUSTERED)
+				std::cout << ", binning " << statsBinningMs / statsFrames << " ms, " << clusters.totalReferences
+					<< " light references (" << (double)clusters.totalReferences / clusters.clusterCount()
+					<< " per cluster, max " << clusters.maxPerCluster << ")";
+			std::cout << ", fixed render targets " << (double)targets.width * targets.height * targets.bytesPerPixel() / (1024.0 * 1024.0)
+				<< " MB";
+			if (budgetMs > 0.0f)
+				std::cout << ", resolution " << renderWidth << "x" << renderHeight << " (" << (int)(resolution.scale * 100.0f + 0.5f)
+					<< "% for a " << budgetMs << " ms budget)";
+			std::cout << " | " << statsFrames << " fps" << std::endl;
+			std::cout << "post: " << statsPostMs / statsFrames << " ms, " << post.passes << " full screen passes "
+				<< (postSettings.fuse ? "fused" : "unfused") << " + " << post.bloomPasses << " bloom passes, "
+				<< post.programCount() << " permutations" << std::endl;
+			const double MB = 1024.0 * 1024.0;
+			std::cout << "render target pool: " << targetPool.frameTargets << " targets a frame, " << targetPool.separateBytes / MB
+				<< " MB on their own, " << targetPool.reusedBytes / MB << " MB reusing the same size and format, "
+				<< targetPool.aliasedBytes / MB << " MB aliased | allocated " << targetPool.memoryBytes() / MB << " MB in "
+				<< targetPool.size() << " textures, aliasing " << (targetAliasing ? "on" : "off") << " (M switches), "
+				<< targetPool.created << " created" << std::endl;
+			statsStart = glfwGetTime();
+			statsFrames = 0;
+			statsGeometryMs = statsLightingMs = statsBinningMs = statsPostMs = 0.0;
+		}
+
+		// double buffer mechanism to render things smoothly without user seeing the acutal drawings
+		glfwSwapBuffers(window);
+		// checks if any events are created
+		glfwPollEvents();
+	}
+
+	// optional: de-allocate all resources once they've outlived their purpose:
+	// ------------------------------------------------------------------------
+	targets.destroy();
+	post.destroy();
+	targetPool.destroy();
+	glDeleteQueries(2, postQueries);
+	for (int p = 0; p < 3; p++)
+		pools[p]->destroy();
+	volumePool.destroy();
+	glDeleteVertexArrays(1, &emptyVAO);
+	glDeleteBuffers(1, &lightVBO);
+	glDeleteTextures(1, &lightTBO);
+	glDeleteBuffers(2, clusterBuffers);
+	glDeleteTextures(2, clusterTBOs);
+	glDeleteTextures(4, images);
+	glDeleteQueries(4, &passQueries[0][0]);
+	Shader* shaders[5] = { &geometryShader, &ambientShader, &lightShader, &forwardShader, &clusteredShader };
+	for (int s = 0; s < 5; s++)
+		glDeleteProgram(shaders[s]->ID);
+
+	// glfw: terminate, clearing all previously allocated GLFW resources.
+	// ------------------------------------------------------------------
+	glfwTerminate();
+
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+	targetsDirty = true;
+}
+
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(RIGHT, deltaTime);
+}
+
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (key == GLFW_KEY_F && action == GLFW_PRESS)
+	{
+		shadingMode = (ShadingMode)((shadingMode + 1) % SHADING_MODE_COUNT);
+		std::cout << "switched to " << shadingModeNames[shadingMode] << " shading" << std::endl;
+	}
+	if (key == GLFW_KEY_B && action == GLFW_PRESS)
+	{
+		postSettings.bloom = !postSettings.bloom;
+		std::cout << "bloom " << (postSettings.bloom ? "on" : "off") << std::endl;
+	}
+	if (key == GLFW_KEY_G && action == GLFW_PRESS)
+	{
+		postSettings.grade = !postSettings.grade;
+		std::cout << "color grading " << (postSettings.grade ? "on" : "off") << std::endl;
+	}
+	if (key == GLFW_KEY_X && action == GLFW_PRESS)
+	{
+		postSettings.fxaa = !postSettings.fxaa;
+		std::cout << "fxaa " << (postSettings.fxaa ? "on" : "off") << std::endl;
+	}
+	if (key == GLFW_KEY_U && action == GLFW_PRESS)
+	{
+		postSettings.fuse = !postSettings.fuse;
+		std::cout << "post passes " << (postSettings.fuse ? "fused" : "unfused") << std::endl;
+	}
+	if (key == GLFW_KEY_M && action == GLFW_PRESS)
+	{
+		targetAliasing = !targetAliasing;
+		std::cout << "render target aliasing " << (targetAliasing ? "on" : "off") << std::endl;
+	}
+}
+
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+	if (firstMouse) // initially set to true
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	float xoffset = xpos - lastX;
+	float yoffset = lastY - ypos; // reversed since y-coordinates range from bottom to top
+	lastX = xpos;
+	lastY = ypos;
+
+	camera.ProcessMouseMovement(xoffset, yoffset, true);
+}
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.ProcessMouseScroll(yoffset);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include <algorithm>
+#include <cmath>
+
+// Picks the resolution scale for the next frame so the gpu time stays inside a budget.
+//
+// the render targets keep their full size and only the viewport shrinks, so changing the scale costs
+// nothing. the model is that gpu time grows with the pixel count: the measured time is turned into
+// the time a full resolution frame would take, smoothed, and the scale that fits that into the budget
+// is what the next frames move towards. going over the budget drops right away, coming back up is slow
+// so a single cheap frame doesn't make it bounce
+class DynamicResolution
+{
+public:
+	float budgetMs;
+	float minScale, maxScale;
+	float scale;
+
+	DynamicResolution(float budgetMs, float minScale = 0.5f, float maxScale = 1.0f)
+		: budgetMs(budgetMs), minScale(minScale), maxScale(maxScale), scale(maxScale), fullResolutionMs(0.0f)
+	{
+	}
+
+	// gpuMs is the time of a frame rendered at renderedScale (the queries come back late, so it's
+	// usually not the current one). returns the scale to render the next frame at
+	float update(float gpuMs, float renderedScale)
+	{
+		// whole steps of this, so the size doesn't change by a pixel every frame
+		const float step = 1.0f / 64.0f;
+		float cost = gpuMs / std::max(renderedScale * renderedScale, 0.01f);
+		fullResolutionMs = fullResolutionMs == 0.0f ? cost : fullResolutionMs + (cost - fullResolutionMs) * 0.2f;
+
+		// a little under the budget, the time isn't exactly proportional to the pixels
+		float target = std::sqrt(budgetMs * 0.9f / std::max(fullResolutionMs, 0.001f));
+		target = std::min(maxScale, std::max(minScale, target));
+		if (gpuMs > budgetMs && target < scale)
+			scale = target;
+		else if (std::fabs(target - scale) > 0.02f || (target == maxScale && scale < maxScale))
+			scale += std::max(std::fabs(target - scale) * 0.1f, step) * (target > scale ? 1.0f : -1.0f);
+
+		scale = std::min(maxScale, std::max(minScale, std::floor(scale / step + 0.5f) * step));
+		return scale;
+	}
+
+	int scaled(int size) const { return std::max(1, (int)(size * scale + 0.5f)); }
+
+private:
+	float fullResolutionMs;
+};
+
+#endif // !DYNAMIC_RESOLUTION_H
@@ -0,0 +1,87 @@
+#pragma once
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cassert>
+#include <cstdint>
+
+// Runs the simulation in steps of a fixed length however fast frames come, the classic accumulator loop:
+//
+//   unsigned int steps = timestep.advance(glfwGetTime());
+//   for (unsigned int i = 0; i < steps; i++)
+//       simulate(timestep.stepSeconds());
+//   render(interpolate(previous, current, timestep.alpha()));
+//
+// time stays a double and simulation time is counted in whole steps, so even after hours nothing drifts the way
+// a float glfwGetTime() does. when frames get so slow that more than maxSteps would be due the rest is
+// dropped, the simulation slows down instead of spiralling into ever longer frames
+class FixedTimestep
+{
+public:
+	FixedTimestep(double stepSeconds = 1.0 / 60.0, unsigned int maxSteps = 8)
+		: step(stepSeconds), maxSteps(maxSteps), lastTime(-1.0), accumulator(0.0), steps(0), dropped(0)
+	{
+		// advance() would never leave its loop otherwise
+		assert(stepSeconds > 0.0);
+	}
+
+	// how many steps to run this frame, now is the wall clock in seconds
+	unsigned int advance(double now)
+	{
+		if (lastTime < 0.0)
+			lastTime = now;
+		accumulator += now - lastTime;
+		lastTime = now;
+
+		unsigned int due = 0;
+		while (accumulator >= step)
+		{
+			accumulator -= step;
+			if (due < maxSteps)
+				due++;
+			else
+				dropped++;
+		}
+		steps += due;
+		return due;
+	}
+
+	float stepSeconds() const { return (float)step; }
+
+	// where the frame falls between the state before the last step (0) and after it (1)
+	float alpha() const { return (float)(accumulator / step); }
+
+	// simulation time after the steps run so far
+	double time() const { return steps * step; }
+
+	// simulation time the frame shows, between the last two steps
+	double renderTime() const { return steps > 0 ? (steps - 1) * step + accumulator : 0.0; }
+
+	uint64_t stepCount() const { return steps; }
+	uint64_t droppedSteps() const { return dropped; }
+
+private:
+	double step;
+	unsigned int maxSteps;
+	double lastTime;
+	double accumulator;
+	uint64_t steps;
+	uint64_t dropped;
+};
+
+// blends the state before the last step with the state after it
+template <typename T>
+inline T interpolate(const T& previous, const T& current, float alpha)
+{
+	return previous + (current - previous) * alpha;
+}
+
+inline glm::quat interpolate(const glm::quat& previous, const glm::quat& current, float alpha)
+{
+	return glm::slerp(previous, current, alpha);
+}
+
+#endif // !FIXED_TIMESTEP_H
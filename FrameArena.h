@@ -0,0 +1,189 @@
+#pragma once
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+// ---------------------------------------------------------
+// --------------------------------------------------------- linear arena
+// ---------------------------------------------------------
+
+// Bump allocator over one block of memory. allocating is moving an offset, freeing is resetting all of it at once.
+// when a frame needs more than the block the rest goes to extra heap blocks, and the next reset() replaces
+// the block with one big enough for all of it, so after a few frames nothing touches the heap anymore.
+// one arena is for one thread at a time
+class LinearArena
+{
+public:
+	LinearArena(size_t capacity = 1 << 20) : capacity(capacity), used(0), overflowBytes(0), peak(0), grows(0)
+	{
+		base = (unsigned char*)malloc(capacity);
+	}
+
+	~LinearArena()
+	{
+		freeOverflow();
+		free(base);
+	}
+
+	LinearArena(const LinearArena&) = delete;
+	LinearArena& operator=(const LinearArena&) = delete;
+
+	// alignment has to be a power of two
+	void* allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+	{
+		uintptr_t start = ((uintptr_t)(base + used) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		size_t end = (size_t)(start - (uintptr_t)base) + size;
+		if (end <= capacity)
+		{
+			used = end;
+			return (void*)start;
+		}
+
+		// doesn't fit, hand out a block of its own for this frame
+		unsigned char* block = (unsigned char*)malloc(size + alignment);
+		overflowBlocks.push_back(block);
+		overflowBytes += size + alignment;
+		return (void*)(((uintptr_t)block + alignment - 1) & ~(uintptr_t)(alignment - 1));
+	}
+
+	template <typename T>
+	T* allocateArray(size_t count)
+	{
+		return (T*)allocate(count * sizeof(T), alignof(T));
+	}
+
+	// everything allocated so far is gone after this
+	void reset()
+	{
+		peak = std::max(peak, bytesUsed());
+		if (overflowBytes > 0)
+		{
+			freeOverflow();
+			free(base);
+			capacity = std::max(capacity * 2, peak);
+			base = (unsigned char*)malloc(capacity);
+			grows++;
+		}
+		used = 0;
+	}
+
+	size_t bytesUsed() const { return used + overflowBytes; }
+	size_t peakBytes() const { return std::max(peak, bytesUsed()); }
+	size_t capacityBytes() const { return capacity; }
+	unsigned int growCount() const { return grows; }
+
+private:
+	unsigned char* base;
+	size_t capacity;
+	size_t used;
+	std::vector<unsigned char*> overflowBlocks;
+	size_t overflowBytes;
+	size_t peak;
+	unsigned int grows;
+
+	void freeOverflow()
+	{
+		for (size_t i = 0; i < overflowBlocks.size(); i++)
+			free(overflowBlocks[i]);
+		overflowBlocks.clear();
+		overflowBytes = 0;
+	}
+};
+
+// ---------------------------------------------------------
+// --------------------------------------------------------- STL adapters
+// ---------------------------------------------------------
+
+// lets standard containers allocate from an arena. deallocate does nothing, the memory comes back on reset(),
+// so reserve() up front: every time a vector grows its old storage stays used until then
+template <typename T>
+struct ArenaAllocator
+{
+	typedef T value_type;
+
+	LinearArena* arena;
+
+	ArenaAllocator(LinearArena& arena) : arena(&arena) {}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+	T* allocate(size_t count) { return arena->allocateArray<T>(count); }
+	void deallocate(T*, size_t) {}
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena == b.arena; }
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena != b.arena; }
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T> >;
+
+// ---------------------------------------------------------
+// --------------------------------------------------------- frame arena
+// ---------------------------------------------------------
+
+// Transient memory for a frame: one sub-arena per thread (index them with JobSystem::threadIndex()) so threads
+// never share one, and two sets of them used on alternate frames. what a frame allocates stays valid through
+// the next frame too, for data the GPU or the next frame still reads, and gets reset the frame after that
+class FrameArena
+{
+public:
+	static const unsigned int FRAMES = 2;
+
+	FrameArena(unsigned int threadCount, size_t bytesPerThread = 1 << 20) : frame(0), lastFrame(0), peakFrame(0)
+	{
+		for (unsigned int f = 0; f < FRAMES; f++)
+			for (unsigned int t = 0; t < threadCount; t++)
+				arenas[f].push_back(std::unique_ptr<LinearArena>(new LinearArena(bytesPerThread)));
+	}
+
+	// call once at the start of every frame, while no job is allocating
+	void beginFrame()
+	{
+		lastFrame = frameBytes();
+		peakFrame = std::max(peakFrame, lastFrame);
+		frame = (frame + 1) % FRAMES;
+		for (size_t t = 0; t < arenas[frame].size(); t++)
+			arenas[frame][t]->reset();
+	}
+
+	LinearArena& arena(unsigned int thread) { return *arenas[frame][thread]; }
+
+	// everything the current frame allocated so far, over all threads
+	size_t frameBytes() const
+	{
+		size_t total = 0;
+		for (size_t t = 0; t < arenas[frame].size(); t++)
+			total += arenas[frame][t]->bytesUsed();
+		return total;
+	}
+
+	size_t lastFrameBytes() const { return lastFrame; }
+	size_t peakFrameBytes() const { return std::max(peakFrame, frameBytes()); }
+
+	unsigned int growCount() const
+	{
+		unsigned int total = 0;
+		for (unsigned int f = 0; f < FRAMES; f++)
+			for (size_t t = 0; t < arenas[f].size(); t++)
+				total += arenas[f][t]->growCount();
+		return total;
+	}
+
+private:
+	std::vector<std::unique_ptr<LinearArena> > arenas[FRAMES];
+	unsigned int frame;
+	size_t lastFrame;
+	size_t peakFrame;
+};
+
+#endif // !FRAME_ARENA_H
@@ -0,0 +1,274 @@
+#pragma once
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <glad/glad.h>
+#include <ImageWriter.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum CaptureFormat
+{
+	CAPTURE_PNG,
+	CAPTURE_RAW   // RGBA bytes, top row first, the size is in the file name
+};
+
+// Saves rendered frames to an image sequence without stalling the render thread.
+//
+// capture() starts an asynchronous glReadPixels into one of a ring of pixel pack buffers and fences it.
+// poll() checks the fences without waiting, copies finished readbacks out and hands them to a worker
+// thread that flips, encodes and writes them. when the ring or the worker falls behind, frames are
+// dropped and counted instead of waiting. works the same on a hidden (headless) window.
+//
+// usage per frame: draw, capture(), swap, poll(). finish() at the end writes out what's still in flight,
+// destroy() frees the gl objects
+class FrameCapture
+{
+public:
+	// ----- stats
+	unsigned int captured = 0;   // readbacks started
+	unsigned int dropped = 0;    // frames skipped because the ring or the writer was full
+	std::atomic<unsigned int> written{ 0 };   // files on disk, counted by the writer thread
+
+	FrameCapture(int width, int height, const std::string& directory, CaptureFormat format = CAPTURE_PNG,
+		unsigned int ringSize = 3, unsigned int maxQueued = 8)
+		: width(width), height(height), directory(directory), format(format), maxQueued(maxQueued), running(true)
+	{
+		slots.resize(ringSize);
+		for (size_t i = 0; i < slots.size(); i++)
+		{
+			glGenBuffers(1, &slots[i].PBO);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, slots[i].PBO);
+			glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes(), NULL, GL_STREAM_READ);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		nextSlot = 0;
+		worker = std::thread(&FrameCapture::writerLoop, this);
+	}
+
+	// reads the current read buffer (the back buffer right before the swap) into the next free slot
+	void capture(unsigned int frame)
+	{
+		Slot& slot = slots[nextSlot];
+		if (slot.fence)
+		{
+			// the oldest readback isn't done yet, waiting for it is exactly the stall this avoids
+			poll();
+			if (slot.fence)
+			{
+				dropped++;
+				return;
+			}
+		}
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		// make sure the fence gets to the gpu, or polling it could never see it signaled
+		glFlush();
+		slot.frame = frame;
+		nextSlot = (nextSlot + 1) % slots.size();
+		captured++;
+	}
+
+	// hands every finished readback to the writer, never waits on the gpu
+	void poll()
+	{
+		// oldest first so frames reach the writer in order
+		for (size_t n = 0; n < slots.size(); n++)
+		{
+			Slot& slot = slots[(nextSlot + n) % slots.size()];
+			if (!slot.fence)
+				continue;
+			GLenum result = glClientWaitSync(slot.fence, 0, 0);
+			if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+				break;
+			collect(slot);
+		}
+	}
+
+	// waits for the last readbacks and for the writer to get everything on disk
+	void finish()
+	{
+		for (size_t n = 0; n < slots.size(); n++)
+		{
+			Slot& slot = slots[(nextSlot + n) % slots.size()];
+			if (!slot.fence)
+				continue;
+			glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000); // 1s
+			collect(slot);
+		}
+		stopWriter();
+	}
+
+	// without finish() the writer still gets what's queued on disk, readbacks in flight are lost. no gl calls
+	// here, the context may already be gone
+	~FrameCapture()
+	{
+		stopWriter();
+	}
+
+	// frees the gl objects, call before the context goes away
+	void destroy()
+	{
+		finish();
+		for (size_t i = 0; i < slots.size(); i++)
+		{
+			if (slots[i].fence)
+				glDeleteSync(slots[i].fence);
+			glDeleteBuffers(1, &slots[i].PBO);
+		}
+		slots.clear();
+	}
+
+	size_t queuedFrames()
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		return queue.size();
+	}
+
+private:
+	struct Slot
+	{
+		unsigned int PBO = 0;
+		GLsync fence = 0;
+		unsigned int frame = 0;
+	};
+
+	struct PendingFrame
+	{
+		unsigned int frame;
+		std::vector<unsigned char> pixels;
+	};
+
+	int width, height;
+	std::string directory;
+	CaptureFormat format;
+	size_t maxQueued;
+	std::vector<Slot> slots;
+	size_t nextSlot;
+
+	// shared with the writer
+	std::thread worker;
+	std::mutex queueMutex;
+	std::condition_variable queueCondition;
+	std::deque<PendingFrame> queue;
+	std::vector<std::vector<unsigned char> > freeBuffers;   // pixel buffers the writer is done with
+	bool running;
+
+	size_t frameBytes() const { return (size_t)width * height * 4; }
+
+	// lets the writer empty the queue and joins it
+	void stopWriter()
+	{
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			running = false;
+		}
+		queueCondition.notify_all();
+		if (worker.joinable())
+			worker.join();
+	}
+
+	// copies a finished readback out of its buffer and queues it for the writer
+	void collect(Slot& slot)
+	{
+		glDeleteSync(slot.fence);
+		slot.fence = 0;
+
+		PendingFrame pending;
+		pending.frame = slot.frame;
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			if (queue.size() >= maxQueued)
+			{
+				dropped++;
+				return;
+			}
+			if (!freeBuffers.empty())
+			{
+				pending.pixels.swap(freeBuffers.back());
+				freeBuffers.pop_back();
+			}
+		}
+		pending.pixels.resize(frameBytes());
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+		void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameBytes(), GL_MAP_READ_BIT);
+		if (mapped)
+		{
+			memcpy(pending.pixels.data(), mapped, frameBytes());
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		if (!mapped)
+		{
+			std::cout << "ERROR::FRAME_CAPTURE::MAP_FAILED" << std::endl;
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			queue.push_back(PendingFrame());
+			queue.back().frame = pending.frame;
+			queue.back().pixels.swap(pending.pixels);
+		}
+		queueCondition.notify_one();
+	}
+
+	void writerLoop()
+	{
+		std::vector<unsigned char> flipped;
+		char path[512];
+		while (true)
+		{
+			PendingFrame pending;
+			{
+				std::unique_lock<std::mutex> lock(queueMutex);
+				queueCondition.wait(lock, [this]() { return !queue.empty() || !running; });
+				if (queue.empty())
+					return;
+				pending.frame = queue.front().frame;
+				pending.pixels.swap(queue.front().pixels);
+				queue.pop_front();
+			}
+
+			// gl reads bottom row first, images want the top row first
+			size_t rowSize = (size_t)width * 4;
+			flipped.resize(frameBytes());
+			for (int y = 0; y < height; y++)
+				memcpy(&flipped[y * rowSize], &pending.pixels[(height - 1 - y) * rowSize], rowSize);
+
+			bool ok;
+			if (format == CAPTURE_PNG)
+			{
+				snprintf(path, sizeof(path), "%s/frame_%06u.png", directory.c_str(), pending.frame);
+				ok = writePng(path, width, height, 4, flipped.data());
+			}
+			else
+			{
+				snprintf(path, sizeof(path), "%s/frame_%06u_%dx%d.rgba", directory.c_str(), pending.frame, width, height);
+				ok = writeRaw(path, width, height, 4, flipped.data());
+			}
+
+			if (ok)
+				written++;
+			std::lock_guard<std::mutex> lock(queueMutex);
+			freeBuffers.push_back(std::vector<unsigned char>());
+			freeBuffers.back().swap(pending.pixels);
+		}
+	}
+};
+
+#endif // !FRAME_CAPTURE_H
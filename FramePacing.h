@@ -0,0 +1,201 @@
+#pragma once
+#ifndef FRAME_PACING_H
+#define FRAME_PACING_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+enum SwapMode
+{
+	SWAP_VSYNC,      // wait for the vertical blank, no tearing, up to a frame of extra latency
+	SWAP_ADAPTIVE,   // vsync, but a late frame is shown right away and tears instead of waiting a whole refresh
+	SWAP_UNCAPPED    // present immediately, lowest latency, tears
+};
+
+struct FramePacingOptions
+{
+	SwapMode swapMode = SWAP_VSYNC;
+	double fpsLimit = 0.0;         // 0 = no limiter
+	bool waitForPresent = false;   // glFinish after the swap so latency is measured to the actual present
+};
+
+// --swap <vsync|adaptive|uncapped> [--fps-limit N] [--wait-present]
+inline void parseFramePacingOptions(int argc, char* argv[], FramePacingOptions& options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--swap") == 0 && i + 1 < argc)
+		{
+			const char* mode = argv[++i];
+			if (strcmp(mode, "vsync") == 0)
+				options.swapMode = SWAP_VSYNC;
+			else if (strcmp(mode, "adaptive") == 0)
+				options.swapMode = SWAP_ADAPTIVE;
+			else if (strcmp(mode, "uncapped") == 0)
+				options.swapMode = SWAP_UNCAPPED;
+			else
+				std::cout << "ERROR::FRAME_PACING::UNKNOWN_SWAP_MODE " << mode << " (vsync, adaptive or uncapped)" << std::endl;
+		}
+		else if (strcmp(argv[i], "--fps-limit") == 0 && i + 1 < argc)
+			options.fpsLimit = atof(argv[++i]);
+		else if (strcmp(argv[i], "--wait-present") == 0)
+			options.waitForPresent = true;
+	}
+}
+
+// sets the swap interval of the current context, returns the interval that was set.
+// adaptive needs the swap_control_tear extension and falls back to plain vsync without it
+inline int applySwapMode(SwapMode mode)
+{
+	int interval = 1;
+	if (mode == SWAP_UNCAPPED)
+		interval = 0;
+	else if (mode == SWAP_ADAPTIVE)
+	{
+		if (glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+			interval = -1;
+		else
+			std::cout << "ERROR::FRAME_PACING::ADAPTIVE_VSYNC_NOT_SUPPORTED using vsync" << std::endl;
+	}
+	glfwSwapInterval(interval);
+	return interval;
+}
+
+// ---------------------------------------------------------
+// --------------------------------------------------------- frame limiter
+// ---------------------------------------------------------
+
+// Holds frames to a target rate. sleeping alone wakes up late by however coarse the os timer is, spinning
+// alone burns a core, so it sleeps until a margin before the deadline and spins the rest. the margin
+// follows how late sleeps actually wake up on this machine
+class FrameLimiter
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	FrameLimiter(double fps = 0.0) : margin(std::chrono::milliseconds(2)), started(false), waitedMs(0.0)
+	{
+		setTarget(fps);
+	}
+
+	// 0 turns it off
+	void setTarget(double fps)
+	{
+		frameDuration = fps > 0.0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps)) : Clock::duration::zero();
+		started = false;
+	}
+
+	// call once a frame, returns when the next frame is due
+	void wait()
+	{
+		waitedMs = 0.0;
+		if (frameDuration == Clock::duration::zero())
+			return;
+
+		Clock::time_point now = Clock::now();
+		if (!started)
+		{
+			nextFrame = now + frameDuration;
+			started = true;
+			return;
+		}
+
+		Clock::time_point start = now;
+		Clock::duration sleepFor = nextFrame - now - margin;
+		if (sleepFor > Clock::duration::zero())
+		{
+			std::this_thread::sleep_for(sleepFor);
+			Clock::duration overshoot = Clock::now() - start - sleepFor;
+			// grow right away when a sleep ran late, shrink slowly when they're on time
+			margin = std::max(margin - margin / 16, overshoot + overshoot / 4);
+			margin = std::min(std::max(margin, Clock::duration(std::chrono::microseconds(500))), Clock::duration(std::chrono::milliseconds(20)));
+		}
+		while (Clock::now() < nextFrame)
+			;
+
+		now = Clock::now();
+		waitedMs = std::chrono::duration<double, std::milli>(now - start).count();
+		// a frame that ran long doesn't get made up for with a burst of short ones
+		nextFrame = now - nextFrame > frameDuration ? now + frameDuration : nextFrame + frameDuration;
+	}
+
+	double lastWaitMs() const { return waitedMs; }
+	double marginMs() const { return std::chrono::duration<double, std::milli>(margin).count(); }
+
+private:
+	Clock::duration frameDuration;
+	Clock::duration margin;
+	Clock::time_point nextFrame;
+	bool started;
+	double waitedMs;
+};
+
+// ---------------------------------------------------------
+// --------------------------------------------------------- latency
+// ---------------------------------------------------------
+
+// Time from sampling input to the frame that used it being presented. swap only queues the frame unless
+// the caller waits for it (glFinish after the swap), without that this is the time to the swap call
+class LatencyTracker
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	LatencyTracker() : sampled(false) {}
+
+	// right after the events were polled and applied
+	void inputSampled()
+	{
+		sampleTime = Clock::now();
+		sampled = true;
+	}
+
+	// right after the swap
+	void presented()
+	{
+		if (!sampled)
+			return;
+		samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - sampleTime).count());
+		sampled = false;
+	}
+
+	size_t sampleCount() const { return samples.size(); }
+
+	double averageMs() const
+	{
+		double sum = 0.0;
+		for (size_t i = 0; i < samples.size(); i++)
+			sum += samples[i];
+		return samples.empty() ? 0.0 : sum / samples.size();
+	}
+
+	// 0.99 gives the 99th percentile
+	double percentileMs(double fraction) const
+	{
+		if (samples.empty())
+			return 0.0;
+		std::vector<double> sorted(samples);
+		size_t n = std::min(sorted.size() - 1, (size_t)(fraction * sorted.size()));
+		std::nth_element(sorted.begin(), sorted.begin() + n, sorted.end());
+		return sorted[n];
+	}
+
+	double maxMs() const { return samples.empty() ? 0.0 : *std::max_element(samples.begin(), samples.end()); }
+
+	void reset() { samples.clear(); }
+
+private:
+	Clock::time_point sampleTime;
+	bool sampled;
+	std::vector<double> samples;
+};
+
+#endif // !FRAME_PACING_H
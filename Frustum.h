@@ -0,0 +1,72 @@
+#pragma once
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+// the six planes of a view frustum, pointing inwards (left, right, bottom, top, near, far)
+struct Frustum
+{
+	glm::vec4 planes[6];
+
+	Frustum() {}
+
+	// Gribb/Hartmann plane extraction from a projection * view matrix
+	Frustum(const glm::mat4& viewProjection)
+	{
+		// glm is column major so a row of the matrix is m[0][i], m[1][i], m[2][i], m[3][i]
+		glm::vec4 rows[4];
+		for (int i = 0; i < 4; i++)
+			rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+		planes[0] = rows[3] + rows[0];
+		planes[1] = rows[3] - rows[0];
+		planes[2] = rows[3] + rows[1];
+		planes[3] = rows[3] - rows[1];
+		planes[4] = rows[3] + rows[2];
+		planes[5] = rows[3] - rows[2];
+
+		for (int i = 0; i < 6; i++)
+			planes[i] = planes[i] / glm::length(glm::vec3(planes[i]));
+	}
+
+	bool intersectsSphere(const glm::vec3& center, float radius) const
+	{
+		for (int i = 0; i < 6; i++)
+			if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius)
+				return false;
+		return true;
+	}
+
+	// conservative: can let through boxes that are outside but near a frustum corner
+	bool intersectsAABB(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			// the corner furthest along the plane normal
+			glm::vec3 p = glm::vec3(planes[i].x > 0.0f ? boxMax.x : boxMin.x,
+				planes[i].y > 0.0f ? boxMax.y : boxMin.y,
+				planes[i].z > 0.0f ? boxMax.z : boxMin.z);
+			if (glm::dot(glm::vec3(planes[i]), p) + planes[i].w < 0.0f)
+				return false;
+		}
+		return true;
+	}
+
+	// true when the whole box is inside, so everything in it can be accepted without testing it again
+	bool containsAABB(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			// the corner least far along the plane normal
+			glm::vec3 p = glm::vec3(planes[i].x > 0.0f ? boxMin.x : boxMax.x,
+				planes[i].y > 0.0f ? boxMin.y : boxMax.y,
+				planes[i].z > 0.0f ? boxMin.z : boxMax.z);
+			if (glm::dot(glm::vec3(planes[i]), p) + planes[i].w < 0.0f)
+				return false;
+		}
+		return true;
+	}
+};
+
+#endif // !FRUSTUM_H
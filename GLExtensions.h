@@ -0,0 +1,145 @@
+#pragma once
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <cstring>
+#include <iostream>
+
+// our glad.c is generated for a 3.3 core profile, so anything newer than that has to be
+// loaded by hand. every block below is skipped if glad gets regenerated for a newer version.
+
+// ---------------------------------------------------------
+// --------------------------------------------------------- GL 4.0 - 4.3 (indirect drawing, SSBOs, texture views)
+// ---------------------------------------------------------
+#ifndef GL_VERSION_4_0
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+#ifndef GL_VERSION_4_2
+#define GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT 0x00000001
+#define GL_TEXTURE_FETCH_BARRIER_BIT 0x00000008
+#define GL_SHADER_IMAGE_ACCESS_BARRIER_BIT 0x00000020
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#define GL_BUFFER_UPDATE_BARRIER_BIT 0x00000200
+#define GL_FRAMEBUFFER_BARRIER_BIT 0x00000400
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#define GL_ALL_BARRIER_BITS 0xFFFFFFFF
+
+typedef void (APIENTRYP PFNGLMEMORYBARRIERPROC) (GLbitfield barriers);
+static PFNGLMEMORYBARRIERPROC glad_glMemoryBarrier = NULL;
+#define glMemoryBarrier glad_glMemoryBarrier
+
+typedef void (APIENTRYP PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC) (GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex, GLuint baseinstance);
+static PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC glad_glDrawElementsInstancedBaseVertexBaseInstance = NULL;
+#define glDrawElementsInstancedBaseVertexBaseInstance glad_glDrawElementsInstancedBaseVertexBaseInstance
+
+typedef void (APIENTRYP PFNGLBINDIMAGETEXTUREPROC) (GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format);
+static PFNGLBINDIMAGETEXTUREPROC glad_glBindImageTexture = NULL;
+#define glBindImageTexture glad_glBindImageTexture
+
+typedef void (APIENTRYP PFNGLTEXSTORAGE2DPROC) (GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+static PFNGLTEXSTORAGE2DPROC glad_glTexStorage2D = NULL;
+#define glTexStorage2D glad_glTexStorage2D
+#endif
+
+#ifndef GL_VERSION_4_3
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#define GL_COMPUTE_SHADER 0x91B9
+
+typedef void (APIENTRYP PFNGLDISPATCHCOMPUTEPROC) (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+static PFNGLDISPATCHCOMPUTEPROC glad_glDispatchCompute = NULL;
+#define glDispatchCompute glad_glDispatchCompute
+
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC) (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+static PFNGLMULTIDRAWELEMENTSINDIRECTPROC glad_glMultiDrawElementsIndirect = NULL;
+#define glMultiDrawElementsIndirect glad_glMultiDrawElementsIndirect
+
+typedef void (APIENTRYP PFNGLTEXTUREVIEWPROC) (GLuint texture, GLenum target, GLuint origtexture, GLenum internalformat, GLuint minlevel, GLuint numlevels, GLuint minlayer, GLuint numlayers);
+static PFNGLTEXTUREVIEWPROC glad_glTextureView = NULL;
+#define glTextureView glad_glTextureView
+#endif
+
+// ---------------------------------------------------------
+// --------------------------------------------------------- GL 4.4 (ARB_buffer_storage)
+// ---------------------------------------------------------
+#ifndef GL_VERSION_4_4
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC) (GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+static PFNGLBUFFERSTORAGEPROC glad_glBufferStorage = NULL;
+#define glBufferStorage glad_glBufferStorage
+#endif
+
+// what the current context can actually do, filled by loadGLExtensions()
+struct GLCapabilities
+{
+	int major = 3;
+	int minor = 3;
+	bool bufferStorage = false;
+	bool multiDrawIndirect = false;    // GL 4.3 glMultiDrawElementsIndirect + SSBOs
+	bool shaderDrawParameters = false; // gl_DrawIDARB / gl_BaseInstanceARB in shaders
+	bool computeShaders = false;       // GL 4.3 compute + glMemoryBarrier + glBindImageTexture
+	bool textureViews = false;         // GL 4.3 glTextureView on glTexStorage2D textures
+};
+static GLCapabilities GLCaps;
+
+// returns true if the context reports the given extension string
+inline bool hasGLExtension(const char* name)
+{
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count; i++)
+	{
+		const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if (ext && strcmp(ext, name) == 0)
+			return true;
+	}
+	return false;
+}
+
+inline bool glVersionAtLeast(int major, int minor)
+{
+	return GLCaps.major > major || (GLCaps.major == major && GLCaps.minor >= minor);
+}
+
+// call once after gladLoadGLLoader, with the context current
+inline void loadGLExtensions()
+{
+	glGetIntegerv(GL_MAJOR_VERSION, &GLCaps.major);
+	glGetIntegerv(GL_MINOR_VERSION, &GLCaps.minor);
+
+#ifndef GL_VERSION_4_2
+	glad_glMemoryBarrier = (PFNGLMEMORYBARRIERPROC)glfwGetProcAddress("glMemoryBarrier");
+	glad_glDrawElementsInstancedBaseVertexBaseInstance = (PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC)glfwGetProcAddress("glDrawElementsInstancedBaseVertexBaseInstance");
+	glad_glBindImageTexture = (PFNGLBINDIMAGETEXTUREPROC)glfwGetProcAddress("glBindImageTexture");
+	glad_glTexStorage2D = (PFNGLTEXSTORAGE2DPROC)glfwGetProcAddress("glTexStorage2D");
+#endif
+#ifndef GL_VERSION_4_3
+	glad_glMultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)glfwGetProcAddress("glMultiDrawElementsIndirect");
+	glad_glDispatchCompute = (PFNGLDISPATCHCOMPUTEPROC)glfwGetProcAddress("glDispatchCompute");
+	glad_glTextureView = (PFNGLTEXTUREVIEWPROC)glfwGetProcAddress("glTextureView");
+#endif
+#ifndef GL_VERSION_4_4
+	glad_glBufferStorage = (PFNGLBUFFERSTORAGEPROC)glfwGetProcAddress("glBufferStorage");
+#endif
+	GLCaps.bufferStorage = (glVersionAtLeast(4, 4) || hasGLExtension("GL_ARB_buffer_storage")) && glBufferStorage != NULL;
+	GLCaps.multiDrawIndirect = glVersionAtLeast(4, 3) && glMultiDrawElementsIndirect != NULL && glDrawElementsInstancedBaseVertexBaseInstance != NULL;
+	GLCaps.shaderDrawParameters = glVersionAtLeast(4, 6) || hasGLExtension("GL_ARB_shader_draw_parameters");
+	GLCaps.computeShaders = glVersionAtLeast(4, 3) && glDispatchCompute != NULL && glMemoryBarrier != NULL && glBindImageTexture != NULL;
+	GLCaps.textureViews = glVersionAtLeast(4, 3) && glTexStorage2D != NULL && glTextureView != NULL;
+
+	std::cout << "OpenGL " << GLCaps.major << "." << GLCaps.minor
+		<< " (buffer storage: " << (GLCaps.bufferStorage ? "yes" : "no")
+		<< ", multi draw indirect: " << (GLCaps.multiDrawIndirect ? "yes" : "no")
+		<< ", draw parameters: " << (GLCaps.shaderDrawParameters ? "yes" : "no")
+		<< ", compute: " << (GLCaps.computeShaders ? "yes" : "no")
+		<< ", texture views: " << (GLCaps.textureViews ? "yes" : "no") << ")" << std::endl;
+}
+
+#endif // !GL_EXTENSIONS_H
@@ -0,0 +1,677 @@
+#pragma once
+#ifndef GL_TRACE_H
+#define GL_TRACE_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Records what a demo sends to GL into a binary trace that GLTraceReplay.cpp plays back without the demo.
+//
+// startGLTrace() swaps the glad function pointers of the calls below for wrappers that append the call and
+// its arguments to the trace and then call the driver. buffer and texture data is copied into the trace, so
+// the replay gets the same uploads, and object names and uniform locations are remapped on replay.
+// traceFrameEnd() before every swap marks where a frame ends. start right after glad is loaded so the
+// objects the frames use are created inside the trace.
+//
+// not recorded: calls that only read state back (glGet*, query results, glReadPixels), entry points loaded by
+// GLExtensions.h, and writes through a persistent coherent mapping, which never go through a GL call
+
+// ---------------------------------------------------------
+// --------------------------------------------------------- format
+// ---------------------------------------------------------
+
+// header: "GLTR", version, width, height. then records of { uint16 call, uint32 argument bytes, arguments },
+// the arguments packed in parameter order, with pointers stored as offsets and arrays as a count and the data
+const uint32_t GL_TRACE_VERSION = 1;
+
+#define GL_TRACE_CALLS(X) \
+	X(FRAME_END) \
+	X(GEN_BUFFERS) X(DELETE_BUFFERS) X(BIND_BUFFER) X(BIND_BUFFER_BASE) X(BIND_BUFFER_RANGE) \
+	X(BUFFER_DATA) X(BUFFER_SUB_DATA) X(BUFFER_WRITE) \
+	X(GEN_VERTEX_ARRAYS) X(DELETE_VERTEX_ARRAYS) X(BIND_VERTEX_ARRAY) X(VERTEX_ATTRIB_POINTER) X(VERTEX_ATTRIB_I_POINTER) \
+	X(ENABLE_VERTEX_ATTRIB_ARRAY) X(DISABLE_VERTEX_ATTRIB_ARRAY) X(VERTEX_ATTRIB_DIVISOR) \
+	X(GEN_TEXTURES) X(DELETE_TEXTURES) X(BIND_TEXTURE) X(ACTIVE_TEXTURE) X(TEX_PARAMETER_I) X(TEX_PARAMETER_F) \
+	X(PIXEL_STORE_I) X(TEX_IMAGE_2D) X(TEX_SUB_IMAGE_2D) X(GENERATE_MIPMAP) \
+	X(GEN_FRAMEBUFFERS) X(DELETE_FRAMEBUFFERS) X(BIND_FRAMEBUFFER) X(FRAMEBUFFER_TEXTURE_2D) X(GEN_RENDERBUFFERS) \
+	X(DELETE_RENDERBUFFERS) X(BIND_RENDERBUFFER) X(RENDERBUFFER_STORAGE) X(FRAMEBUFFER_RENDERBUFFER) X(DRAW_BUFFERS) \
+	X(BLIT_FRAMEBUFFER) \
+	X(CREATE_SHADER) X(DELETE_SHADER) X(SHADER_SOURCE) X(COMPILE_SHADER) X(CREATE_PROGRAM) X(DELETE_PROGRAM) \
+	X(ATTACH_SHADER) X(LINK_PROGRAM) X(USE_PROGRAM) X(GET_UNIFORM_LOCATION) \
+	X(UNIFORM_1I) X(UNIFORM_1UI) X(UNIFORM_1F) X(UNIFORM_2F) X(UNIFORM_3F) X(UNIFORM_4F) X(UNIFORM_1IV) X(UNIFORM_1FV) \
+	X(UNIFORM_2FV) X(UNIFORM_3FV) X(UNIFORM_4FV) X(UNIFORM_MATRIX_3FV) X(UNIFORM_MATRIX_4FV) \
+	X(ENABLE) X(DISABLE) X(VIEWPORT) X(SCISSOR) X(BLEND_FUNC) X(BLEND_FUNC_SEPARATE) X(BLEND_EQUATION) X(DEPTH_FUNC) \
+	X(DEPTH_MASK) X(COLOR_MASK) X(CULL_FACE) X(STENCIL_FUNC) X(STENCIL_OP) X(STENCIL_MASK) X(CLEAR_COLOR) X(CLEAR_DEPTH) \
+	X(CLEAR_STENCIL) X(CLEAR) \
+	X(DRAW_ARRAYS) X(DRAW_ARRAYS_INSTANCED) X(DRAW_ELEMENTS) X(DRAW_ELEMENTS_BASE_VERTEX) X(DRAW_ELEMENTS_INSTANCED) \
+	X(DRAW_ELEMENTS_INSTANCED_BASE_VERTEX) \
+	X(GEN_QUERIES) X(DELETE_QUERIES) X(BEGIN_QUERY) X(END_QUERY) \
+	X(FENCE_SYNC) X(CLIENT_WAIT_SYNC) X(WAIT_SYNC) X(DELETE_SYNC) X(FLUSH) X(FINISH)
+
+#define GL_TRACE_ENUM(name) TRACE_##name,
+enum TraceCall : uint16_t
+{
+	GL_TRACE_CALLS(GL_TRACE_ENUM)
+	TRACE_CALL_COUNT
+};
+#undef GL_TRACE_ENUM
+
+inline const char* traceCallName(unsigned int call)
+{
+#define GL_TRACE_NAME(name) #name,
+	static const char* names[] = { GL_TRACE_CALLS(GL_TRACE_NAME) };
+#undef GL_TRACE_NAME
+	return call < TRACE_CALL_COUNT ? names[call] : "UNKNOWN";
+}
+
+// bytes glTexImage2D reads for the given size, format and unpack state
+inline size_t traceImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type, GLint alignment, GLint rowLength)
+{
+	size_t components = 4;
+	switch (format)
+	{
+	case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX: components = 1; break;
+	case GL_RG: case GL_RG_INTEGER: case GL_DEPTH_STENCIL: components = 2; break;
+	case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: components = 3; break;
+	}
+	size_t pixelSize;
+	switch (type)
+	{
+	case GL_UNSIGNED_BYTE: case GL_BYTE: pixelSize = components; break;
+	case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: pixelSize = components * 2; break;
+	case GL_UNSIGNED_SHORT_5_6_5: case GL_UNSIGNED_SHORT_4_4_4_4: case GL_UNSIGNED_SHORT_5_5_5_1: pixelSize = 2; break;
+	case GL_UNSIGNED_INT_24_8: case GL_UNSIGNED_INT_2_10_10_10_REV: case GL_UNSIGNED_INT_10F_11F_11F_REV: pixelSize = 4; break;
+	case GL_FLOAT_32_UNSIGNED_INT_24_8_REV: pixelSize = 8; break;
+	default: pixelSize = components * 4; break;   // (unsigned) int and float
+	}
+	if (width <= 0 || height <= 0)
+		return 0;
+	size_t rowBytes = (size_t)(rowLength > 0 ? rowLength : width) * pixelSize;
+	rowBytes = (rowBytes + alignment - 1) / alignment * alignment;
+	return rowBytes * (height - 1) + (size_t)width * pixelSize;
+}
+
+// ---------------------------------------------------------
+// --------------------------------------------------------- recorder
+// ---------------------------------------------------------
+
+#define GL_TRACE_REAL(name) decltype(glad_gl##name) name
+
+struct GLTraceRecorder
+{
+	FILE* file = NULL;
+	std::vector<unsigned char> buffer;   // records waiting to be written, flushed once a frame
+	unsigned int frames = 0;
+	uint64_t calls = 0;
+	uint64_t bytesWritten = 0;
+
+	// write mappings waiting for their unmap or flush, their data goes into the trace then
+	struct Mapping
+	{
+		GLuint buffer;
+		GLintptr offset;
+		GLsizeiptr length;
+		GLbitfield access;
+		const unsigned char* data;
+	};
+	std::vector<Mapping> mappings;
+
+	// fences are pointers, the trace numbers them instead
+	std::unordered_map<GLsync, uint32_t> syncIds;
+	uint32_t nextSyncId = 1;
+
+	// the driver functions the wrappers forward to
+	struct
+	{
+		GL_TRACE_REAL(GenBuffers); GL_TRACE_REAL(DeleteBuffers); GL_TRACE_REAL(BindBuffer); GL_TRACE_REAL(BindBufferBase);
+		GL_TRACE_REAL(BindBufferRange); GL_TRACE_REAL(BufferData); GL_TRACE_REAL(BufferSubData); GL_TRACE_REAL(MapBufferRange);
+		GL_TRACE_REAL(FlushMappedBufferRange); GL_TRACE_REAL(UnmapBuffer);
+		GL_TRACE_REAL(GenVertexArrays); GL_TRACE_REAL(DeleteVertexArrays); GL_TRACE_REAL(BindVertexArray);
+		GL_TRACE_REAL(VertexAttribPointer); GL_TRACE_REAL(VertexAttribIPointer); GL_TRACE_REAL(EnableVertexAttribArray);
+		GL_TRACE_REAL(DisableVertexAttribArray); GL_TRACE_REAL(VertexAttribDivisor);
+		GL_TRACE_REAL(GenTextures); GL_TRACE_REAL(DeleteTextures); GL_TRACE_REAL(BindTexture); GL_TRACE_REAL(ActiveTexture);
+		GL_TRACE_REAL(TexParameteri); GL_TRACE_REAL(TexParameterf); GL_TRACE_REAL(PixelStorei); GL_TRACE_REAL(TexImage2D);
+		GL_TRACE_REAL(TexSubImage2D); GL_TRACE_REAL(GenerateMipmap);
+		GL_TRACE_REAL(GenFramebuffers); GL_TRACE_REAL(DeleteFramebuffers); GL_TRACE_REAL(BindFramebuffer);
+		GL_TRACE_REAL(FramebufferTexture2D); GL_TRACE_REAL(GenRenderbuffers); GL_TRACE_REAL(DeleteRenderbuffers);
+		GL_TRACE_REAL(BindRenderbuffer); GL_TRACE_REAL(RenderbufferStorage); GL_TRACE_REAL(FramebufferRenderbuffer);
+		GL_TRACE_REAL(DrawBuffers); GL_TRACE_REAL(BlitFramebuffer);
+		GL_TRACE_REAL(CreateShader); GL_TRACE_REAL(DeleteShader); GL_TRACE_REAL(ShaderSource); GL_TRACE_REAL(CompileShader);
+		GL_TRACE_REAL(CreateProgram); GL_TRACE_REAL(DeleteProgram); GL_TRACE_REAL(AttachShader); GL_TRACE_REAL(LinkProgram);
+		GL_TRACE_REAL(UseProgram); GL_TRACE_REAL(GetUniformLocation);
+		GL_TRACE_REAL(Uniform1i); GL_TRACE_REAL(Uniform1ui); GL_TRACE_REAL(Uniform1f); GL_TRACE_REAL(Uniform2f);
+		GL_TRACE_REAL(Uniform3f); GL_TRACE_REAL(Uniform4f); GL_TRACE_REAL(Uniform1iv); GL_TRACE_REAL(Uniform1fv);
+		GL_TRACE_REAL(Uniform2fv); GL_TRACE_REAL(Uniform3fv); GL_TRACE_REAL(Uniform4fv); GL_TRACE_REAL(UniformMatrix3fv);
+		GL_TRACE_REAL(UniformMatrix4fv);
+		GL_TRACE_REAL(Enable); GL_TRACE_REAL(Disable); GL_TRACE_REAL(Viewport); GL_TRACE_REAL(Scissor); GL_TRACE_REAL(BlendFunc);
+		GL_TRACE_REAL(BlendFuncSeparate); GL_TRACE_REAL(BlendEquation); GL_TRACE_REAL(DepthFunc); GL_TRACE_REAL(DepthMask);
+		GL_TRACE_REAL(ColorMask); GL_TRACE_REAL(CullFace); GL_TRACE_REAL(StencilFunc); GL_TRACE_REAL(StencilOp);
+		GL_TRACE_REAL(StencilMask); GL_TRACE_REAL(ClearColor); GL_TRACE_REAL(ClearDepth); GL_TRACE_REAL(ClearStencil);
+		GL_TRACE_REAL(Clear);
+		GL_TRACE_REAL(DrawArrays); GL_TRACE_REAL(DrawArraysInstanced); GL_TRACE_REAL(DrawElements);
+		GL_TRACE_REAL(DrawElementsBaseVertex); GL_TRACE_REAL(DrawElementsInstanced); GL_TRACE_REAL(DrawElementsInstancedBaseVertex);
+		GL_TRACE_REAL(GenQueries); GL_TRACE_REAL(DeleteQueries); GL_TRACE_REAL(BeginQuery); GL_TRACE_REAL(EndQuery);
+		GL_TRACE_REAL(FenceSync); GL_TRACE_REAL(ClientWaitSync); GL_TRACE_REAL(WaitSync); GL_TRACE_REAL(DeleteSync);
+		GL_TRACE_REAL(Flush); GL_TRACE_REAL(Finish);
+	} real;
+
+	bool active() const { return file != NULL; }
+
+	template <typename T>
+	void put(const T& value)
+	{
+		const unsigned char* bytes = (const unsigned char*)&value;
+		buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+	}
+
+	void putBytes(const void* data, size_t size)
+	{
+		put((uint32_t)size);
+		if (size > 0)
+			buffer.insert(buffer.end(), (const unsigned char*)data, (const unsigned char*)data + size);
+	}
+
+	void putString(const char* text) { putBytes(text, strlen(text)); }
+
+	// offsets into bound buffers travel as pointers
+	void putOffset(const void* pointer) { put((uint64_t)(uintptr_t)pointer); }
+
+	size_t begin(TraceCall call)
+	{
+		put((uint16_t)call);
+		put((uint32_t)0);
+		return buffer.size();
+	}
+
+	void end(size_t start)
+	{
+		uint32_t size = (uint32_t)(buffer.size() - start);
+		memcpy(&buffer[start - sizeof(uint32_t)], &size, sizeof(size));
+		calls++;
+	}
+
+	template <typename... Args>
+	void record(TraceCall call, const Args&... args)
+	{
+		size_t start = begin(call);
+		int expand[] = { 0, (put(args), 0)... };
+		(void)expand;
+		end(start);
+	}
+
+	void recordNames(TraceCall call, GLsizei n, const GLuint* names)
+	{
+		size_t start = begin(call);
+		putBytes(names, n > 0 ? n * sizeof(GLuint) : 0);
+		end(start);
+	}
+
+	void recordFloats(TraceCall call, GLint location, GLsizei count, const GLfloat* values, size_t perElement)
+	{
+		size_t start = begin(call);
+		put(location);
+		putBytes(values, count > 0 ? count * perElement * sizeof(GLfloat) : 0);
+		end(start);
+	}
+
+	void recordMatrices(TraceCall call, GLint location, GLsizei count, GLboolean transpose, const GLfloat* values, size_t perElement)
+	{
+		size_t start = begin(call);
+		put(location);
+		put(transpose);
+		putBytes(values, count > 0 ? count * perElement * sizeof(GLfloat) : 0);
+		end(start);
+	}
+
+	uint32_t syncId(GLsync sync)
+	{
+		std::unordered_map<GLsync, uint32_t>::iterator it = syncIds.find(sync);
+		return it != syncIds.end() ? it->second : 0;
+	}
+
+	void flushToFile()
+	{
+		if (!file || buffer.empty())
+			return;
+		bytesWritten += fwrite(buffer.data(), 1, buffer.size(), file);
+		buffer.clear();
+	}
+};
+static GLTraceRecorder GLTrace;
+
+// the buffer bound to a buffer target right now, needed to know which buffer a map or unmap is about
+inline GLuint traceBoundBuffer(GLenum target)
+{
+	GLenum binding = 0;
+	switch (target)
+	{
+	case GL_ARRAY_BUFFER: binding = GL_ARRAY_BUFFER_BINDING; break;
+	case GL_ELEMENT_ARRAY_BUFFER: binding = GL_ELEMENT_ARRAY_BUFFER_BINDING; break;
+	case GL_UNIFORM_BUFFER: binding = GL_UNIFORM_BUFFER_BINDING; break;
+	case GL_COPY_READ_BUFFER: binding = GL_COPY_READ_BUFFER; break;     // the copy targets double as their binding query
+	case GL_COPY_WRITE_BUFFER: binding = GL_COPY_WRITE_BUFFER; break;
+	case GL_PIXEL_PACK_BUFFER: binding = GL_PIXEL_PACK_BUFFER_BINDING; break;
+	case GL_PIXEL_UNPACK_BUFFER: binding = GL_PIXEL_UNPACK_BUFFER_BINDING; break;
+	case GL_TEXTURE_BUFFER: binding = GL_TEXTURE_BINDING_BUFFER; break;
+	case GL_TRANSFORM_FEEDBACK_BUFFER: binding = GL_TRANSFORM_FEEDBACK_BUFFER_BINDING; break;
+	case 0x8F3F: binding = 0x8F43; break;   // GL_DRAW_INDIRECT_BUFFER(_BINDING)
+	case 0x90D2: binding = 0x90D3; break;   // GL_SHADER_STORAGE_BUFFER(_BINDING)
+	}
+	GLint buffer = 0;
+	if (binding)
+		glGetIntegerv(binding, &buffer);
+	return (GLuint)buffer;
+}
+
+// texture uploads: 0 = no data, 1 = the pixels follow, 2 = an offset into the bound unpack buffer
+inline void traceImageData(GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+{
+	GLint alignment = 4, rowLength = 0, unpackBuffer = 0;
+	glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+	glGetIntegerv(GL_UNPACK_ROW_LENGTH, &rowLength);
+	glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpackBuffer);
+	if (unpackBuffer)
+	{
+		GLTrace.put((uint8_t)2);
+		GLTrace.putOffset(pixels);
+	}
+	else if (pixels)
+	{
+		GLTrace.put((uint8_t)1);
+		GLTrace.putBytes(pixels, traceImageSize(width, height, format, type, alignment, rowLength));
+	}
+	else
+		GLTrace.put((uint8_t)0);
+}
+
+// the data written through a mapping, replayed as a glBufferSubData
+inline void traceBufferWrite(GLuint buffer, GLintptr offset, GLsizeiptr length, const void* data)
+{
+	size_t start = GLTrace.begin(TRACE_BUFFER_WRITE);
+	GLTrace.put(buffer);
+	GLTrace.put((int64_t)offset);
+	GLTrace.putBytes(data, (size_t)length);
+	GLTrace.end(start);
+}
+
+// ---------------------------------------------------------
+// --------------------------------------------------------- wrappers
+// ---------------------------------------------------------
+
+namespace GLTraceWrappers
+{
+	// ----- buffers
+	static void APIENTRY GenBuffers(GLsizei n, GLuint* names) { GLTrace.real.GenBuffers(n, names); GLTrace.recordNames(TRACE_GEN_BUFFERS, n, names); }
+	static void APIENTRY DeleteBuffers(GLsizei n, const GLuint* names) { GLTrace.recordNames(TRACE_DELETE_BUFFERS, n, names); GLTrace.real.DeleteBuffers(n, names); }
+	static void APIENTRY BindBuffer(GLenum target, GLuint buffer) { GLTrace.record(TRACE_BIND_BUFFER, target, buffer); GLTrace.real.BindBuffer(target, buffer); }
+	static void APIENTRY BindBufferBase(GLenum target, GLuint index, GLuint buffer) { GLTrace.record(TRACE_BIND_BUFFER_BASE, target, index, buffer); GLTrace.real.BindBufferBase(target, index, buffer); }
+	static void APIENTRY BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+	{
+		GLTrace.record(TRACE_BIND_BUFFER_RANGE, target, index, buffer, (int64_t)offset, (int64_t)size);
+		GLTrace.real.BindBufferRange(target, index, buffer, offset, size);
+	}
+
+	static void APIENTRY BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+	{
+		size_t start = GLTrace.begin(TRACE_BUFFER_DATA);
+		GLTrace.put(target);
+		GLTrace.put((int64_t)size);
+		GLTrace.put(usage);
+		GLTrace.putBytes(data, data ? (size_t)size : 0);
+		GLTrace.end(start);
+		GLTrace.real.BufferData(target, size, data, usage);
+	}
+
+	static void APIENTRY BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+	{
+		size_t start = GLTrace.begin(TRACE_BUFFER_SUB_DATA);
+		GLTrace.put(target);
+		GLTrace.put((int64_t)offset);
+		GLTrace.putBytes(data, (size_t)size);
+		GLTrace.end(start);
+		GLTrace.real.BufferSubData(target, offset, size, data);
+	}
+
+	// mapping isn't recorded itself, whatever was written shows up as a BUFFER_WRITE at the flush or unmap
+	static void* APIENTRY MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+	{
+		void* data = GLTrace.real.MapBufferRange(target, offset, length, access);
+		if (data && (access & GL_MAP_WRITE_BIT))
+		{
+			GLTraceRecorder::Mapping mapping = { traceBoundBuffer(target), offset, length, access, (const unsigned char*)data };
+			GLTrace.mappings.push_back(mapping);
+		}
+		return data;
+	}
+
+	static void APIENTRY FlushMappedBufferRange(GLenum target, GLintptr offset, GLsizeiptr length)
+	{
+		GLuint buffer = traceBoundBuffer(target);
+		for (size_t i = 0; i < GLTrace.mappings.size(); i++)
+			if (GLTrace.mappings[i].buffer == buffer)
+				traceBufferWrite(buffer, GLTrace.mappings[i].offset + offset, length, GLTrace.mappings[i].data + offset);
+		GLTrace.real.FlushMappedBufferRange(target, offset, length);
+	}
+
+	static GLboolean APIENTRY UnmapBuffer(GLenum target)
+	{
+		GLuint buffer = traceBoundBuffer(target);
+		for (size_t i = 0; i < GLTrace.mappings.size(); i++)
+		{
+			GLTraceRecorder::Mapping& mapping = GLTrace.mappings[i];
+			if (mapping.buffer != buffer)
+				continue;
+			// with explicit flushing only the flushed ranges are defined, and those are in the trace already
+			if (!(mapping.access & GL_MAP_FLUSH_EXPLICIT_BIT))
+				traceBufferWrite(buffer, mapping.offset, mapping.length, mapping.data);
+			GLTrace.mappings.erase(GLTrace.mappings.begin() + i);
+			break;
+		}
+		return GLTrace.real.UnmapBuffer(target);
+	}
+
+	// ----- vertex arrays
+	static void APIENTRY GenVertexArrays(GLsizei n, GLuint* names) { GLTrace.real.GenVertexArrays(n, names); GLTrace.recordNames(TRACE_GEN_VERTEX_ARRAYS, n, names); }
+	static void APIENTRY DeleteVertexArrays(GLsizei n, const GLuint* names) { GLTrace.recordNames(TRACE_DELETE_VERTEX_ARRAYS, n, names); GLTrace.real.DeleteVertexArrays(n, names); }
+	static void APIENTRY BindVertexArray(GLuint array) { GLTrace.record(TRACE_BIND_VERTEX_ARRAY, array); GLTrace.real.BindVertexArray(array); }
+	static void APIENTRY VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer)
+	{
+		GLTrace.record(TRACE_VERTEX_ATTRIB_POINTER, index, size, type, normalized, stride, (uint64_t)(uintptr_t)pointer);
+		GLTrace.real.VertexAttribPointer(index, size, type, normalized, stride, pointer);
+	}
+	static void APIENTRY VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer)
+	{
+		GLTrace.record(TRACE_VERTEX_ATTRIB_I_POINTER, index, size, type, stride, (uint64_t)(uintptr_t)pointer);
+		GLTrace.real.VertexAttribIPointer(index, size, type, stride, pointer);
+	}
+	static void APIENTRY EnableVertexAttribArray(GLuint index) { GLTrace.record(TRACE_ENABLE_VERTEX_ATTRIB_ARRAY, index); GLTrace.real.EnableVertexAttribArray(index); }
+	static void APIENTRY DisableVertexAttribArray(GLuint index) { GLTrace.record(TRACE_DISABLE_VERTEX_ATTRIB_ARRAY, index); GLTrace.real.DisableVertexAttribArray(index); }
+	static void APIENTRY VertexAttribDivisor(GLuint index, GLuint divisor) { GLTrace.record(TRACE_VERTEX_ATTRIB_DIVISOR, index, divisor); GLTrace.real.VertexAttribDivisor(index, divisor); }
+
+	// ----- textures
+	static void APIENTRY GenTextures(GLsizei n, GLuint* names) { GLTrace.real.GenTextures(n, names); GLTrace.recordNames(TRACE_GEN_TEXTURES, n, names); }
+	static void APIENTRY DeleteTextures(GLsizei n, const GLuint* names) { GLTrace.recordNames(TRACE_DELETE_TEXTURES, n, names); GLTrace.real.DeleteTextures(n, names); }
+	static void APIENTRY BindTexture(GLenum target, GLuint texture) { GLTrace.record(TRACE_BIND_TEXTURE, target, texture); GLTrace.real.BindTexture(target, texture); }
+	static void APIENTRY ActiveTexture(GLenum texture) { GLTrace.record(TRACE_ACTIVE_TEXTURE, texture); GLTrace.real.ActiveTexture(texture); }
+	static void APIENTRY TexParameteri(GLenum target, GLenum name, GLint value) { GLTrace.record(TRACE_TEX_PARAMETER_I, target, name, value); GLTrace.real.TexParameteri(target, name, value); }
+	static void APIENTRY TexParameterf(GLenum target, GLenum name, GLfloat value) { GLTrace.record(TRACE_TEX_PARAMETER_F, target, name, value); GLTrace.real.TexParameterf(target, name, value); }
+	static void APIENTRY PixelStorei(GLenum name, GLint value) { GLTrace.record(TRACE_PIXEL_STORE_I, name, value); GLTrace.real.PixelStorei(name, value); }
+	static void APIENTRY TexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)
+	{
+		size_t start = GLTrace.begin(TRACE_TEX_IMAGE_2D);
+		GLTrace.put(target); GLTrace.put(level); GLTrace.put(internalFormat); GLTrace.put(width); GLTrace.put(height);
+		GLTrace.put(border); GLTrace.put(format); GLTrace.put(type);
+		traceImageData(width, height, format, type, pixels);
+		GLTrace.end(start);
+		GLTrace.real.TexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+	}
+	static void APIENTRY TexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+	{
+		size_t start = GLTrace.begin(TRACE_TEX_SUB_IMAGE_2D);
+		GLTrace.put(target); GLTrace.put(level); GLTrace.put(x); GLTrace.put(y); GLTrace.put(width); GLTrace.put(height);
+		GLTrace.put(format); GLTrace.put(type);
+		traceImageData(width, height, format, type, pixels);
+		GLTrace.end(start);
+		GLTrace.real.TexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+	}
+	static void APIENTRY GenerateMipmap(GLenum target) { GLTrace.record(TRACE_GENERATE_MIPMAP, target); GLTrace.real.GenerateMipmap(target); }
+
+	// ----- framebuffers
+	static void APIENTRY GenFramebuffers(GLsizei n, GLuint* names) { GLTrace.real.GenFramebuffers(n, names); GLTrace.recordNames(TRACE_GEN_FRAMEBUFFERS, n, names); }
+	static void APIENTRY DeleteFramebuffers(GLsizei n, const GLuint* names) { GLTrace.recordNames(TRACE_DELETE_FRAMEBUFFERS, n, names); GLTrace.real.DeleteFramebuffers(n, names); }
+	static void APIENTRY BindFramebuffer(GLenum target, GLuint framebuffer) { GLTrace.record(TRACE_BIND_FRAMEBUFFER, target, framebuffer); GLTrace.real.BindFramebuffer(target, framebuffer); }
+	static void APIENTRY FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture, GLint level)
+	{
+		GLTrace.record(TRACE_FRAMEBUFFER_TEXTURE_2D, target, attachment, textureTarget, texture, level);
+		GLTrace.real.FramebufferTexture2D(target, attachment, textureTarget, texture, level);
+	}
+	static void APIENTRY GenRenderbuffers(GLsizei n, GLuint* names) { GLTrace.real.GenRenderbuffers(n, names); GLTrace.recordNames(TRACE_GEN_RENDERBUFFERS, n, names); }
+	static void APIENTRY DeleteRenderbuffers(GLsizei n, const GLuint* names) { GLTrace.recordNames(TRACE_DELETE_RENDERBUFFERS, n, names); GLTrace.real.DeleteRenderbuffers(n, names); }
+	static void APIENTRY BindRenderbuffer(GLenum target, GLuint renderbuffer) { GLTrace.record(TRACE_BIND_RENDERBUFFER, target, renderbuffer); GLTrace.real.BindRenderbuffer(target, renderbuffer); }
+	static void APIENTRY RenderbufferStorage(GLenum target, GLenum internalFormat, GLsizei width, GLsizei height)
+	{
+		GLTrace.record(TRACE_RENDERBUFFER_STORAGE, target, internalFormat, width, height);
+		GLTrace.real.RenderbufferStorage(target, internalFormat, width, height);
+	}
+	static void APIENTRY FramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer)
+	{
+		GLTrace.record(TRACE_FRAMEBUFFER_RENDERBUFFER, target, attachment, renderbufferTarget, renderbuffer);
+		GLTrace.real.FramebufferRenderbuffer(target, attachment, renderbufferTarget, renderbuffer);
+	}
+	static void APIENTRY DrawBuffers(GLsizei n, const GLenum* buffers)
+	{
+		size_t start = GLTrace.begin(TRACE_DRAW_BUFFERS);
+		GLTrace.putBytes(buffers, n > 0 ? n * sizeof(GLenum) : 0);
+		GLTrace.end(start);
+		GLTrace.real.DrawBuffers(n, buffers);
+	}
+	static void APIENTRY BlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+	{
+		GLTrace.record(TRACE_BLIT_FRAMEBUFFER, srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+		GLTrace.real.BlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+	}
+
+	// ----- shaders and uniforms
+	static GLuint APIENTRY CreateShader(GLenum type) { GLuint shader = GLTrace.real.CreateShader(type); GLTrace.record(TRACE_CREATE_SHADER, type, shader); return shader; }
+	static void APIENTRY DeleteShader(GLuint shader) { GLTrace.record(TRACE_DELETE_SHADER, shader); GLTrace.real.DeleteShader(shader); }
+	static void APIENTRY ShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+	{
+		// the pieces are joined into one string
+		std::string source;
+		for (GLsizei i = 0; i < count; i++)
+			source.append(strings[i], lengths && lengths[i] >= 0 ? (size_t)lengths[i] : strlen(strings[i]));
+		size_t start = GLTrace.begin(TRACE_SHADER_SOURCE);
+		GLTrace.put(shader);
+		GLTrace.putBytes(source.data(), source.size());
+		GLTrace.end(start);
+		GLTrace.real.ShaderSource(shader, count, strings, lengths);
+	}
+	static void APIENTRY CompileShader(GLuint shader) { GLTrace.record(TRACE_COMPILE_SHADER, shader); GLTrace.real.CompileShader(shader); }
+	static GLuint APIENTRY CreateProgram() { GLuint program = GLTrace.real.CreateProgram(); GLTrace.record(TRACE_CREATE_PROGRAM, program); return program; }
+	static void APIENTRY DeleteProgram(GLuint program) { GLTrace.record(TRACE_DELETE_PROGRAM, program); GLTrace.real.DeleteProgram(program); }
+	static void APIENTRY AttachShader(GLuint program, GLuint shader) { GLTrace.record(TRACE_ATTACH_SHADER, program, shader); GLTrace.real.AttachShader(program, shader); }
+	static void APIENTRY LinkProgram(GLuint program) { GLTrace.record(TRACE_LINK_PROGRAM, program); GLTrace.real.LinkProgram(program); }
+	static void APIENTRY UseProgram(GLuint program) { GLTrace.record(TRACE_USE_PROGRAM, program); GLTrace.real.UseProgram(program); }
+	// the replay looks the name up again and maps the recorded location to its own
+	static GLint APIENTRY GetUniformLocation(GLuint program, const GLchar* name)
+	{
+		GLint location = GLTrace.real.GetUniformLocation(program, name);
+		size_t start = GLTrace.begin(TRACE_GET_UNIFORM_LOCATION);
+		GLTrace.put(program);
+		GLTrace.put(location);
+		GLTrace.putString(name);
+		GLTrace.end(start);
+		return location;
+	}
+	static void APIENTRY Uniform1i(GLint location, GLint v0) { GLTrace.record(TRACE_UNIFORM_1I, location, v0); GLTrace.real.Uniform1i(location, v0); }
+	static void APIENTRY Uniform1ui(GLint location, GLuint v0) { GLTrace.record(TRACE_UNIFORM_1UI, location, v0); GLTrace.real.Uniform1ui(location, v0); }
+	static void APIENTRY Uniform1f(GLint location, GLfloat v0) { GLTrace.record(TRACE_UNIFORM_1F, location, v0); GLTrace.real.Uniform1f(location, v0); }
+	static void APIENTRY Uniform2f(GLint location, GLfloat v0, GLfloat v1) { GLTrace.record(TRACE_UNIFORM_2F, location, v0, v1); GLTrace.real.Uniform2f(location, v0, v1); }
+	static void APIENTRY Uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) { GLTrace.record(TRACE_UNIFORM_3F, location, v0, v1, v2); GLTrace.real.Uniform3f(location, v0, v1, v2); }
+	static void APIENTRY Uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) { GLTrace.record(TRACE_UNIFORM_4F, location, v0, v1, v2, v3); GLTrace.real.Uniform4f(location, v0, v1, v2, v3); }
+	static void APIENTRY Uniform1iv(GLint location, GLsizei count, const GLint* values)
+	{
+		size_t start = GLTrace.begin(TRACE_UNIFORM_1IV);
+		GLTrace.put(location);
+		GLTrace.putBytes(values, count > 0 ? count * sizeof(GLint) : 0);
+		GLTrace.end(start);
+		GLTrace.real.Uniform1iv(location, count, values);
+	}
+	static void APIENTRY Uniform1fv(GLint location, GLsizei count, const GLfloat* values) { GLTrace.recordFloats(TRACE_UNIFORM_1FV, location, count, values, 1); GLTrace.real.Uniform1fv(location, count, values); }
+	static void APIENTRY Uniform2fv(GLint location, GLsizei count, const GLfloat* values) { GLTrace.recordFloats(TRACE_UNIFORM_2FV, location, count, values, 2); GLTrace.real.Uniform2fv(location, count, values); }
+	static void APIENTRY Uniform3fv(GLint location, GLsizei count, const GLfloat* values) { GLTrace.recordFloats(TRACE_UNIFORM_3FV, location, count, values, 3); GLTrace.real.Uniform3fv(location, count, values); }
+	static void APIENTRY Uniform4fv(GLint location, GLsizei count, const GLfloat* values) { GLTrace.recordFloats(TRACE_UNIFORM_4FV, location, count, values, 4); GLTrace.real.Uniform4fv(location, count, values); }
+	static void APIENTRY UniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* values)
+	{
+		GLTrace.recordMatrices(TRACE_UNIFORM_MATRIX_3FV, location, count, transpose, values, 9);
+		GLTrace.real.UniformMatrix3fv(location, count, transpose, values);
+	}
+	static void APIENTRY UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* values)
+	{
+		GLTrace.recordMatrices(TRACE_UNIFORM_MATRIX_4FV, location, count, transpose, values, 16);
+		GLTrace.real.UniformMatrix4fv(location, count, transpose, values);
+	}
+
+	// ----- fixed function state
+	static void APIENTRY Enable(GLenum cap) { GLTrace.record(TRACE_ENABLE, cap); GLTrace.real.Enable(cap); }
+	static void APIENTRY Disable(GLenum cap) { GLTrace.record(TRACE_DISABLE, cap); GLTrace.real.Disable(cap); }
+	static void APIENTRY Viewport(GLint x, GLint y, GLsizei width, GLsizei height) { GLTrace.record(TRACE_VIEWPORT, x, y, width, height); GLTrace.real.Viewport(x, y, width, height); }
+	static void APIENTRY Scissor(GLint x, GLint y, GLsizei width, GLsizei height) { GLTrace.record(TRACE_SCISSOR, x, y, width, height); GLTrace.real.Scissor(x, y, width, height); }
+	static void APIENTRY BlendFunc(GLenum source, GLenum destination) { GLTrace.record(TRACE_BLEND_FUNC, source, destination); GLTrace.real.BlendFunc(source, destination); }
+	static void APIENTRY BlendFuncSeparate(GLenum sourceRGB, GLenum destinationRGB, GLenum sourceAlpha, GLenum destinationAlpha)
+	{
+		GLTrace.record(TRACE_BLEND_FUNC_SEPARATE, sourceRGB, destinationRGB, sourceAlpha, destinationAlpha);
+		GLTrace.real.BlendFuncSeparate(sourceRGB, destinationRGB, sourceAlpha, destinationAlpha);
+	}
+	static void APIENTRY BlendEquation(GLenum mode) { GLTrace.record(TRACE_BLEND_EQUATION, mode); GLTrace.real.BlendEquation(mode); }
+	static void APIENTRY DepthFunc(GLenum func) { GLTrace.record(TRACE_DEPTH_FUNC, func); GLTrace.real.DepthFunc(func); }
+	static void APIENTRY DepthMask(GLboolean flag) { GLTrace.record(TRACE_DEPTH_MASK, flag); GLTrace.real.DepthMask(flag); }
+	static void APIENTRY ColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) { GLTrace.record(TRACE_COLOR_MASK, red, green, blue, alpha); GLTrace.real.ColorMask(red, green, blue, alpha); }
+	static void APIENTRY CullFace(GLenum mode) { GLTrace.record(TRACE_CULL_FACE, mode); GLTrace.real.CullFace(mode); }
+	static void APIENTRY StencilFunc(GLenum func, GLint reference, GLuint mask) { GLTrace.record(TRACE_STENCIL_FUNC, func, reference, mask); GLTrace.real.StencilFunc(func, reference, mask); }
+	static void APIENTRY StencilOp(GLenum fail, GLenum depthFail, GLenum depthPass) { GLTrace.record(TRACE_STENCIL_OP, fail, depthFail, depthPass); GLTrace.real.StencilOp(fail, depthFail, depthPass); }
+	static void APIENTRY StencilMask(GLuint mask) { GLTrace.record(TRACE_STENCIL_MASK, mask); GLTrace.real.StencilMask(mask); }
+	static void APIENTRY ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) { GLTrace.record(TRACE_CLEAR_COLOR, red, green, blue, alpha); GLTrace.real.ClearColor(red, green, blue, alpha); }
+	static void APIENTRY ClearDepth(GLdouble depth) { GLTrace.record(TRACE_CLEAR_DEPTH, depth); GLTrace.real.ClearDepth(depth); }
+	static void APIENTRY ClearStencil(GLint stencil) { GLTrace.record(TRACE_CLEAR_STENCIL, stencil); GLTrace.real.ClearStencil(stencil); }
+	static void APIENTRY Clear(GLbitfield mask) { GLTrace.record(TRACE_CLEAR, mask); GLTrace.real.Clear(mask); }
+
+	// ----- draws, indices always come from the bound element buffer in core profile
+	static void APIENTRY DrawArrays(GLenum mode, GLint first, GLsizei count) { GLTrace.record(TRACE_DRAW_ARRAYS, mode, first, count); GLTrace.real.DrawArrays(mode, first, count); }
+	static void APIENTRY DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances)
+	{
+		GLTrace.record(TRACE_DRAW_ARRAYS_INSTANCED, mode, first, count, instances);
+		GLTrace.real.DrawArraysInstanced(mode, first, count, instances);
+	}
+	static void APIENTRY DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+	{
+		GLTrace.record(TRACE_DRAW_ELEMENTS, mode, count, type, (uint64_t)(uintptr_t)indices);
+		GLTrace.real.DrawElements(mode, count, type, indices);
+	}
+	static void APIENTRY DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint baseVertex)
+	{
+		GLTrace.record(TRACE_DRAW_ELEMENTS_BASE_VERTEX, mode, count, type, (uint64_t)(uintptr_t)indices, baseVertex);
+		GLTrace.real.DrawElementsBaseVertex(mode, count, type, indices, baseVertex);
+	}
+	static void APIENTRY DrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instances)
+	{
+		GLTrace.record(TRACE_DRAW_ELEMENTS_INSTANCED, mode, count, type, (uint64_t)(uintptr_t)indices, instances);
+		GLTrace.real.DrawElementsInstanced(mode, count, type, indices, instances);
+	}
+	static void APIENTRY DrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instances, GLint baseVertex)
+	{
+		GLTrace.record(TRACE_DRAW_ELEMENTS_INSTANCED_BASE_VERTEX, mode, count, type, (uint64_t)(uintptr_t)indices, instances, baseVertex);
+		GLTrace.real.DrawElementsInstancedBaseVertex(mode, count, type, indices, instances, baseVertex);
+	}
+
+	// ----- queries and sync
+	static void APIENTRY GenQueries(GLsizei n, GLuint* names) { GLTrace.real.GenQueries(n, names); GLTrace.recordNames(TRACE_GEN_QUERIES, n, names); }
+	static void APIENTRY DeleteQueries(GLsizei n, const GLuint* names) { GLTrace.recordNames(TRACE_DELETE_QUERIES, n, names); GLTrace.real.DeleteQueries(n, names); }
+	static void APIENTRY BeginQuery(GLenum target, GLuint query) { GLTrace.record(TRACE_BEGIN_QUERY, target, query); GLTrace.real.BeginQuery(target, query); }
+	static void APIENTRY EndQuery(GLenum target) { GLTrace.record(TRACE_END_QUERY, target); GLTrace.real.EndQuery(target); }
+	static GLsync APIENTRY FenceSync(GLenum condition, GLbitfield flags)
+	{
+		GLsync sync = GLTrace.real.FenceSync(condition, flags);
+		uint32_t id = GLTrace.nextSyncId++;
+		GLTrace.syncIds[sync] = id;
+		GLTrace.record(TRACE_FENCE_SYNC, condition, flags, id);
+		return sync;
+	}
+	static GLenum APIENTRY ClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+	{
+		GLTrace.record(TRACE_CLIENT_WAIT_SYNC, GLTrace.syncId(sync), flags, timeout);
+		return GLTrace.real.ClientWaitSync(sync, flags, timeout);
+	}
+	static void APIENTRY WaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+	{
+		GLTrace.record(TRACE_WAIT_SYNC, GLTrace.syncId(sync), flags, timeout);
+		GLTrace.real.WaitSync(sync, flags, timeout);
+	}
+	static void APIENTRY DeleteSync(GLsync sync)
+	{
+		GLTrace.record(TRACE_DELETE_SYNC, GLTrace.syncId(sync));
+		GLTrace.syncIds.erase(sync);
+		GLTrace.real.DeleteSync(sync);
+	}
+	static void APIENTRY Flush() { GLTrace.record(TRACE_FLUSH); GLTrace.real.Flush(); }
+	static void APIENTRY Finish() { GLTrace.record(TRACE_FINISH); GLTrace.real.Finish(); }
+}
+
+// swaps a glad pointer for its wrapper (install) or back (uninstall)
+#define GL_TRACE_INSTALL(name) GLTrace.real.name = glad_gl##name; glad_gl##name = GLTraceWrappers::name
+#define GL_TRACE_UNINSTALL(name) glad_gl##name = GLTrace.real.name
+
+#define GL_TRACE_FOR_EACH(X) \
+	X(GenBuffers); X(DeleteBuffers); X(BindBuffer); X(BindBufferBase); X(BindBufferRange); X(BufferData); X(BufferSubData); \
+	X(MapBufferRange); X(FlushMappedBufferRange); X(UnmapBuffer); \
+	X(GenVertexArrays); X(DeleteVertexArrays); X(BindVertexArray); X(VertexAttribPointer); X(VertexAttribIPointer); \
+	X(EnableVertexAttribArray); X(DisableVertexAttribArray); X(VertexAttribDivisor); \
+	X(GenTextures); X(DeleteTextures); X(BindTexture); X(ActiveTexture); X(TexParameteri); X(TexParameterf); X(PixelStorei); \
+	X(TexImage2D); X(TexSubImage2D); X(GenerateMipmap); \
+	X(GenFramebuffers); X(DeleteFramebuffers); X(BindFramebuffer); X(FramebufferTexture2D); X(GenRenderbuffers); \
+	X(DeleteRenderbuffers); X(BindRenderbuffer); X(RenderbufferStorage); X(FramebufferRenderbuffer); X(DrawBuffers); X(BlitFramebuffer); \
+	X(CreateShader); X(DeleteShader); X(ShaderSource); X(CompileShader); X(CreateProgram); X(DeleteProgram); X(AttachShader); \
+	X(LinkProgram); X(UseProgram); X(GetUniformLocation); \
+	X(Uniform1i); X(Uniform1ui); X(Uniform1f); X(Uniform2f); X(Uniform3f); X(Uniform4f); X(Uniform1iv); X(Uniform1fv); \
+	X(Uniform2fv); X(Uniform3fv); X(Uniform4fv); X(UniformMatrix3fv); X(UniformMatrix4fv); \
+	X(Enable); X(Disable); X(Viewport); X(Scissor); X(BlendFunc); X(BlendFuncSeparate); X(BlendEquation); X(DepthFunc); \
+	X(DepthMask); X(ColorMask); X(CullFace); X(StencilFunc); X(StencilOp); X(StencilMask); X(ClearColor); X(ClearDepth); \
+	X(ClearStencil); X(Clear); \
+	X(DrawArrays); X(DrawArraysInstanced); X(DrawElements); X(DrawElementsBaseVertex); X(DrawElementsInstanced); \
+	X(DrawElementsInstancedBaseVertex); \
+	X(GenQueries); X(DeleteQueries); X(BeginQuery); X(EndQuery); \
+	X(FenceSync); X(ClientWaitSync); X(WaitSync); X(DeleteSync); X(Flush); X(Finish)
+
+// starts recording every call below into path. width and height are what the replay opens its window with
+inline bool startGLTrace(const char* path, int width, int height)
+{
+	if (GLTrace.active())
+		return false;
+	GLTrace.file = fopen(path, "wb");
+	if (!GLTrace.file)
+	{
+		std::cout << "ERROR::GL_TRACE::FILE_NOT_SUCCESFULLY_WRITTEN " << path << std::endl;
+		return false;
+	}
+	GLTrace.buffer.clear();
+	GLTrace.buffer.insert(GLTrace.buffer.end(), "GLTR", "GLTR" + 4);
+	GLTrace.put(GL_TRACE_VERSION);
+	GLTrace.put((int32_t)width);
+	GLTrace.put((int32_t)height);
+	GLTrace.frames = 0;
+	GLTrace.calls = 0;
+	GLTrace.bytesWritten = 0;
+	GL_TRACE_FOR_EACH(GL_TRACE_INSTALL);
+	return true;
+}
+
+// call right before swapping, marks the end of a frame and writes the frame out
+inline void traceFrameEnd()
+{
+	if (!GLTrace.active())
+		return;
+	GLTrace.record(TRACE_FRAME_END);
+	GLTrace.frames++;
+	GLTrace.flushToFile();
+}
+
+// puts the driver functions back and closes the trace
+inline void stopGLTrace()
+{
+	if (!GLTrace.active())
+		return;
+	GL_TRACE_FOR_EACH(GL_TRACE_UNINSTALL);
+	GLTrace.flushToFile();
+	fclose(GLTrace.file);
+	GLTrace.file = NULL;
+	GLTrace.mappings.clear();
+	GLTrace.syncIds.clear();
+}
+
+#endif // !GL_TRACE_H
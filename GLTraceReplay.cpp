@@ -0,0 +1,841 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <GLTrace.h>
+
+// Plays back a trace written by GLTrace.h (--trace on RenderQueueCubes) in a hidden window and times every
+// call, to see what the driver costs per call without the demo around it. the first frame also creates
+// everything, so it's reported on its own and --loops only repeats the frames after it
+
+struct TraceRecord
+{
+	uint16_t call;
+	uint32_t size;
+	size_t offset;   // of the arguments
+};
+
+// reads the packed arguments of one record in order
+struct TraceCursor
+{
+	const unsigned char* data;
+	size_t offset;
+
+	template <typename T>
+	T get()
+	{
+		T value;
+		memcpy(&value, data + offset, sizeof(T));
+		offset += sizeof(T);
+		return value;
+	}
+
+	// a count prefixed array, returns its bytes
+	const unsigned char* bytes(uint32_t& size)
+	{
+		size = get<uint32_t>();
+		const unsigned char* start = data + offset;
+		offset += size;
+		return start;
+	}
+
+	const void* pointer() { return (const void*)(uintptr_t)get<uint64_t>(); }
+};
+
+// trace names to the names this context handed out
+struct ReplayState
+{
+	std::unordered_map<GLuint, GLuint> buffers, vertexArrays, textures, framebuffers, renderbuffers, queries, shaders, programs;
+	std::unordered_map<uint64_t, GLint> locations;   // (trace program << 32) | trace location
+	std::unordered_map<uint32_t, GLsync> syncs;
+	GLuint currentProgram = 0;                       // trace name
+	std::vector<GLuint> names;                       // scratch for gen and delete
+};
+
+struct CallStats
+{
+	uint64_t count = 0;
+	double totalMs = 0.0;
+	double maxMs = 0.0;
+};
+
+void replayCall(const TraceRecord& record, const unsigned char* data, ReplayState& state);
+
+int main(int argc, char* argv[])
+{
+	// --trace <file> the trace to play, --loops N plays the frames after the first N times, --show keeps the window visible
+	std::string tracePath = "frame.trace";
+	int loops = 1;
+	bool show = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+			tracePath = argv[++i];
+		else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc)
+			loops = std::max(1, atoi(argv[++i]));
+		else if (strcmp(argv[i], "--show") == 0)
+			show = true;
+	}
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Reading the trace
+	// ---------------------------------------------------------
+
+	std::vector<unsigned char> trace;
+	FILE* file = fopen(tracePath.c_str(), "rb");
+	if (!file)
+	{
+		std::cout << "ERROR::GL_TRACE::FILE_NOT_SUCCESFULLY_READ " << tracePath << std::endl;
+		return -1;
+	}
+	fseek(file, 0, SEEK_END);
+	long fileSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	trace.resize(fileSize > 0 ? (size_t)fileSize : 0);
+	size_t readSize = fread(trace.data(), 1, trace.size(), file);
+	fclose(file);
+
+	const size_t HEADER_SIZE = 16;
+	uint32_t version = 0;
+	int32_t width = 0, height = 0;
+	if (readSize == trace.size() && trace.size() >= HEADER_SIZE && memcmp(trace.data(), "GLTR", 4) == 0)
+	{
+		memcpy(&version, &trace[4], 4);
+		memcpy(&width, &trace[8], 4);
+		memcpy(&height, &trace[12], 4);
+	}
+	if (version != GL_TRACE_VERSION || width <= 0 || height <= 0)
+	{
+		std::cout << "ERROR::GL_TRACE::NOT_A_TRACE " << tracePath << std::endl;
+		return -1;
+	}
+
+	// index every record once so the replay loop doesn't parse headers
+	std::vector<TraceRecord> records;
+	std::vector<size_t> frameEnds;   // index of every FRAME_END record
+	size_t offset = HEADER_SIZE;
+	while (offset + 6 <= trace.size())
+	{
+		TraceRecord record;
+		memcpy(&record.call, &trace[offset], 2);
+		memcpy(&record.size, &trace[offset + 2], 4);
+		record.offset = offset + 6;
+		if (record.offset + record.size > trace.size() || record.call >= TRACE_CALL_COUNT)
+		{
+			std::cout << "ERROR::GL_TRACE::CORRUPT_RECORD at byte " << offset << ", replaying what came before" << std::endl;
+			break;
+		}
+		if (record.call == TRACE_FRAME_END)
+			frameEnds.push_back(records.size());
+		records.push_back(record);
+		offset = record.offset + record.size;
+	}
+	if (frameEnds.empty())
+	{
+		std::cout << "ERROR::GL_TRACE::NO_FRAMES " << tracePath << std::endl;
+		return -1;
+	}
+	std::cout << tracePath << ": " << frameEnds.size() << " frames, " << records.size() << " calls, " << trace.size() / 1024 << " KB, "
+		<< width << "x" << height << std::endl;
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- GlAD, GLFW and OpenGL setup
+	// ---------------------------------------------------------
+
+	// initilize the glfw library
+	glfwInit();
+
+	// the recorder only knows 3.3 calls
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	if (!show)
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	// the default framebuffer has to be the size the trace was recorded at
+	GLFWwindow* window = glfwCreateWindow(width, height, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	// GLAD initilization
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initilize GLAD" << std::endl;
+		return -1;
+	}
+	// replay as fast as the gpu goes
+	glfwSwapInterval(0);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Replay
+	// ---------------------------------------------------------
+
+	ReplayState state;
+	std::vector<CallStats> callStats(TRACE_CALL_COUNT);
+	std::vector<double> frameMs, submitMs;
+	double setupMs = 0.0;
+	typedef std::chrono::high_resolution_clock Clock;
+
+	// frame 0 once, then the rest loops times
+	size_t totalFrames = frameEnds.size() > 1 ? 1 + (frameEnds.size() - 1) * loops : 1;
+	for (size_t f = 0; f < totalFrames && !glfwWindowShouldClose(window); f++)
+	{
+		size_t frame = f == 0 ? 0 : 1 + (f - 1) % (frameEnds.size() - 1);
+		size_t first = frame == 0 ? 0 : frameEnds[frame - 1] + 1;
+		size_t last = frameEnds[frame];
+		// the first frame's calls are mostly object creation, keep them out of the per call numbers
+		bool timed = frame > 0 || frameEnds.size() == 1;
+
+		Clock::time_point frameStart = Clock::now();
+		double callsMs = 0.0;
+		for (size_t r = first; r < last; r++)
+		{
+			Clock::time_point start = Clock::now();
+			replayCall(records[r], trace.data(), state);
+			double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+			callsMs += ms;
+			if (timed)
+			{
+				CallStats& stats = callStats[records[r].call];
+				stats.count++;
+				stats.totalMs += ms;
+				stats.maxMs = std::max(stats.maxMs, ms);
+			}
+		}
+
+		// the frame is done when the gpu is, not when the last call returned
+		glFinish();
+		double ms = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+		if (frame == 0)
+			setupMs = ms;
+		if (timed)
+		{
+			frameMs.push_back(ms);
+			submitMs.push_back(callsMs);
+		}
+
+		if (show)
+			glfwSwapBuffers(window);
+		glfwPollEvents();
+	}
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Report
+	// ---------------------------------------------------------
+
+	if (frameEnds.size() > 1)
+		printf("frame 0 (setup): %.2f ms\n", setupMs);
+	if (!frameMs.empty())
+	{
+		double frameSum = 0.0, submitSum = 0.0;
+		for (size_t i = 0; i < frameMs.size(); i++)
+		{
+			frameSum += frameMs[i];
+			submitSum += submitMs[i];
+		}
+		std::vector<double> sorted(frameMs);
+		std::sort(sorted.begin(), sorted.end());
+		printf("%zu frames: %.2f ms avg, %.2f min, %.2f median, %.2f max | calls %.2f ms avg (time spent inside the driver calls)\n",
+			frameMs.size(), frameSum / frameMs.size(), sorted.front(), sorted[sorted.size() / 2], sorted.back(), submitSum / frameMs.size());
+	}
+
+	// most expensive calls first
+	std::vector<unsigned int> order;
+	for (unsigned int c = 0; c < TRACE_CALL_COUNT; c++)
+		if (callStats[c].count > 0 && c != TRACE_FRAME_END)
+			order.push_back(c);
+	std::sort(order.begin(), order.end(), [&callStats](unsigned int a, unsigned int b) { return callStats[a].totalMs > callStats[b].totalMs; });
+	printf("%-36s %10s %12s %10s %10s\n", "call", "count", "total ms", "avg us", "max us");
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		const CallStats& stats = callStats[order[i]];
+		printf("%-36s %10llu %12.3f %10.2f %10.2f\n", traceCallName(order[i]), (unsigned long long)stats.count, stats.totalMs,
+			stats.totalMs * 1000.0 / stats.count, stats.maxMs * 1000.0);
+	}
+
+	// glfw: terminate, clearing all previously allocated GLFW resources (and the replayed objects with the context).
+	// ------------------------------------------------------------------
+	glfwTerminate();
+	return 0;
+}
+
+// ---------------------------------------------------------
+// --------------------------------------------------------- playing one call
+// ---------------------------------------------------------
+
+GLuint mapName(const std::unordered_map<GLuint, GLuint>& names, GLuint traceName)
+{
+	if (traceName == 0)
+		return 0;
+	std::unordered_map<GLuint, GLuint>::const_iterator it = names.find(traceName);
+	// objects made before the recording started don't exist here, the name is the best guess
+	return it != names.end() ? it->second : traceName;
+}
+
+GLint mapLocation(const ReplayState& state, GLint location)
+{
+	if (location < 0)
+		return location;
+	std::unordered_map<uint64_t, GLint>::const_iterator it = state.locations.find(((uint64_t)state.currentProgram << 32) | (uint32_t)location);
+	return it != state.locations.end() ? it->second : -1;
+}
+
+// glGen* into the map
+void replayGen(TraceCursor& args, ReplayState& state, std::unordered_map<GLuint, GLuint>& names, void (APIENTRYP gen)(GLsizei, GLuint*))
+{
+	uint32_t size;
+	const unsigned char* traced = args.bytes(size);
+	GLsizei n = (GLsizei)(size / sizeof(GLuint));
+	state.names.resize(n);
+	gen(n, state.names.data());
+	for (GLsizei i = 0; i < n; i++)
+	{
+		GLuint traceName;
+		memcpy(&traceName, traced + i * sizeof(GLuint), sizeof(GLuint));
+		names[traceName] = state.names[i];
+	}
+}
+
+// glDelete* out of the map
+void replayDelete(TraceCursor& args, ReplayState& state, std::unordered_map<GLuint, GLuint>& names, void (APIENTRYP del)(GLsizei, const GLuint*))
+{
+	uint32_t size;
+	const unsigned char* traced = args.bytes(size);
+	GLsizei n = (GLsizei)(size / sizeof(GLuint));
+	state.names.resize(n);
+	for (GLsizei i = 0; i < n; i++)
+	{
+		GLuint traceName;
+		memcpy(&traceName, traced + i * sizeof(GLuint), sizeof(GLuint));
+		state.names[i] = mapName(names, traceName);
+		names.erase(traceName);
+	}
+	del(n, state.names.data());
+}
+
+// the pixels of a texture upload, as a pointer or an offset into the unpack buffer
+const void* replayImageData(TraceCursor& args)
+{
+	uint8_t kind = args.get<uint8_t>();
+	if (kind == 2)
+		return args.pointer();
+	if (kind == 1)
+	{
+		uint32_t size;
+		return args.bytes(size);
+	}
+	return NULL;
+}
+
+void replayCall(const TraceRecord& record, const unsigned char* data, ReplayState& state)
+{
+	TraceCursor args = { data, record.offset };
+	uint32_t size;
+	switch (record.call)
+	{
+	case TRACE_FRAME_END:
+		break;
+
+	// ----- buffers
+	case TRACE_GEN_BUFFERS: replayGen(args, state, state.buffers, glGenBuffers); break;
+	case TRACE_DELETE_BUFFERS: replayDelete(args, state, state.buffers, glDeleteBuffers); break;
+	case TRACE_BIND_BUFFER:
+	{
+		GLenum target = args.get<GLenum>();
+		glBindBuffer(target, mapName(state.buffers, args.get<GLuint>()));
+		break;
+	}
+	case TRACE_BIND_BUFFER_BASE:
+	{
+		GLenum target = args.get<GLenum>();
+		GLuint index = args.get<GLuint>();
+		glBindBufferBase(target, index, mapName(state.buffers, args.get<GLuint>()));
+		break;
+	}
+	case TRACE_BIND_BUFFER_RANGE:
+	{
+		GLenum target = args.get<GLenum>();
+		GLuint index = args.get<GLuint>();
+		GLuint buffer = mapName(state.buffers, args.get<GLuint>());
+		GLintptr bufferOffset = (GLintptr)args.get<int64_t>();
+		glBindBufferRange(target, index, buffer, bufferOffset, (GLsizeiptr)args.get<int64_t>());
+		break;
+	}
+	case TRACE_BUFFER_DATA:
+	{
+		GLenum target = args.get<GLenum>();
+		GLsizeiptr bufferSize = (GLsizeiptr)args.get<int64_t>();
+		GLenum usage = args.get<GLenum>();
+		const unsigned char* bytes = args.bytes(size);
+		glBufferData(target, bufferSize, size > 0 ? bytes : NULL, usage);
+		break;
+	}
+	case TRACE_BUFFER_SUB_DATA:
+	{
+		GLenum target = args.get<GLenum>();
+		GLintptr bufferOffset = (GLintptr)args.get<int64_t>();
+		const unsigned char* bytes = args.bytes(size);
+		glBufferSubData(target, bufferOffset, size, bytes);
+		break;
+	}
+	case TRACE_BUFFER_WRITE:
+	{
+		// what was written through a mapping, the copy target leaves every other binding alone
+		GLuint buffer = mapName(state.buffers, args.get<GLuint>());
+		GLintptr bufferOffset = (GLintptr)args.get<int64_t>();
+		const unsigned char* bytes = args.bytes(size);
+		GLint previous = 0;
+		glGetIntegerv(GL_COPY_WRITE_BUFFER, &previous);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, bufferOffset, size, bytes);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, (GLuint)previous);
+		break;
+	}
+
+	// ----- vertex arrays
+	case TRACE_GEN_VERTEX_ARRAYS: replayGen(args, state, state.vertexArrays, glGenVertexArrays); break;
+	case TRACE_DELETE_VERTEX_ARRAYS: replayDelete(args, state, state.vertexArrays, glDeleteVertexArrays); break;
+	case TRACE_BIND_VERTEX_ARRAY: glBindVertexArray(mapName(state.vertexArrays, args.get<GLuint>())); break;
+	case TRACE_VERTEX_ATTRIB_POINTER:
+	{
+		GLuint index = args.get<GLuint>();
+		GLint components = args.get<GLint>();
+		GLenum type = args.get<GLenum>();
+		GLboolean normalized = args.get<GLboolean>();
+		GLsizei stride = args.get<GLsizei>();
+		glVertexAttribPointer(index, components, type, normalized, stride, args.pointer());
+		break;
+	}
+	case TRACE_VERTEX_ATTRIB_I_POINTER:
+	{
+		GLuint index = args.get<GLuint>();
+		GLint components = args.get<GLint>();
+		GLenum type = args.get<GLenum>();
+		GLsizei stride = args.get<GLsizei>();
+		glVertexAttribIPointer(index, components, type, stride, args.pointer());
+		break;
+	}
+	case TRACE_ENABLE_VERTEX_ATTRIB_ARRAY: glEnableVertexAttribArray(args.get<GLuint>()); break;
+	case TRACE_DISABLE_VERTEX_ATTRIB_ARRAY: glDisableVertexAttribArray(args.get<GLuint>()); break;
+	case TRACE_VERTEX_ATTRIB_DIVISOR:
+	{
+		GLuint index = args.get<GLuint>();
+		glVertexAttribDivisor(index, args.get<GLuint>());
+		break;
+	}
+
+	// ----- textures
+	case TRACE_GEN_TEXTURES: replayGen(args, state, state.textures, glGenTextures); break;
+	case TRACE_DELETE_TEXTURES: replayDelete(args, state, state.textures, glDeleteTextures); break;
+	case TRACE_BIND_TEXTURE:
+	{
+		GLenum target = args.get<GLenum>();
+		glBindTexture(target, mapName(state.textures, args.get<GLuint>()));
+		break;
+	}
+	case TRACE_ACTIVE_TEXTURE: glActiveTexture(args.get<GLenum>()); break;
+	case TRACE_TEX_PARAMETER_I:
+	{
+		GLenum target = args.get<GLenum>();
+		GLenum name = args.get<GLenum>();
+		glTexParameteri(target, name, args.get<GLint>());
+		break;
+	}
+	case TRACE_TEX_PARAMETER_F:
+	{
+		GLenum target = args.get<GLenum>();
+		GLenum name = args.get<GLenum>();
+		glTexParameterf(target, name, args.get<GLfloat>());
+		break;
+	}
+	case TRACE_PIXEL_STORE_I:
+	{
+		GLenum name = args.get<GLenum>();
+		glPixelStorei(name, args.get<GLint>());
+		break;
+	}
+	case TRACE_TEX_IMAGE_2D:
+	{
+		GLenum target = args.get<GLenum>();
+		GLint level = args.get<GLint>();
+		GLint internalFormat = args.get<GLint>();
+		GLsizei imageWidth = args.get<GLsizei>();
+		GLsizei imageHeight = args.get<GLsizei>();
+		GLint border = args.get<GLint>();
+		GLenum format = args.get<GLenum>();
+		GLenum type = args.get<GLenum>();
+		glTexImage2D(target, level, internalFormat, imageWidth, imageHeight, border, format, type, replayImageData(args));
+		break;
+	}
+	case TRACE_TEX_SUB_IMAGE_2D:
+	{
+		GLenum target = args.get<GLenum>();
+		GLint level = args.get<GLint>();
+		GLint x = args.get<GLint>();
+		GLint y = args.get<GLint>();
+		GLsizei imageWidth = args.get<GLsizei>();
+		GLsizei imageHeight = args.get<GLsizei>();
+		GLenum format = args.get<GLenum>();
+		GLenum type = args.get<GLenum>();
+		glTexSubImage2D(target, level, x, y, imageWidth, imageHeight, format, type, replayImageData(args));
+		break;
+	}
+	case TRACE_GENERATE_MIPMAP: glGenerateMipmap(args.get<GLenum>()); break;
+
+	// ----- framebuffers
+	case TRACE_GEN_FRAMEBUFFERS: replayGen(args, state, state.framebuffers, glGenFramebuffers); break;
+	case TRACE_DELETE_FRAMEBUFFERS: replayDelete(args, state, state.framebuffers, glDeleteFramebuffers); break;
+	case TRACE_BIND_FRAMEBUFFER:
+	{
+		GLenum target = args.get<GLenum>();
+		glBindFramebuffer(target, mapName(state.framebuffers, args.get<GLuint>()));
+		break;
+	}
+	case TRACE_FRAMEBUFFER_TEXTURE_2D:
+	{
+		GLenum target = args.get<GLenum>();
+		GLenum attachment = args.get<GLenum>();
+		GLenum textureTarget = args.get<GLenum>();
+		GLuint texture = mapName(state.textures, args.get<GLuint>());
+		glFramebufferTexture2D(target, attachment, textureTarget, texture, args.get<GLint>());
+		break;
+	}
+	case TRACE_GEN_RENDERBUFFERS: replayGen(args, state, state.renderbuffers, glGenRenderbuffers); break;
+	case TRACE_DELETE_RENDERBUFFERS: replayDelete(args, state, state.renderbuffers, glDeleteRenderbuffers); break;
+	case TRACE_BIND_RENDERBUFFER:
+	{
+		GLenum target = args.get<GLenum>();
+		glBindRenderbuffer(target, mapName(state.renderbuffers, args.get<GLuint>()));
+		break;
+	}
+	case TRACE_RENDERBUFFER_STORAGE:
+	{
+		GLenum target = args.get<GLenum>();
+		GLenum internalFormat = args.get<GLenum>();
+		GLsizei storageWidth = args.get<GLsizei>();
+		glRenderbufferStorage(target, internalFormat, storageWidth, args.get<GLsizei>());
+		break;
+	}
+	case TRACE_FRAMEBUFFER_RENDERBUFFER:
+	{
+		GLenum target = args.get<GLenum>();
+		GLenum attachment = args.get<GLenum>();
+		GLenum renderbufferTarget = args.get<GLenum>();
+		glFramebufferRenderbuffer(target, attachment, renderbufferTarget, mapName(state.renderbuffers, args.get<GLuint>()));
+		break;
+	}
+	case TRACE_DRAW_BUFFERS:
+	{
+		const unsigned char* bytes = args.bytes(size);
+		glDrawBuffers((GLsizei)(size / sizeof(GLenum)), (const GLenum*)bytes);
+		break;
+	}
+	case TRACE_BLIT_FRAMEBUFFER:
+	{
+		GLint coordinates[8];
+		for (int i = 0; i < 8; i++)
+			coordinates[i] = args.get<GLint>();
+		GLbitfield mask = args.get<GLbitfield>();
+		glBlitFramebuffer(coordinates[0], coordinates[1], coordinates[2], coordinates[3], coordinates[4], coordinates[5],
+			coordinates[6], coordinates[7], mask, args.get<GLenum>());
+		break;
+	}
+
+	// ----- shaders and uniforms
+	case TRACE_CREATE_SHADER:
+	{
+		GLenum type = args.get<GLenum>();
+		state.shaders[args.get<GLuint>()] = glCreateShader(type);
+		break;
+	}
+	case TRACE_DELETE_SHADER:
+	{
+		GLuint traceName = args.get<GLuint>();
+		glDeleteShader(mapName(state.shaders, traceName));
+		state.shaders.erase(traceName);
+		break;
+	}
+	case TRACE_SHADER_SOURCE:
+	{
+		GLuint shader = mapName(state.shaders, args.get<GLuint>());
+		const GLchar* source = (const GLchar*)args.bytes(size);
+		GLint length = (GLint)size;
+		glShaderSource(shader, 1, &source, &length);
+		break;
+	}
+	case TRACE_COMPILE_SHADER: glCompileShader(mapName(state.shaders, args.get<GLuint>())); break;
+	case TRACE_CREATE_PROGRAM: state.programs[args.get<GLuint>()] = glCreateProgram(); break;
+	case TRACE_DELETE_PROGRAM:
+	{
+		GLuint traceName = args.get<GLuint>();
+		glDeleteProgram(mapName(state.programs, traceName));
+		state.programs.erase(traceName);
+		break;
+	}
+	case TRACE_ATTACH_SHADER:
+	{
+		GLuint program = mapName(state.programs, args.get<GLuint>());
+		glAttachShader(program, mapName(state.shaders, args.get<GLuint>()));
+		break;
+	}
+	case TRACE_LINK_PROGRAM: glLinkProgram(mapName(state.programs, args.get<GLuint>())); break;
+	case TRACE_USE_PROGRAM:
+		state.currentProgram = args.get<GLuint>();
+		glUseProgram(mapName(state.programs, state.currentProgram));
+		break;
+	case TRACE_GET_UNIFORM_LOCATION:
+	{
+		GLuint traceProgram = args.get<GLuint>();
+		GLint traceLocation = args.get<GLint>();
+		const unsigned char* name = args.bytes(size);
+		std::string uniform((const char*)name, size);
+		if (traceLocation >= 0)
+			state.locations[((uint64_t)traceProgram << 32) | (uint32_t)traceLocation] = glGetUniformLocation(mapName(state.programs, traceProgram), uniform.c_str());
+		break;
+	}
+	case TRACE_UNIFORM_1I:
+	{
+		GLint location = mapLocation(state, args.get<GLint>());
+		glUniform1i(location, args.get<GLint>());
+		break;
+	}
+	case TRACE_UNIFORM_1UI:
+	{
+		GLint location = mapLocation(state, args.get<GLint>());
+		glUniform1ui(location, args.get<GLuint>());
+		break;
+	}
+	case TRACE_UNIFORM_1F:
+	{
+		GLint location = mapLocation(state, args.get<GLint>());
+		glUniform1f(location, args.get<GLfloat>());
+		break;
+	}
+	case TRACE_UNIFORM_2F:
+	{
+		GLint location = mapLocation(state, args.get<GLint>());
+		GLfloat v0 = args.get<GLfloat>();
+		glUniform2f(location, v0, args.get<GLfloat>());
+		break;
+	}
+	case TRACE_UNIFORM_3F:
+	{
+		GLint location = mapLocation(state, args.get<GLint>());
+		GLfloat v0 = args.get<GLfloat>();
+		GLfloat v1 = args.get<GLfloat>();
+		glUniform3f(location, v0, v1, args.get<GLfloat>());
+		break;
+	}
+	case TRACE_UNIFORM_4F:
+	{
+		GLint location = mapLocation(state, args.get<GLint>());
+		GLfloat v0 = args.get<GLfloat>();
+		GLfloat v1 = args.get<GLfloat>();
+		GLfloat v2 = args.get<GLfloat>();
+		glUniform4f(location, v0, v1, v2, args.get<GLfloat>());
+		break;
+	}
+	case TRACE_UNIFORM_1IV:
+	{
+		GLint location = mapLocation(state, args.get<GLint>());
+		const unsigned char* values = args.bytes(size);
+		glUniform1iv(location, (GLsizei)(size / sizeof(GLint)), (const GLint*)values);
+		break;
+	}
+	case TRACE_UNIFORM_1FV:
+	case TRACE_UNIFORM_2FV:
+	case TRACE_UNIFORM_3FV:
+	case TRACE_UNIFORM_4FV:
+	{
+		GLint location = mapLocation(state, args.get<GLint>());
+		const GLfloat* values = (const GLfloat*)args.bytes(size);
+		GLsizei floats = (GLsizei)(size / sizeof(GLfloat));
+		if (record.call == TRACE_UNIFORM_1FV)
+			glUniform1fv(location, floats, values);
+		else if (record.call == TRACE_UNIFORM_2FV)
+			glUniform2fv(location, floats / 2, values);
+		else if (record.call == TRACE_UNIFORM_3FV)
+			glUniform3fv(location, floats / 3, values);
+		else
+			glUniform4fv(location, floats / 4, values);
+		break;
+	}
+	case TRACE_UNIFORM_MATRIX_3FV:
+	case TRACE_UNIFORM_MATRIX_4FV:
+	{
+		GLint location = mapLocation(state, args.get<GLint>());
+		GLboolean transpose = args.get<GLboolean>();
+		const GLfloat* values = (const GLfloat*)args.bytes(size);
+		GLsizei floats = (GLsizei)(size / sizeof(GLfloat));
+		if (record.call == TRACE_UNIFORM_MATRIX_3FV)
+			glUniformMatrix3fv(location, floats / 9, transpose, values);
+		else
+			glUniformMatrix4fv(location, floats / 16, transpose, values);
+		break;
+	}
+
+	// ----- fixed function state
+	case TRACE_ENABLE: glEnable(args.get<GLenum>()); break;
+	case TRACE_DISABLE: glDisable(args.get<GLenum>()); break;
+	case TRACE_VIEWPORT:
+	case TRACE_SCISSOR:
+	{
+		GLint x = args.get<GLint>();
+		GLint y = args.get<GLint>();
+		GLsizei rectWidth = args.get<GLsizei>();
+		GLsizei rectHeight = args.get<GLsizei>();
+		if (record.call == TRACE_VIEWPORT)
+			glViewport(x, y, rectWidth, rectHeight);
+		else
+			glScissor(x, y, rectWidth, rectHeight);
+		break;
+	}
+	case TRACE_BLEND_FUNC:
+	{
+		GLenum source = args.get<GLenum>();
+		glBlendFunc(source, args.get<GLenum>());
+		break;
+	}
+	case TRACE_BLEND_FUNC_SEPARATE:
+	{
+		GLenum sourceRGB = args.get<GLenum>();
+		GLenum destinationRGB = args.get<GLenum>();
+		GLenum sourceAlpha = args.get<GLenum>();
+		glBlendFuncSeparate(sourceRGB, destinationRGB, sourceAlpha, args.get<GLenum>());
+		break;
+	}
+	case TRACE_BLEND_EQUATION: glBlendEquation(args.get<GLenum>()); break;
+	case TRACE_DEPTH_FUNC: glDepthFunc(args.get<GLenum>()); break;
+	case TRACE_DEPTH_MASK: glDepthMask(args.get<GLboolean>()); break;
+	case TRACE_COLOR_MASK:
+	{
+		GLboolean red = args.get<GLboolean>();
+		GLboolean green = args.get<GLboolean>();
+		GLboolean blue = args.get<GLboolean>();
+		glColorMask(red, green, blue, args.get<GLboolean>());
+		break;
+	}
+	case TRACE_CULL_FACE: glCullFace(args.get<GLenum>()); break;
+	case TRACE_STENCIL_FUNC:
+	{
+		GLenum func = args.get<GLenum>();
+		GLint reference = args.get<GLint>();
+		glStencilFunc(func, reference, args.get<GLuint>());
+		break;
+	}
+	case TRACE_STENCIL_OP:
+	{
+		GLenum fail = args.get<GLenum>();
+		GLenum depthFail = args.get<GLenum>();
+		glStencilOp(fail, depthFail, args.get<GLenum>());
+		break;
+	}
+	case TRACE_STENCIL_MASK: glStencilMask(args.get<GLuint>()); break;
+	case TRACE_CLEAR_COLOR:
+	{
+		GLfloat red = args.get<GLfloat>();
+		GLfloat green = args.get<GLfloat>();
+		GLfloat blue = args.get<GLfloat>();
+		glClearColor(red, green, blue, args.get<GLfloat>());
+		break;
+	}
+	case TRACE_CLEAR_DEPTH: glClearDepth(args.get<GLdouble>()); break;
+	case TRACE_CLEAR_STENCIL: glClearStencil(args.get<GLint>()); break;
+	case TRACE_CLEAR: glClear(args.get<GLbitfield>()); break;
+
+	// ----- draws
+	case TRACE_DRAW_ARRAYS:
+	{
+		GLenum mode = args.get<GLenum>();
+		GLint first = args.get<GLint>();
+		glDrawArrays(mode, first, args.get<GLsizei>());
+		break;
+	}
+	case TRACE_DRAW_ARRAYS_INSTANCED:
+	{
+		GLenum mode = args.get<GLenum>();
+		GLint first = args.get<GLint>();
+		GLsizei count = args.get<GLsizei>();
+		glDrawArraysInstanced(mode, first, count, args.get<GLsizei>());
+		break;
+	}
+	case TRACE_DRAW_ELEMENTS:
+	case TRACE_DRAW_ELEMENTS_BASE_VERTEX:
+	case TRACE_DRAW_ELEMENTS_INSTANCED:
+	case TRACE_DRAW_ELEMENTS_INSTANCED_BASE_VERTEX:
+	{
+		GLenum mode = args.get<GLenum>();
+		GLsizei count = args.get<GLsizei>();
+		GLenum type = args.get<GLenum>();
+		const void* indices = args.pointer();
+		if (record.call == TRACE_DRAW_ELEMENTS)
+			glDrawElements(mode, count, type, indices);
+		else if (record.call == TRACE_DRAW_ELEMENTS_BASE_VERTEX)
+			glDrawElementsBaseVertex(mode, count, type, indices, args.get<GLint>());
+		else if (record.call == TRACE_DRAW_ELEMENTS_INSTANCED)
+			glDrawElementsInstanced(mode, count, type, indices, args.get<GLsizei>());
+		else
+		{
+			GLsizei instances = args.get<GLsizei>();
+			glDrawElementsInstancedBaseVertex(mode, count, type, indices, instances, args.get<GLint>());
+		}
+		break;
+	}
+
+	// ----- queries and sync
+	case TRACE_GEN_QUERIES: replayGen(args, state, state.queries, glGenQueries); break;
+	case TRACE_DELETE_QUERIES: replayDelete(args, state, state.queries, glDeleteQueries); break;
+	case TRACE_BEGIN_QUERY:
+	{
+		GLenum target = args.get<GLenum>();
+		glBeginQuery(target, mapName(state.queries, args.get<GLuint>()));
+		break;
+	}
+	case TRACE_END_QUERY: glEndQuery(args.get<GLenum>()); break;
+	case TRACE_FENCE_SYNC:
+	{
+		GLenum condition = args.get<GLenum>();
+		GLbitfield flags = args.get<GLbitfield>();
+		state.syncs[args.get<uint32_t>()] = glFenceSync(condition, flags);
+		break;
+	}
+	case TRACE_CLIENT_WAIT_SYNC:
+	case TRACE_WAIT_SYNC:
+	{
+		std::unordered_map<uint32_t, GLsync>::iterator sync = state.syncs.find(args.get<uint32_t>());
+		GLbitfield flags = args.get<GLbitfield>();
+		GLuint64 timeout = args.get<GLuint64>();
+		if (sync == state.syncs.end())
+			break;
+		if (record.call == TRACE_CLIENT_WAIT_SYNC)
+			glClientWaitSync(sync->second, flags, timeout);
+		else
+			glWaitSync(sync->second, flags, timeout);
+		break;
+	}
+	case TRACE_DELETE_SYNC:
+	{
+		std::unordered_map<uint32_t, GLsync>::iterator sync = state.syncs.find(args.get<uint32_t>());
+		if (sync != state.syncs.end())
+		{
+			glDeleteSync(sync->second);
+			state.syncs.erase(sync);
+		}
+		break;
+	}
+	case TRACE_FLUSH: glFlush(); break;
+	case TRACE_FINISH: glFinish(); break;
+	}
+}
@@ -0,0 +1,505 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <Shader.h>
+#include <stb_image.h>
+#include <Camera.h>
+#include <GLExtensions.h>
+#include <MeshPool.h>
+#include <GpuCulling.h>
+#include <HiZPyramid.h>
+#include <RenderGraph.h>
+#include <SceneGenerator.h>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// instances are scattered through a cube of this size around the origin
+const float FIELD_SIZE = 400.0f;
+
+// H switches the occlusion test against last frame's depth pyramid
+bool useHiZ = true;
+
+// the scene target and the pyramid follow the framebuffer size
+bool targetsDirty = false;
+
+// timing
+float deltaTime = 0.0f;	// Time between current frame and last frame
+float lastFrame = 0.0f; // Time of last frame
+
+// camera
+Camera camera(glm::vec3(0.0f, 0.0f, 0.0f));
+float lastX = SCR_WIDTH / 2.0f;
+float lastY = SCR_HEIGHT / 2.0f;
+bool firstMouse = true;
+
+int main(int argc, char* argv[])
+{
+	// --count N instances, --headless to render into a hidden window, --frames N to quit after N frames,
+	// --scene <layout> to use a generated scene instead of the random field (see SceneGenerator.h),
+	// --no-hiz starts with frustum culling only (H switches)
+	unsigned int instanceCount = 200000;
+	bool headless = false;
+	int maxFrames = -1;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--no-hiz") == 0)
+			useHiZ = false;
+		else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+			instanceCount = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--headless") == 0)
+			headless = true;
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+			maxFrames = atoi(argv[++i]);
+	}
+	SceneOptions sceneOptions;
+	sceneOptions.count = instanceCount;
+	bool generatedScene = parseSceneOptions(argc, argv, sceneOptions);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- GlAD, GLFW and OpenGL setup
+	// ---------------------------------------------------------
+
+	// initilize the glfw library
+	glfwInit();
+
+	// ----- Setting glfw options
+
+	// compute shaders and multi draw indirect need 4.3, llvmpipe gives us 4.5
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+
+	// we specify that we only want the core features of OpenGL
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	// headless runs still need a context, they just never show the window
+	if (headless)
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	// -----
+
+	// creating our window and configuring it's width, height and name
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	// we tell the glfw that set our window to the current thread's context
+	glfwMakeContextCurrent(window);
+
+	// a callback to resize the window when the user resized the window
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	// for toggles that should only fire once per key press
+	glfwSetKeyCallback(window, key_callback);
+
+	if (!headless)
+	{
+		// a callback to know the mouse position and calculate the direction of the camera
+		glfwSetCursorPosCallback(window, mouse_callback);
+
+		// to get mouse scroller input
+		glfwSetScrollCallback(window, scroll_callback);
+
+		// tell GLFW to capture our mouse
+		glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	}
+
+	// GLAD initilization
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initilize GLAD" << std::endl;
+		return -1;
+	}
+	loadGLExtensions();
+	if (!GLCaps.computeShaders || !GLCaps.multiDrawIndirect)
+	{
+		std::cout << "This demo needs GL 4.3" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	// configure global opengl state
+	// -----------------------------
+	// for z buffer
+	glEnable(GL_DEPTH_TEST);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Meshes & instances
+	// ---------------------------------------------------------
+
+	// loading the shader
+	Shader ourShader("culledInstances.verts", "multiDraw.frags");
+
+	MeshPool meshPool(1 << 16, 1 << 18);
+	std::vector<MeshHandle> meshes;
+	meshes.push_back(meshPool.add(makeCube()));
+	meshes.push_back(meshPool.add(makePrism(6)));
+	meshes.push_back(meshPool.add(makeSphere(8, 16)));
+
+	// a generated scene picks the mesh type of each instance through its texture index
+	std::vector<SceneObject> scene;
+	if (generatedScene)
+	{
+		sceneOptions.textureCount = (unsigned int)meshes.size();
+		scene = generateScene(sceneOptions);
+	}
+
+	// otherwise scatter the instances with a small lcg so every run gets the same scene
+	std::vector<glm::mat4> models(instanceCount);
+	std::vector<InstanceBounds> bounds(instanceCount);
+	unsigned int seed = 12345u;
+	for (unsigned int i = 0; i < instanceCount; i++)
+	{
+		if (generatedScene)
+		{
+			const SceneObject& object = scene[i];
+			models[i] = object.modelMatrix();
+			bounds[i].sphere = glm::vec4(object.position, 0.87f * std::max(object.scale.x, std::max(object.scale.y, object.scale.z)));
+			bounds[i].meshType = object.texture;
+			continue;
+		}
+
+		float r[4];
+		for (int k = 0; k < 4; k++)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			r[k] = (seed >> 8) / 16777216.0f;
+		}
+		glm::vec3 position = (glm::vec3(r[0], r[1], r[2]) - 0.5f) * FIELD_SIZE;
+		glm::mat4 model = glm::mat4(1.0f);
+		model = glm::translate(model, position);
+		model = glm::rotate(model, r[3] * 6.2831853f, glm::vec3(0.5f, 1.0f, 0.0f));
+		models[i] = model;
+
+		// every mesh fits in the unit cube, so this sphere contains it at any rotation
+		bounds[i].sphere = glm::vec4(position, 0.87f);
+		bounds[i].meshType = i % meshes.size();
+	}
+
+	// static per instance data, read by the vertex shader from binding 0
+	unsigned int instanceSSBO;
+	glGenBuffers(1, &instanceSSBO);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceSSBO);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, models.size() * sizeof(glm::mat4), models.data(), GL_STATIC_DRAW);
+
+	GpuCuller culler;
+	culler.setInstances(bounds, meshes);
+	culler.bindVisibleAttribute(meshPool.VAO, 3);
+	std::cout << instanceCount << " instances, " << meshes.size() << " mesh types" << std::endl;
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Texture
+	// ---------------------------------------------------------
+
+	unsigned int texture1;
+	glGenTextures(1, &texture1);
+	glBindTexture(GL_TEXTURE_2D, texture1);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int width1, height1, nrChannels1;
+	unsigned char* data1 = stbi_load("container.jpg", &width1, &height1, &nrChannels1, 0);
+	if (data1)
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width1, height1, 0, GL_RGB, GL_UNSIGNED_BYTE, data1);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else
+	{
+		std::cout << "Failed to load texture1" << std::endl;
+	}
+	stbi_image_free(data1);
+
+	ourShader.use(); // don't forget to activate the shader before setting uniforms!
+	ourShader.setInt("texture1", 0);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- our render loop (smth like update in unity!)
+	// ---------------------------------------------------------
+
+	glm::mat4 view = glm::mat4(1.0f);
+	glm::mat4 projection = glm::mat4(1.0f);
+
+	// the scene goes into its own target so its depth can be read back as a texture, the color is blitted to the screen
+	int framebufferWidth, framebufferHeight;
+	glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+	unsigned int sceneFBO = 0, sceneColor = 0, sceneDepth = 0;
+	HiZPyramid hiZ;
+	auto createTargets = [&]() {
+		glGenFramebuffers(1, &sceneFBO);
+		glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+		glGenRenderbuffers(1, &sceneColor);
+		glBindRenderbuffer(GL_RENDERBUFFER, sceneColor);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, framebufferWidth, framebufferHeight);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, sceneColor);
+		glGenTextures(1, &sceneDepth);
+		glBindTexture(GL_TEXTURE_2D, sceneDepth);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, framebufferWidth, framebufferHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, sceneDepth, 0);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			std::cout << "ERROR::GPU_CULLING::FRAMEBUFFER_NOT_COMPLETE" << std::endl;
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		hiZ.resize(framebufferWidth, framebufferHeight);
+	};
+	auto destroyTargets = [&]() {
+		glDeleteFramebuffers(1, &sceneFBO);
+		glDeleteRenderbuffers(1, &sceneColor);
+		glDeleteTextures(1, &sceneDepth);
+	};
+	createTargets();
+
+	// the pyramid always comes from the frame before, there is none for the first one
+	bool hiZValid = false;
+	glm::mat4 hiZViewProjection = glm::mat4(1.0f);
+
+	// gpu time of the cull pass and of building the pyramid
+	unsigned int cullQuery, hiZQuery;
+	glGenQueries(1, &cullQuery);
+	glGenQueries(1, &hiZQuery);
+
+	// the passes of a frame and what they read and write, printed when the schedule changes. there are no
+	// transient targets here, the pool stays empty
+	RenderTargetPool targetPool;
+	RenderGraph graph(targetPool);
+	std::string lastSchedule;
+
+	double statsStart = glfwGetTime();
+	unsigned int statsFrames = 0;
+	int frame = 0;
+
+	while (!glfwWindowShouldClose(window) && (maxFrames < 0 || frame < maxFrames))
+	{
+		// ---- Calculating deltaTime
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// ---- input handler
+		processInput(window);
+
+		// without a mouse the camera just turns around so the visible set keeps changing
+		if (headless)
+			camera.ProcessMouseMovement(20.0f, 0.0f, true);
+
+		if (targetsDirty)
+		{
+			glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+			destroyTargets();
+			createTargets();
+			hiZValid = false;
+			targetsDirty = false;
+		}
+
+		view = camera.GetViewMatrix();
+		projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, FIELD_SIZE);
+
+		// ---- the frame as a render graph (see RenderGraph.h). the compute passes write with storage and image
+		// stores, the graph puts the barriers in front of whatever reads their results, in this frame or the next
+		graph.reset();
+		int commands = graph.importBuffer("draw commands", culler.commandBuffer);
+		int visible = graph.importBuffer("visible instances", culler.visibleBuffer);
+		int stats = graph.importBuffer("cull stats", culler.statsBuffer);
+		int pyramid = graph.importTarget("hi-z", hiZ.texture, 0, hiZ.width, hiZ.height, GL_R32F);
+		int scene = graph.importTarget("scene", sceneDepth, sceneFBO, framebufferWidth, framebufferHeight, GL_DEPTH_COMPONENT32F);
+		int screen = graph.importTarget("screen", 0, 0, framebufferWidth, framebufferHeight);
+
+		// ---- cull on the gpu, nothing per instance happens on the cpu
+		bool cullWithHiZ = useHiZ && hiZValid;
+		RenderGraph::PassBuilder cullPass = graph.addPass("cull", [&]() {
+			if (cullWithHiZ)
+				culler.setHiZ(hiZ.texture, hiZ.width, hiZ.height, hiZ.mips, hiZViewProjection);
+			else
+				culler.disableHiZ();
+			glBeginQuery(GL_TIME_ELAPSED, cullQuery);
+			culler.cull(projection * view);
+			glEndQuery(GL_TIME_ELAPSED);
+		});
+		if (cullWithHiZ)
+			cullPass.read(pyramid, ACCESS_TEXTURE);
+		commands = cullPass.write(commands, ACCESS_BUFFER_TRANSFER | ACCESS_STORAGE_BUFFER);
+		visible = cullPass.write(visible, ACCESS_STORAGE_BUFFER);
+		stats = cullPass.write(stats, ACCESS_BUFFER_TRANSFER | ACCESS_STORAGE_BUFFER);
+
+		// ----- Rendering stuff
+		RenderGraph::PassBuilder drawPass = graph.addPass("draw", [&]() {
+			glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+			glViewport(0, 0, framebufferWidth, framebufferHeight);
+
+			// seting the clear color
+			glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+			// clear the window color buffer bit and z buffer bit
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, texture1);
+
+			ourShader.use();
+			ourShader.setMat4("view", view);
+			ourShader.setMat4("projection", projection);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceSSBO);
+
+			glBindVertexArray(meshPool.VAO);
+			culler.draw();
+		});
+		drawPass.read(commands, ACCESS_INDIRECT).read(visible, ACCESS_VERTEX);
+		scene = drawPass.write(scene, ACCESS_RENDER_TARGET);
+
+		// ---- next frame's pyramid out of this frame's depth. nothing in this frame reads it, so it's only
+		// an output with hi-z on and culled otherwise
+		RenderGraph::PassBuilder hiZPass = graph.addPass("hi-z build", [&]() {
+			glBeginQuery(GL_TIME_ELAPSED, hiZQuery);
+			hiZ.build(sceneDepth);
+			hiZViewProjection = projection * view;
+			glEndQuery(GL_TIME_ELAPSED);
+		});
+		hiZPass.read(scene, ACCESS_TEXTURE);
+		pyramid = hiZPass.write(pyramid, ACCESS_IMAGE);
+		if (useHiZ)
+			graph.output(pyramid);
+
+		RenderGraph::PassBuilder blitPass = graph.addPass("blit", [&]() {
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneFBO);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+			glBlitFramebuffer(0, 0, framebufferWidth, framebufferHeight, 0, 0, framebufferWidth, framebufferHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		});
+		blitPass.read(scene, ACCESS_RENDER_TARGET);
+		screen = blitPass.write(screen, ACCESS_RENDER_TARGET);
+		graph.output(screen);
+
+		// ---- once a second the culling results back to the cpu. all of these wait for the gpu, which is fine then
+		bool statsFrame = glfwGetTime() - statsStart >= 1.0 || frame + 1 == maxFrames;
+		unsigned int visibleCount = 0;
+		CullStats cullStats = { 0, 0 };
+		if (statsFrame)
+		{
+			RenderGraph::PassBuilder readbackPass = graph.addPass("stats readback", [&]() {
+				visibleCount = culler.readVisibleCount();
+				cullStats = culler.readStats();
+			});
+			readbackPass.read(commands, ACCESS_BUFFER_TRANSFER).read(stats, ACCESS_BUFFER_TRANSFER).sideEffect();
+		}
+
+		graph.compile();
+		graph.execute();
+		hiZValid = useHiZ;
+		if (graph.scheduleString() != lastSchedule)
+		{
+			lastSchedule = graph.scheduleString();
+			std::cout << "render graph: " << lastSchedule << std::endl;
+		}
+
+		frame++;
+		statsFrames++;
+		if (statsFrame)
+		{
+			GLuint64 cullNs = 0, hiZNs = 0;
+			glGetQueryObjectui64v(cullQuery, GL_QUERY_RESULT, &cullNs);
+			if (useHiZ)
+				glGetQueryObjectui64v(hiZQuery, GL_QUERY_RESULT, &hiZNs);
+			std::cout << "visible " << visibleCount << " / " << culler.totalCount()
+				<< " (frustum rejected " << cullStats.frustumCulled << ", hi-z rejected " << cullStats.occlusionCulled
+				<< "), cull pass " << cullNs / 1.0e6 << " ms";
+			if (useHiZ)
+				std::cout << ", hi-z build " << hiZNs / 1.0e6 << " ms";
+			std::cout << ", " << graph.barriers << " barriers, " << statsFrames << " fps" << std::endl;
+			statsStart = glfwGetTime();
+			statsFrames = 0;
+		}
+
+		// double buffer mechanism to render things smoothly without user seeing the acutal drawings
+		glfwSwapBuffers(window);
+		// checks if any events are created
+		glfwPollEvents();
+	}
+
+	// optional: de-allocate all resources once they've outlived their purpose:
+	// ------------------------------------------------------------------------
+	culler.destroy();
+	hiZ.destroy();
+	destroyTargets();
+	meshPool.destroy();
+	glDeleteBuffers(1, &instanceSSBO);
+	glDeleteQueries(1, &cullQuery);
+	glDeleteQueries(1, &hiZQuery);
+
+	// glfw: terminate, clearing all previously allocated GLFW resources.
+	// ------------------------------------------------------------------
+	glfwTerminate();
+
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+	targetsDirty = true;
+}
+
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(RIGHT, deltaTime);
+}
+
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (key == GLFW_KEY_H && action == GLFW_PRESS)
+	{
+		useHiZ = !useHiZ;
+		std::cout << "hi-z occlusion culling " << (useHiZ ? "on" : "off") << std::endl;
+	}
+}
+
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+	if (firstMouse) // initially set to true
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	float xoffset = xpos - lastX;
+	float yoffset = lastY - ypos; // reversed since y-coordinates range from bottom to top
+	lastX = xpos;
+	lastY = ypos;
+
+	camera.ProcessMouseMovement(xoffset, yoffset, true);
+}
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.ProcessMouseScroll(yoffset);
+}
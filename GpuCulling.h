@@ -0,0 +1,200 @@
+#pragma once
+#ifndef GPU_CULLING_H
+#define GPU_CULLING_H
+
+#include <GLExtensions.h>
+#include <ComputeShader.h>
+#include <Frustum.h>
+#include <MeshPool.h>
+
+#include <iostream>
+#include <vector>
+
+// how many instances the last cull() threw out, same layout as StatsBuffer in cull.comp
+struct CullStats
+{
+	unsigned int frustumCulled;
+	unsigned int occlusionCulled;
+};
+
+// one entry per instance, same layout as Bounds in cull.comp
+struct InstanceBounds
+{
+	glm::vec4 sphere; // xyz world space center, w radius
+	unsigned int meshType;
+	unsigned int pad[3];
+};
+
+// Frustum (and optionally Hi-Z occlusion) culling in a compute shader. Every instance is tested in
+// parallel and the visible ones are compacted per mesh type into one indirect command each, so the
+// cpu never touches individual instances after setInstances().
+//
+// the draw reads the compacted instance indices as a per instance vertex attribute (see bindVisibleAttribute),
+// which uses the command's baseInstance without needing ARB_shader_draw_parameters.
+class GpuCuller
+{
+public:
+	unsigned int boundsBuffer = 0;   // InstanceBounds[], binding 1
+	unsigned int commandBuffer = 0;  // DrawElementsIndirectCommand per mesh type, binding 2
+	unsigned int visibleBuffer = 0;  // uint per visible instance, binding 3
+	unsigned int statsBuffer = 0;    // CullStats, binding 4
+
+	GpuCuller(const char* computePath = "cull.comp")
+		: cullShader(computePath)
+	{
+		glGenBuffers(1, &boundsBuffer);
+		glGenBuffers(1, &commandBuffer);
+		glGenBuffers(1, &visibleBuffer);
+		glGenBuffers(1, &statsBuffer);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, statsBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(CullStats), NULL, GL_DYNAMIC_READ);
+	}
+
+	// uploads the instances once. instances of mesh type t get drawn with meshes[t]
+	void setInstances(const std::vector<InstanceBounds>& instances, const std::vector<MeshHandle>& meshes)
+	{
+		instanceCount = (unsigned int)instances.size();
+
+		// reserve a range of the visible buffer big enough for every instance of each type
+		std::vector<unsigned int> perType(meshes.size(), 0);
+		for (unsigned int i = 0; i < instanceCount; i++)
+			perType[instances[i].meshType]++;
+
+		commandTemplate.clear();
+		unsigned int first = 0;
+		for (unsigned int t = 0; t < meshes.size(); t++)
+		{
+			DrawElementsIndirectCommand cmd;
+			cmd.count = meshes[t].indexCount;
+			cmd.instanceCount = 0; // filled by the compute shader
+			cmd.firstIndex = meshes[t].firstIndex;
+			cmd.baseVertex = meshes[t].baseVertex;
+			cmd.baseInstance = first;
+			commandTemplate.push_back(cmd);
+			first += perType[t];
+		}
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, boundsBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, instances.size() * sizeof(InstanceBounds), instances.data(), GL_STATIC_DRAW);
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, commandTemplate.size() * sizeof(DrawElementsIndirectCommand), NULL, GL_DYNAMIC_DRAW);
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, (instanceCount > 0 ? instanceCount : 1) * sizeof(unsigned int), NULL, GL_DYNAMIC_COPY);
+	}
+
+	// points a per instance uint attribute of the given VAO at the compacted visible indices
+	void bindVisibleAttribute(unsigned int VAO, unsigned int location)
+	{
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, visibleBuffer);
+		glVertexAttribIPointer(location, 1, GL_UNSIGNED_INT, sizeof(unsigned int), (void*)0);
+		glVertexAttribDivisor(location, 1);
+		glEnableVertexAttribArray(location);
+		glBindVertexArray(0);
+	}
+
+	// hi-z is a max depth pyramid (0 near, 1 far) of the given size (see HiZPyramid.h), built from an earlier
+	// frame rendered with viewProjection
+	void setHiZ(unsigned int texture, int width, int height, int mips, const glm::mat4& viewProjection)
+	{
+		hiZTexture = texture;
+		hiZWidth = width;
+		hiZHeight = height;
+		hiZMips = mips;
+		hiZViewProjection = viewProjection;
+	}
+
+	void disableHiZ()
+	{
+		hiZTexture = 0;
+	}
+
+	// fills the command buffer for this frame. the results are written by a compute shader, the indirect draw
+	// and the visible attribute need a glMemoryBarrier for that first. GpuCulling.cpp leaves that to its
+	// render graph, the readbacks below put in their own
+	void cull(const glm::mat4& viewProjection)
+	{
+		// start every command over at zero instances
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, commandTemplate.size() * sizeof(DrawElementsIndirectCommand), commandTemplate.data());
+		CullStats zero = { 0, 0 };
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, statsBuffer);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(CullStats), &zero);
+
+		Frustum frustum(viewProjection);
+		cullShader.use();
+		cullShader.setUint("instanceCount", instanceCount);
+		glUniform4fv(glGetUniformLocation(cullShader.ID, "frustumPlanes"), 6, &frustum.planes[0][0]);
+		cullShader.setBool("useHiZ", hiZTexture != 0);
+		if (hiZTexture != 0)
+		{
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, hiZTexture);
+			cullShader.setInt("hiZ", 0);
+			cullShader.setMat4("hiZViewProjection", hiZViewProjection);
+			cullShader.setVec2("hiZSize", (float)hiZWidth, (float)hiZHeight);
+			cullShader.setInt("hiZMips", hiZMips);
+		}
+
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, boundsBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, commandBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, visibleBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, statsBuffer);
+		glDispatchCompute((instanceCount + 63) / 64, 1, 1);
+	}
+
+	// one multi draw for every mesh type. the MeshPool VAO and the program have to be bound already
+	void draw() const
+	{
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, (GLsizei)commandTemplate.size(), 0);
+	}
+
+	// reads the instance counts back. stalls until the culling is done, so only use it for stats
+	unsigned int readVisibleCount() const
+	{
+		std::vector<DrawElementsIndirectCommand> commands(commandTemplate.size());
+		// the counts are atomics of the cull shader
+		glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+		glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+		unsigned int visible = 0;
+		for (unsigned int i = 0; i < commands.size(); i++)
+			visible += commands[i].instanceCount;
+		return visible;
+	}
+
+	// stalls like readVisibleCount()
+	CullStats readStats() const
+	{
+		CullStats stats = { 0, 0 };
+		glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, statsBuffer);
+		glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(CullStats), &stats);
+		return stats;
+	}
+
+	unsigned int totalCount() const { return instanceCount; }
+
+	void destroy()
+	{
+		glDeleteBuffers(1, &boundsBuffer);
+		glDeleteBuffers(1, &commandBuffer);
+		glDeleteBuffers(1, &visibleBuffer);
+		glDeleteBuffers(1, &statsBuffer);
+		glDeleteProgram(cullShader.ID);
+	}
+
+private:
+	ComputeShader cullShader;
+	unsigned int instanceCount = 0;
+	std::vector<DrawElementsIndirectCommand> commandTemplate;
+
+	unsigned int hiZTexture = 0;
+	int hiZWidth = 0, hiZHeight = 0, hiZMips = 0;
+	glm::mat4 hiZViewProjection = glm::mat4(1.0f);
+};
+
+#endif // !GPU_CULLING_H
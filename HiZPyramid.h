@@ -0,0 +1,96 @@
+#pragma once
+#ifndef HI_Z_PYRAMID_H
+#define HI_Z_PYRAMID_H
+
+#include <GLExtensions.h>
+#include <ComputeShader.h>
+
+#include <algorithm>
+
+// Max depth pyramid for occlusion culling (see GpuCuller::setHiZ). level 0 is a copy of a depth texture,
+// every level below holds the farthest depth of the texels it covers, so anything nearer than that
+// value over a whole screen box is in front of something already drawn.
+//
+// built with hiZ.comp, one dispatch per level. needs GL 4.3
+class HiZPyramid
+{
+public:
+	unsigned int texture = 0;  // R32F with every mip level
+	int width = 0, height = 0, mips = 0;
+
+	HiZPyramid(const char* computePath = "hiZ.comp")
+		: buildShader(computePath)
+	{
+	}
+
+	// (re)allocates the levels for a depth buffer of this size
+	void resize(int depthWidth, int depthHeight)
+	{
+		if (texture != 0)
+			glDeleteTextures(1, &texture);
+		width = std::max(1, depthWidth);
+		height = std::max(1, depthHeight);
+		mips = 1;
+		while ((std::max(width, height) >> mips) > 0)
+			mips++;
+
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		for (int level = 0; level < mips; level++)
+			glTexImage2D(GL_TEXTURE_2D, level, GL_R32F, levelSize(width, level), levelSize(height, level), 0, GL_RED, GL_FLOAT, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mips - 1);
+		// the culling picks the level itself and must never blend depths
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	// fills every level from depthTexture, which has to be the size given to resize(). the levels are image
+	// stores, the barrier at the end makes them visible to the culling's texture fetches
+	void build(unsigned int depthTexture)
+	{
+		buildShader.use();
+		buildShader.setInt("depth", 0);
+
+		// level 0 straight from the depth buffer
+		buildShader.setBool("copyDepth", true);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, depthTexture);
+		glBindImageTexture(1, texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		dispatch(width, height);
+
+		buildShader.setBool("copyDepth", false);
+		for (int level = 1; level < mips; level++)
+		{
+			// the level before has to be written before it's read
+			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+			glBindImageTexture(0, texture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+			glBindImageTexture(1, texture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+			dispatch(levelSize(width, level), levelSize(height, level));
+		}
+
+		// the culling samples it as a texture
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+	}
+
+	void destroy()
+	{
+		glDeleteTextures(1, &texture);
+		glDeleteProgram(buildShader.ID);
+		texture = 0;
+	}
+
+private:
+	ComputeShader buildShader;
+
+	static int levelSize(int size, int level) { return std::max(1, size >> level); }
+
+	void dispatch(int levelWidth, int levelHeight)
+	{
+		glDispatchCompute((levelWidth + 7) / 8, (levelHeight + 7) / 8, 1);
+	}
+};
+
+#endif // !HI_Z_PYRAMID_H
@@ -0,0 +1,86 @@
+#pragma once
+#ifndef IMAGE_DIFF_H
+#define IMAGE_DIFF_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMAGE_DIFF_SSE2 1
+#include <emmintrin.h>
+#endif
+
+struct ImageDiffResult
+{
+	size_t pixels = 0;
+	size_t differingPixels = 0;   // pixels where some channel differs by more than the tolerance
+	unsigned int maxDifference = 0;   // largest difference of a single channel
+	double meanDifference = 0.0;  // average over every channel of every pixel
+
+	double differingFraction() const { return pixels > 0 ? (double)differingPixels / pixels : 0.0; }
+};
+
+// Compares two RGBA8 images of the same size. a pixel only counts as different when one of its channels
+// is off by more than tolerance, so tiny rasterization and filtering differences between drivers pass
+// while real changes don't. SSE2 does 4 pixels at a time, anything else takes the scalar loop
+inline ImageDiffResult compareImages(const unsigned char* a, const unsigned char* b, size_t pixelCount, unsigned char tolerance)
+{
+	ImageDiffResult result;
+	result.pixels = pixelCount;
+	uint64_t sum = 0;
+	size_t i = 0;
+
+#ifdef IMAGE_DIFF_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i limit = _mm_set1_epi8((char)tolerance);
+	__m128i maxima = zero;
+	__m128i sums = zero;
+	for (; i + 4 <= pixelCount; i += 4)
+	{
+		__m128i va = _mm_loadu_si128((const __m128i*)(a + i * 4));
+		__m128i vb = _mm_loadu_si128((const __m128i*)(b + i * 4));
+		// |a - b| for unsigned bytes: one of the two saturated subtractions is zero
+		__m128i difference = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+		maxima = _mm_max_epu8(maxima, difference);
+		sums = _mm_add_epi64(sums, _mm_sad_epu8(difference, zero));
+
+		// bytes within the tolerance become 0xFF, a pixel passes when all four of its bytes do
+		int within = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(difference, limit), zero));
+		for (int p = 0; p < 4; p++)
+			if (((within >> (p * 4)) & 0xF) != 0xF)
+				result.differingPixels++;
+	}
+
+	unsigned char maximaBytes[16];
+	_mm_storeu_si128((__m128i*)maximaBytes, maxima);
+	for (int k = 0; k < 16; k++)
+		if (maximaBytes[k] > result.maxDifference)
+			result.maxDifference = maximaBytes[k];
+	uint64_t sumParts[2];
+	_mm_storeu_si128((__m128i*)sumParts, sums);
+	sum = sumParts[0] + sumParts[1];
+#endif
+
+	// scalar: everything without SSE2, and the last few pixels with it
+	for (; i < pixelCount; i++)
+	{
+		bool differs = false;
+		for (int c = 0; c < 4; c++)
+		{
+			int da = a[i * 4 + c], db = b[i * 4 + c];
+			unsigned int difference = (unsigned int)(da > db ? da - db : db - da);
+			sum += difference;
+			if (difference > result.maxDifference)
+				result.maxDifference = difference;
+			if (difference > tolerance)
+				differs = true;
+		}
+		if (differs)
+			result.differingPixels++;
+	}
+
+	result.meanDifference = pixelCount > 0 ? (double)sum / (pixelCount * 4.0) : 0.0;
+	return result;
+}
+
+#endif // !IMAGE_DIFF_H
@@ -0,0 +1,158 @@
+#pragma once
+#ifndef IMAGE_WRITER_H
+#define IMAGE_WRITER_H
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+// Writes 8 bit images without any library. the PNGs use stored (uncompressed) deflate blocks: files are
+// about as big as the raw pixels but writing them costs little more than the copy, and stb_image or any
+// viewer reads them. rows are top to bottom, 1 (gray), 3 (RGB) or 4 (RGBA) channels
+
+namespace ImageWriterDetail
+{
+	inline uint32_t crc32(const unsigned char* data, size_t size, uint32_t crc = 0)
+	{
+		// built once, thread safe since C++11. the FrameCapture worker writes with it
+		static const std::array<uint32_t, 256> table = []() {
+			std::array<uint32_t, 256> t;
+			for (uint32_t n = 0; n < 256; n++)
+			{
+				uint32_t c = n;
+				for (int k = 0; k < 8; k++)
+					c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+				t[n] = c;
+			}
+			return t;
+		}();
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++)
+			crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		return ~crc;
+	}
+
+	inline void putBigEndian(std::vector<unsigned char>& out, uint32_t value)
+	{
+		out.push_back((unsigned char)(value >> 24));
+		out.push_back((unsigned char)(value >> 16));
+		out.push_back((unsigned char)(value >> 8));
+		out.push_back((unsigned char)value);
+	}
+
+	inline void putChunk(std::vector<unsigned char>& out, const char* type, const std::vector<unsigned char>& data)
+	{
+		putBigEndian(out, (uint32_t)data.size());
+		size_t start = out.size();
+		out.insert(out.end(), type, type + 4);
+		out.insert(out.end(), data.begin(), data.end());
+		putBigEndian(out, crc32(&out[start], out.size() - start));
+	}
+}
+
+// encodes into memory, false for a channel count PNG can't store this way
+inline bool encodePng(int width, int height, int channels, const unsigned char* pixels, std::vector<unsigned char>& out)
+{
+	using namespace ImageWriterDetail;
+	if (channels != 1 && channels != 3 && channels != 4)
+		return false;
+
+	const unsigned char signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	out.assign(signature, signature + 8);
+
+	std::vector<unsigned char> header;
+	putBigEndian(header, (uint32_t)width);
+	putBigEndian(header, (uint32_t)height);
+	header.push_back(8);                                                       // bit depth
+	header.push_back((unsigned char)(channels == 1 ? 0 : (channels == 3 ? 2 : 6)));  // color type
+	header.push_back(0);                                                       // compression
+	header.push_back(0);                                                       // filter
+	header.push_back(0);                                                       // interlace
+	putChunk(out, "IHDR", header);
+
+	// zlib stream of stored blocks, every row starts with filter type 0
+	size_t rowSize = (size_t)width * channels;
+	size_t rawSize = (rowSize + 1) * height;
+	std::vector<unsigned char> raw;
+	raw.reserve(rawSize);
+	for (int y = 0; y < height; y++)
+	{
+		raw.push_back(0);
+		raw.insert(raw.end(), pixels + y * rowSize, pixels + (y + 1) * rowSize);
+	}
+
+	std::vector<unsigned char> zlib;
+	zlib.reserve(rawSize + rawSize / 65535 * 5 + 16);
+	zlib.push_back(0x78);
+	zlib.push_back(0x01);
+	size_t offset = 0;
+	do
+	{
+		size_t blockSize = rawSize - offset < 65535 ? rawSize - offset : 65535;
+		bool last = offset + blockSize == rawSize;
+		zlib.push_back(last ? 1 : 0);
+		zlib.push_back((unsigned char)(blockSize & 0xFF));
+		zlib.push_back((unsigned char)(blockSize >> 8));
+		zlib.push_back((unsigned char)(~blockSize & 0xFF));
+		zlib.push_back((unsigned char)((~blockSize >> 8) & 0xFF));
+		zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+		offset += blockSize;
+	} while (offset < rawSize);
+
+	// adler32 of the uncompressed data, 5552 is the most bytes that can be summed before the modulo
+	uint32_t a = 1, b = 0;
+	for (size_t i = 0; i < rawSize;)
+	{
+		size_t end = i + 5552 < rawSize ? i + 5552 : rawSize;
+		for (; i < end; i++)
+		{
+			a += raw[i];
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+	}
+	putBigEndian(zlib, (b << 16) | a);
+
+	putChunk(out, "IDAT", zlib);
+	putChunk(out, "IEND", std::vector<unsigned char>());
+	return true;
+}
+
+inline bool writePng(const char* path, int width, int height, int channels, const unsigned char* pixels)
+{
+	std::vector<unsigned char> encoded;
+	if (!encodePng(width, height, channels, pixels, encoded))
+	{
+		std::cout << "ERROR::IMAGE_WRITER::UNSUPPORTED_CHANNEL_COUNT " << channels << std::endl;
+		return false;
+	}
+	FILE* file = fopen(path, "wb");
+	if (!file)
+	{
+		std::cout << "ERROR::IMAGE_WRITER::FILE_NOT_SUCCESFULLY_WRITTEN " << path << std::endl;
+		return false;
+	}
+	bool written = fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size();
+	fclose(file);
+	return written;
+}
+
+// just the pixels, no header. the size has to come from somewhere else (the capture puts it in the file name)
+inline bool writeRaw(const char* path, int width, int height, int channels, const unsigned char* pixels)
+{
+	FILE* file = fopen(path, "wb");
+	if (!file)
+	{
+		std::cout << "ERROR::IMAGE_WRITER::FILE_NOT_SUCCESFULLY_WRITTEN " << path << std::endl;
+		return false;
+	}
+	size_t size = (size_t)width * height * channels;
+	bool written = fwrite(pixels, 1, size, file) == size;
+	fclose(file);
+	return written;
+}
+
+#endif // !IMAGE_WRITER_H
@@ -0,0 +1,402 @@
+#pragma once
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// how many jobs of a group haven't finished yet. wait() on it, or pass it as the dependency of later jobs
+struct JobCounter
+{
+	std::atomic<int> value;
+
+	JobCounter() : value(0) {}
+	bool done() const { return value.load(std::memory_order_acquire) == 0; }
+};
+
+struct Job
+{
+	void (*function)(const Job& job);
+	void* data;
+	unsigned int first, last;        // the range for parallelFor, free to use for anything else
+	JobCounter* counter;
+	const JobCounter* dependency;    // the job only starts once this reaches zero
+};
+
+// ---------------------------------------------------------
+// --------------------------------------------------------- Chase-Lev deque
+// ---------------------------------------------------------
+
+// work stealing deque of a fixed size (Chase & Lev 2005, memory orders after Le et al. 2013).
+// the owning thread pushes and pops at the bottom, any other thread steals from the top, no locks
+class JobDeque
+{
+public:
+	static const int64_t CAPACITY = 4096;
+
+	JobDeque() : top(0), bottom(0)
+	{
+		for (int64_t i = 0; i < CAPACITY; i++)
+			jobs[i].store(nullptr, std::memory_order_relaxed);
+	}
+
+	// owner only. false when it's full, the caller runs the job itself then
+	bool push(Job* job)
+	{
+		int64_t b = bottom.load(std::memory_order_relaxed);
+		int64_t t = top.load(std::memory_order_acquire);
+		if (b - t >= CAPACITY)
+			return false;
+		jobs[b & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	// owner only, newest job first
+	Job* pop()
+	{
+		int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_relaxed);
+		if (t > b)
+		{
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Job* job = jobs[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+		if (t == b)
+		{
+			// the last job, a thief might be taking it at the same time
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				job = nullptr;
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	// any thread, oldest job first. nullptr when it's empty or another thread got there first
+	Job* steal()
+	{
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t b = bottom.load(std::memory_order_acquire);
+		if (t >= b)
+			return nullptr;
+
+		Job* job = jobs[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr;
+		return job;
+	}
+
+private:
+	std::atomic<int64_t> top;
+	char padding[64];    // thieves hammer top, the owner bottom, keep them off the same cache line
+	std::atomic<int64_t> bottom;
+	std::atomic<Job*> jobs[CAPACITY];
+};
+
+// ---------------------------------------------------------
+// --------------------------------------------------------- the scheduler
+// ---------------------------------------------------------
+
+// Work stealing job system. the thread that creates it is worker 0 and only runs jobs while it waits,
+// the others run jobs all the time and sleep when there's nothing left anywhere.
+//
+// run(), wait() and parallelFor() can be called from the creating thread or from inside a job.
+// every thread can have at most MAX_JOBS unfinished jobs it started, the job memory is a ring that gets reused
+class JobSystem
+{
+public:
+	static const unsigned int MAX_JOBS = 4096;
+
+	// 0 threads = one per core
+	JobSystem(unsigned int threadCount = 0) : running(true), queuedJobs(0), sleeping(0), deferredCount(0)
+	{
+		if (threadCount == 0)
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+		for (unsigned int i = 0; i < threadCount; i++)
+			threads.push_back(std::unique_ptr<ThreadState>(new ThreadState()));
+
+		currentThread() = ThreadBinding(this, 0);
+		for (unsigned int i = 1; i < threadCount; i++)
+			workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+	}
+
+	~JobSystem()
+	{
+		shutdown();
+	}
+
+	// stops the workers, anything still queued is dropped so wait() on it first
+	void shutdown()
+	{
+		if (!running.load())
+			return;
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+			running.store(false);
+		}
+		wakeCondition.notify_all();
+		for (size_t i = 0; i < workers.size(); i++)
+			workers[i].join();
+		workers.clear();
+		if (currentThread().system == this)
+			currentThread() = ThreadBinding(nullptr, 0);
+	}
+
+	unsigned int threadCount() const { return (unsigned int)threads.size(); }
+
+	// 0 .. threadCount() - 1 for the thread calling it, for per-thread data like FrameArena's sub-arenas
+	unsigned int threadIndex() const
+	{
+		return currentThread().system == this ? currentThread().index : 0;
+	}
+
+	// queues function(job) and adds one to counter, which goes back down when the job is done
+	void run(JobCounter& counter, void (*function)(const Job& job), void* data = nullptr,
+		unsigned int first = 0, unsigned int last = 0, const JobCounter* dependency = nullptr)
+	{
+		ThreadState& state = *threads[threadIndex()];
+		Job* job = &state.jobs[state.nextJob++ & (MAX_JOBS - 1)];
+		job->function = function;
+		job->data = data;
+		job->first = first;
+		job->last = last;
+		job->counter = &counter;
+		job->dependency = dependency;
+		counter.value.fetch_add(1);
+
+		if (dependency && !dependency->done())
+		{
+			// parked until the dependency finishes, see execute(). it can hit zero while we get here,
+			// deferredCount and the counter are both seq_cst so either we see it or finish() sees us. that
+			// takes a seq_cst load here too, the acquire one in done() could miss it
+			std::lock_guard<std::mutex> lock(deferredMutex);
+			deferredCount.fetch_add(1);
+			if (dependency->value.load() != 0)
+			{
+				deferred.push_back(job);
+				return;
+			}
+			deferredCount.fetch_sub(1);
+		}
+		submit(job);
+	}
+
+	// runs other jobs until the counter is zero
+	void wait(const JobCounter& counter)
+	{
+		unsigned int index = threadIndex();
+		while (!counter.done())
+		{
+			if (!runOne(index))
+				std::this_thread::yield();
+		}
+	}
+
+	// fn(first, last) over [0, count) in ranges of grain items, returns when all of them are done
+	template <typename Function>
+	void parallelFor(unsigned int count, unsigned int grain, const Function& fn)
+	{
+		if (count == 0)
+			return;
+		grain = std::max(grain, 1u);
+		// stay well inside the job ring, bigger ranges are cheaper than running out of jobs.
+		// grows in multiples of the asked grain so alignment the caller picked is kept
+		if (count / grain > MAX_JOBS / 4)
+			grain *= count / grain / (MAX_JOBS / 4) + 1;
+		if (grain >= count || threads.size() == 1)
+		{
+			fn(0u, count);
+			return;
+		}
+
+		JobCounter counter;
+		for (unsigned int first = 0; first < count; first += grain)
+			run(counter, &invokeRange<Function>, (void*)&fn, first, std::min(count, first + grain));
+		wait(counter);
+	}
+
+	// ---- stats, for the benchmark
+	uint64_t jobsExecuted() const
+	{
+		uint64_t total = 0;
+		for (size_t i = 0; i < threads.size(); i++)
+			total += threads[i]->executed.load(std::memory_order_relaxed);
+		return total;
+	}
+
+	uint64_t jobsStolen() const
+	{
+		uint64_t total = 0;
+		for (size_t i = 0; i < threads.size(); i++)
+			total += threads[i]->stolen.load(std::memory_order_relaxed);
+		return total;
+	}
+
+	void resetStats()
+	{
+		for (size_t i = 0; i < threads.size(); i++)
+		{
+			threads[i]->executed.store(0, std::memory_order_relaxed);
+			threads[i]->stolen.store(0, std::memory_order_relaxed);
+		}
+	}
+
+private:
+	struct ThreadState
+	{
+		JobDeque queue;
+		Job jobs[MAX_JOBS];
+		unsigned int nextJob = 0;
+		unsigned int random = 0;
+		std::atomic<uint64_t> executed{ 0 };
+		std::atomic<uint64_t> stolen{ 0 };
+	};
+
+	struct ThreadBinding
+	{
+		JobSystem* system;
+		unsigned int index;
+		ThreadBinding(JobSystem* system = nullptr, unsigned int index = 0) : system(system), index(index) {}
+	};
+
+	std::vector<std::unique_ptr<ThreadState> > threads;
+	std::vector<std::thread> workers;
+	std::atomic<bool> running;
+
+	// sleeping workers wake up when queuedJobs goes above zero
+	std::atomic<int> queuedJobs;
+	std::atomic<int> sleeping;
+	std::mutex wakeMutex;
+	std::condition_variable wakeCondition;
+
+	// jobs waiting on a dependency
+	std::mutex deferredMutex;
+	std::vector<Job*> deferred;
+	std::atomic<int> deferredCount;
+
+	static ThreadBinding& currentThread()
+	{
+		static thread_local ThreadBinding binding;
+		return binding;
+	}
+
+	template <typename Function>
+	static void invokeRange(const Job& job)
+	{
+		(*(const Function*)job.data)(job.first, job.last);
+	}
+
+	void submit(Job* job)
+	{
+		unsigned int index = threadIndex();
+		if (!threads[index]->queue.push(job))
+		{
+			// full, no point in queueing more than this anyway
+			execute(*job, index);
+			return;
+		}
+		queuedJobs.fetch_add(1);
+		if (sleeping.load() > 0)
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+			wakeCondition.notify_one();
+		}
+	}
+
+	void execute(Job& job, unsigned int index)
+	{
+		job.function(job);
+		threads[index]->executed.fetch_add(1, std::memory_order_relaxed);
+		if (job.counter->value.fetch_sub(1) == 1 && deferredCount.load() > 0)
+			releaseDeferred();
+	}
+
+	// a counter hit zero, queue whatever was waiting on a finished one
+	void releaseDeferred()
+	{
+		std::vector<Job*> ready;
+		{
+			std::lock_guard<std::mutex> lock(deferredMutex);
+			for (size_t i = 0; i < deferred.size();)
+			{
+				if (deferred[i]->dependency->done())
+				{
+					ready.push_back(deferred[i]);
+					deferred[i] = deferred.back();
+					deferred.pop_back();
+					deferredCount.fetch_sub(1);
+				}
+				else
+					i++;
+			}
+		}
+		for (size_t i = 0; i < ready.size(); i++)
+			submit(ready[i]);
+	}
+
+	// own queue first, then steal from the others starting at a random one
+	bool runOne(unsigned int index)
+	{
+		ThreadState& state = *threads[index];
+		Job* job = state.queue.pop();
+		if (!job)
+		{
+			unsigned int count = (unsigned int)threads.size();
+			state.random = state.random * 1664525u + 1013904223u;
+			unsigned int start = (state.random >> 8) % count;
+			for (unsigned int i = 0; i < count && !job; i++)
+			{
+				unsigned int victim = (start + i) % count;
+				if (victim != index)
+					job = threads[victim]->queue.steal();
+			}
+			if (!job)
+				return false;
+			state.stolen.fetch_add(1, std::memory_order_relaxed);
+		}
+		queuedJobs.fetch_sub(1);
+		execute(*job, index);
+		return true;
+	}
+
+	void workerLoop(unsigned int index)
+	{
+		currentThread() = ThreadBinding(this, index);
+		threads[index]->random = index * 2654435761u;
+		unsigned int idleRounds = 0;
+		while (running.load())
+		{
+			if (runOne(index))
+			{
+				idleRounds = 0;
+				continue;
+			}
+
+			// spin a little first, frames hand out work in bursts and waking up takes a while
+			if (++idleRounds < 64)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(wakeMutex);
+			sleeping.fetch_add(1);
+			wakeCondition.wait(lock, [this]() { return queuedJobs.load() > 0 || !running.load(); });
+			sleeping.fetch_sub(1);
+			idleRounds = 0;
+		}
+	}
+};
+
+#endif // !JOB_SYSTEM_H
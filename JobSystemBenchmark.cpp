@@ -0,0 +1,151 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <JobSystem.h>
+#include <TransformStore.h>
+
+// What the job system costs and how it scales: spawning empty jobs from one thread (so the others have
+// to steal all of them), parallelFor over a fixed amount of work with more and more threads, and a quick
+// check that dependencies run in order. no window or GL context, it's all on the cpu.
+//
+// usage: JobSystemBenchmark [--threads N] [--jobs N] [--count N]
+// --threads is the most threads to scale up to (one per core by default)
+
+double millisecondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void emptyJob(const Job&)
+{
+}
+
+// ---- spawn and steal overhead, jobs that do nothing so all that's left is the scheduling
+void benchmarkSpawn(JobSystem& jobs, unsigned int jobCount)
+{
+	const unsigned int BATCH = 1024;
+	jobs.resetStats();
+	auto start = std::chrono::high_resolution_clock::now();
+	for (unsigned int done = 0; done < jobCount; done += BATCH)
+	{
+		JobCounter counter;
+		for (unsigned int i = 0; i < BATCH; i++)
+			jobs.run(counter, emptyJob);
+		jobs.wait(counter);
+	}
+	double ms = millisecondsSince(start);
+	std::cout << "spawn + run    " << std::setw(2) << jobs.threadCount() << " threads " << std::setw(10) << ms * 1000000.0 / jobCount
+		<< " ns per job, " << std::setw(5) << 100.0 * jobs.jobsStolen() / jobs.jobsExecuted() << " % stolen" << std::endl;
+}
+
+// ---- scaling, the same transform update the cube demos run every frame
+double benchmarkScaling(JobSystem& jobs, TransformStore& transforms, std::vector<float>& matrices)
+{
+	glm::quat delta = glm::angleAxis(0.01f, glm::vec3(0.0f, 1.0f, 0.0f));
+	transforms.applyRotationParallel(delta, jobs);
+	transforms.computeMatricesParallel(matrices.data(), jobs);
+
+	const int RUNS = 10;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int r = 0; r < RUNS; r++)
+	{
+		transforms.applyRotationParallel(delta, jobs);
+		transforms.computeMatricesParallel(matrices.data(), jobs);
+	}
+	return millisecondsSince(start) / RUNS;
+}
+
+// ---- dependencies, b only starts after every a is done, c after b
+struct OrderCheck
+{
+	std::atomic<int> aDone;
+	std::atomic<int> errors;
+	std::atomic<bool> bDone;
+	OrderCheck() : aDone(0), errors(0), bDone(false) {}
+};
+
+void jobA(const Job& job)
+{
+	volatile float x = 0.0f;
+	for (int i = 0; i < 10000; i++)
+		x = x + sqrtf((float)i);
+	((OrderCheck*)job.data)->aDone.fetch_add(1);
+}
+
+void jobB(const Job& job)
+{
+	OrderCheck* check = (OrderCheck*)job.data;
+	if (check->aDone.load() != (int)job.first)
+		check->errors.fetch_add(1);
+	check->bDone.store(true);
+}
+
+void jobC(const Job& job)
+{
+	OrderCheck* check = (OrderCheck*)job.data;
+	if (!check->bDone.load())
+		check->errors.fetch_add(1);
+}
+
+void checkDependencies(JobSystem& jobs)
+{
+	const unsigned int A_JOBS = 64;
+	int errors = 0;
+	for (int round = 0; round < 100; round++)
+	{
+		OrderCheck check;
+		JobCounter a, b, c;
+		for (unsigned int i = 0; i < A_JOBS; i++)
+			jobs.run(a, jobA, &check);
+		jobs.run(b, jobB, &check, A_JOBS, 0, &a);
+		jobs.run(c, jobC, &check, 0, 0, &b);
+		jobs.wait(c);
+		errors += check.errors.load();
+	}
+	std::cout << "dependencies   " << (errors == 0 ? "ok" : "FAILED") << " (" << errors << " out of order)" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	unsigned int jobCount = 1000000;
+	unsigned int count = 1000000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			maxThreads = std::max(1, atoi(argv[++i]));
+		else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+			jobCount = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+			count = (unsigned int)atoi(argv[++i]);
+	}
+
+	std::cout << std::fixed << std::setprecision(3);
+
+	TransformStore transforms;
+	transforms.reserve(count);
+	for (unsigned int i = 0; i < count; i++)
+		transforms.add(glm::vec3((float)(i % 1000), (float)(i / 1000), 0.0f), glm::angleAxis((float)i, glm::vec3(0.0f, 0.0f, 1.0f)), glm::vec3(1.0f));
+	std::vector<float> matrices(count * 16);
+
+	double singleMs = 0.0;
+	for (unsigned int threads = 1; threads <= maxThreads; threads = threads < maxThreads && threads * 2 > maxThreads ? maxThreads : threads * 2)
+	{
+		JobSystem jobs(threads);
+		std::cout << "---- " << threads << " threads" << std::endl;
+		benchmarkSpawn(jobs, jobCount);
+		double ms = benchmarkScaling(jobs, transforms, matrices);
+		if (threads == 1)
+			singleMs = ms;
+		std::cout << "transforms     " << std::setw(10) << ms << " ms for " << count << ", " << std::setw(6) << singleMs / ms << "x" << std::endl;
+		checkDependencies(jobs);
+		if (threads == maxThreads)
+			break;
+	}
+	return 0;
+}
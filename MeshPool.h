@@ -0,0 +1,180 @@
+#pragma once
+#ifndef MESH_POOL_H
+#define MESH_POOL_H
+
+#include <GLExtensions.h>
+#include <Primitives.h>
+#include <StreamBuffer.h>
+
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// where a mesh lives inside the pool's shared buffers
+struct MeshHandle
+{
+	unsigned int indexCount;
+	unsigned int firstIndex;
+	int baseVertex;
+};
+
+// layout is fixed by GL, see glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+// All static meshes suballocated from one vertex buffer and one index buffer behind a single VAO,
+// so any number of different meshes can be drawn without rebinding anything.
+// attribute locations: 0 position, 1 texture coords, 2 normal
+//
+// positionVAO draws the same meshes out of a tightly packed copy of the positions alone (location 0),
+// for depth only passes that would otherwise fetch the whole vertex for nothing
+class MeshPool
+{
+public:
+	unsigned int VAO, VBO, EBO;
+	unsigned int positionVAO, positionVBO;
+
+	MeshPool(size_t maxVertices, size_t maxIndices)
+		: vertexCapacity(maxVertices), indexCapacity(maxIndices)
+	{
+		glGenVertexArrays(1, &VAO);
+		glGenBuffers(1, &VBO);
+		glGenBuffers(1, &EBO);
+
+		glBindVertexArray(VAO);
+
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, vertexCapacity * sizeof(MeshVertex), NULL, GL_STATIC_DRAW);
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity * sizeof(unsigned int), NULL, GL_STATIC_DRAW);
+
+		// for positions
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, position));
+		glEnableVertexAttribArray(0);
+
+		// for texture coords
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, texCoord));
+		glEnableVertexAttribArray(1);
+
+		// for normals
+		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, normal));
+		glEnableVertexAttribArray(2);
+
+		// same indices, same base vertex, 12 bytes per vertex instead of 32
+		glGenVertexArrays(1, &positionVAO);
+		glGenBuffers(1, &positionVBO);
+		glBindVertexArray(positionVAO);
+		glBindBuffer(GL_ARRAY_BUFFER, positionVBO);
+		glBufferData(GL_ARRAY_BUFFER, vertexCapacity * sizeof(glm::vec3), NULL, GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+		glEnableVertexAttribArray(0);
+
+		glBindVertexArray(0);
+	}
+
+	// copies the mesh into the shared buffers. indices stay relative to the mesh, baseVertex does the rest
+	MeshHandle add(const MeshData& mesh)
+	{
+		MeshHandle handle = { 0, 0, 0 };
+		if (vertexCount + mesh.vertices.size() > vertexCapacity || indexCount + mesh.indices.size() > indexCapacity)
+		{
+			std::cout << "ERROR::MESH_POOL::OUT_OF_SPACE" << std::endl;
+			return handle;
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferSubData(GL_ARRAY_BUFFER, vertexCount * sizeof(MeshVertex), mesh.vertices.size() * sizeof(MeshVertex), mesh.vertices.data());
+		std::vector<glm::vec3> positions(mesh.vertices.size());
+		for (size_t i = 0; i < positions.size(); i++)
+			positions[i] = mesh.vertices[i].position;
+		glBindBuffer(GL_ARRAY_BUFFER, positionVBO);
+		glBufferSubData(GL_ARRAY_BUFFER, vertexCount * sizeof(glm::vec3), positions.size() * sizeof(glm::vec3), positions.data());
+		glBindVertexArray(VAO);
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), mesh.indices.size() * sizeof(unsigned int), mesh.indices.data());
+		glBindVertexArray(0);
+
+		handle.indexCount = (unsigned int)mesh.indices.size();
+		handle.firstIndex = (unsigned int)indexCount;
+		handle.baseVertex = (int)vertexCount;
+		vertexCount += mesh.vertices.size();
+		indexCount += mesh.indices.size();
+		return handle;
+	}
+
+	size_t verticesUsed() const { return vertexCount; }
+	size_t indicesUsed() const { return indexCount; }
+
+	void destroy()
+	{
+		glDeleteVertexArrays(1, &VAO);
+		glDeleteBuffers(1, &VBO);
+		glDeleteBuffers(1, &EBO);
+		glDeleteVertexArrays(1, &positionVAO);
+		glDeleteBuffers(1, &positionVBO);
+	}
+
+private:
+	size_t vertexCapacity, indexCapacity;
+	size_t vertexCount = 0, indexCount = 0;
+};
+
+// A list of draws out of a MeshPool, rebuilt every frame and submitted with one glMultiDrawElementsIndirect.
+// the shader finds its per-draw data with gl_DrawIDARB and its per-instance data with gl_BaseInstanceARB + gl_InstanceID
+class IndirectBatch
+{
+public:
+	std::vector<DrawElementsIndirectCommand> commands;
+
+	void clear()
+	{
+		commands.clear();
+	}
+
+	// baseInstance is where this draw's instances start in whatever per-instance buffer the shader reads
+	void add(const MeshHandle& mesh, unsigned int instanceCount, unsigned int baseInstance)
+	{
+		DrawElementsIndirectCommand cmd;
+		cmd.count = mesh.indexCount;
+		cmd.instanceCount = instanceCount;
+		cmd.firstIndex = mesh.firstIndex;
+		cmd.baseVertex = mesh.baseVertex;
+		cmd.baseInstance = baseInstance;
+		commands.push_back(cmd);
+	}
+
+	// copies the commands into this frame's region of an indirect stream buffer
+	bool upload(StreamBuffer& indirectBuffer)
+	{
+		StreamBuffer::Allocation a = indirectBuffer.allocate(commands.size() * sizeof(DrawElementsIndirectCommand));
+		if (a.ptr == NULL)
+			return false;
+		memcpy(a.ptr, commands.data(), commands.size() * sizeof(DrawElementsIndirectCommand));
+		offset = a.offset;
+		buffer = indirectBuffer.ID;
+		return true;
+	}
+
+	// the whole batch in one call. the pool's VAO and the program have to be bound already
+	void draw() const
+	{
+		if (commands.empty())
+			return;
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)offset, (GLsizei)commands.size(), 0);
+	}
+
+private:
+	unsigned int buffer = 0;
+	GLintptr offset = 0;
+};
+
+#endif // !MESH_POOL_H
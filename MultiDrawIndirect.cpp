@@ -0,0 +1,347 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <Shader.h>
+#include <stb_image.h>
+#include <Camera.h>
+#include <GLExtensions.h>
+#include <StreamBuffer.h>
+#include <MeshPool.h>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// every mesh type is a different piece of geometry (prisms and spheres of increasing detail),
+// drawn INSTANCES_PER_TYPE times
+const unsigned int NUM_MESH_TYPES = 256;
+const unsigned int INSTANCES_PER_TYPE = 16;
+
+// M switches between one glMultiDrawElementsIndirect and one draw call per mesh type
+bool useMultiDraw = true;
+
+// timing
+float deltaTime = 0.0f;	// Time between current frame and last frame
+float lastFrame = 0.0f; // Time of last frame
+
+// camera
+Camera camera(glm::vec3(0.0f, 10.0f, 40.0f));
+float lastX = SCR_WIDTH / 2.0f;
+float lastY = SCR_HEIGHT / 2.0f;
+bool firstMouse = true;
+
+int main()
+{
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- GlAD, GLFW and OpenGL setup
+	// ---------------------------------------------------------
+
+	// initilize the glfw library
+	glfwInit();
+
+	// ----- Setting glfw options
+
+	// multi draw indirect and SSBOs need 4.3, gl_DrawID comes from ARB_shader_draw_parameters
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+
+	// we specify that we only want the core features of OpenGL
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	// -----
+
+	// creating our window and configuring it's width, height and name
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	// we tell the glfw that set our window to the current thread's context
+	glfwMakeContextCurrent(window);
+
+	// a callback to resize the window when the user resized the window
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	// for toggles that should only fire once per key press
+	glfwSetKeyCallback(window, key_callback);
+
+	// a callback to know the mouse position and calculate the direction of the camera
+	glfwSetCursorPosCallback(window, mouse_callback);
+
+	// to get mouse scroller input
+	glfwSetScrollCallback(window, scroll_callback);
+
+	// tell GLFW to capture our mouse
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	// GLAD initilization
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initilize GLAD" << std::endl;
+		return -1;
+	}
+	loadGLExtensions();
+	if (!GLCaps.multiDrawIndirect || !GLCaps.shaderDrawParameters)
+	{
+		std::cout << "This demo needs GL 4.3 and ARB_shader_draw_parameters" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	// configure global opengl state
+	// -----------------------------
+	// for z buffer
+	glEnable(GL_DEPTH_TEST);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Meshes
+	// ---------------------------------------------------------
+
+	// loading the shader
+	Shader ourShader("multiDraw.verts", "multiDraw.frags");
+
+	// all mesh types go into the same vertex and index buffer
+	MeshPool meshPool(1 << 19, 1 << 21);
+	std::vector<MeshHandle> meshes;
+	for (unsigned int i = 0; i < NUM_MESH_TYPES; i++)
+	{
+		if (i % 2 == 0)
+			meshes.push_back(meshPool.add(makePrism(3 + i / 2)));
+		else
+			meshes.push_back(meshPool.add(makeSphere(3 + (i / 2) % 16, 4 + i / 2)));
+	}
+	std::cout << NUM_MESH_TYPES << " mesh types, " << meshPool.verticesUsed() << " vertices, "
+		<< meshPool.indicesUsed() << " indices in one pool" << std::endl;
+
+	// instances of the same mesh type are next to each other so a draw covers a contiguous range
+	std::vector<glm::mat4> models;
+	for (unsigned int type = 0; type < NUM_MESH_TYPES; type++)
+	{
+		for (unsigned int i = 0; i < INSTANCES_PER_TYPE; i++)
+		{
+			glm::mat4 model = glm::mat4(1.0f);
+			model = glm::translate(model, glm::vec3((float)(type % 16) * 4.0f - 32.0f, (float)i * 1.5f - 12.0f, -(float)(type / 16) * 4.0f));
+			model = glm::rotate(model, glm::radians(20.0f * i), glm::vec3(0.5f, 1.0f, 0.0f));
+			models.push_back(model);
+		}
+	}
+
+	// static per instance data, read by the vertex shader from binding 0
+	unsigned int instanceSSBO;
+	glGenBuffers(1, &instanceSSBO);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceSSBO);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, models.size() * sizeof(glm::mat4), models.data(), GL_STATIC_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceSSBO);
+
+	// per frame data: the indirect commands and a tint per draw (binding 1)
+	StreamBuffer indirectBuffer(GL_DRAW_INDIRECT_BUFFER, NUM_MESH_TYPES * sizeof(DrawElementsIndirectCommand));
+	StreamBuffer drawDataBuffer(GL_SHADER_STORAGE_BUFFER, NUM_MESH_TYPES * sizeof(glm::vec4) + 256);
+	IndirectBatch batch;
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Texture
+	// ---------------------------------------------------------
+
+	unsigned int texture1;
+	glGenTextures(1, &texture1);
+	glBindTexture(GL_TEXTURE_2D, texture1);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int width1, height1, nrChannels1;
+	unsigned char* data1 = stbi_load("container.jpg", &width1, &height1, &nrChannels1, 0);
+	if (data1)
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width1, height1, 0, GL_RGB, GL_UNSIGNED_BYTE, data1);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else
+	{
+		std::cout << "Failed to load texture1" << std::endl;
+	}
+	stbi_image_free(data1);
+
+	ourShader.use(); // don't forget to activate the shader before setting uniforms!
+	ourShader.setInt("texture1", 0);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- our render loop (smth like update in unity!)
+	// ---------------------------------------------------------
+
+	glm::mat4 view = glm::mat4(1.0f);
+	glm::mat4 projection = glm::mat4(1.0f);
+
+	double statsStart = glfwGetTime();
+	unsigned int statsFrames = 0;
+	double statsSubmitMs = 0.0;
+	unsigned int drawCalls = 0;
+
+	while (!glfwWindowShouldClose(window))
+	{
+		// ---- Calculating deltaTime
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// ---- input handler
+		processInput(window);
+
+		// ---- build this frame's command list and per draw data
+		indirectBuffer.beginFrame();
+		drawDataBuffer.beginFrame();
+
+		batch.clear();
+		for (unsigned int type = 0; type < NUM_MESH_TYPES; type++)
+			batch.add(meshes[type], INSTANCES_PER_TYPE, type * INSTANCES_PER_TYPE);
+		batch.upload(indirectBuffer);
+
+		StreamBuffer::Allocation tints = drawDataBuffer.allocate(NUM_MESH_TYPES * sizeof(glm::vec4), 256);
+		if (tints.ptr != NULL)
+		{
+			glm::vec4* out = (glm::vec4*)tints.ptr;
+			for (unsigned int type = 0; type < NUM_MESH_TYPES; type++)
+			{
+				float t = currentFrame + type * 0.05f;
+				out[type] = glm::vec4(0.6f + 0.4f * sin(t), 0.6f + 0.4f * sin(t + 2.1f), 0.6f + 0.4f * sin(t + 4.2f), 1.0f);
+			}
+		}
+		indirectBuffer.flush();
+		drawDataBuffer.flush();
+
+		// ----- Rendering stuff
+
+		// seting the clear color
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		// clear the window color buffer bit and z buffer bit
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture1);
+
+		ourShader.use();
+		view = camera.GetViewMatrix();
+		projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 200.0f);
+		ourShader.setMat4("view", view);
+		ourShader.setMat4("projection", projection);
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, drawDataBuffer.ID, tints.offset, NUM_MESH_TYPES * sizeof(glm::vec4));
+
+		auto submitStart = std::chrono::high_resolution_clock::now();
+		glBindVertexArray(meshPool.VAO);
+		if (useMultiDraw)
+		{
+			ourShader.setInt("drawOffset", 0);
+			batch.draw();
+			drawCalls = 1;
+		}
+		else
+		{
+			// what it costs without indirect drawing: a uniform and a draw per mesh type
+			int drawOffsetLoc = glGetUniformLocation(ourShader.ID, "drawOffset");
+			for (unsigned int i = 0; i < batch.commands.size(); i++)
+			{
+				const DrawElementsIndirectCommand& cmd = batch.commands[i];
+				glUniform1i(drawOffsetLoc, i);
+				glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, cmd.count, GL_UNSIGNED_INT,
+					(void*)(cmd.firstIndex * sizeof(unsigned int)), cmd.instanceCount, cmd.baseVertex, cmd.baseInstance);
+			}
+			drawCalls = (unsigned int)batch.commands.size();
+		}
+		statsSubmitMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - submitStart).count();
+
+		indirectBuffer.endFrame();
+		drawDataBuffer.endFrame();
+
+		statsFrames++;
+		if (glfwGetTime() - statsStart >= 1.0)
+		{
+			std::cout << (useMultiDraw ? "multi draw indirect: " : "separate draws: ") << drawCalls << " draw calls for "
+				<< batch.commands.size() << " meshes, submit " << statsSubmitMs / statsFrames << " ms/frame, "
+				<< statsFrames << " fps" << std::endl;
+			statsStart = glfwGetTime();
+			statsFrames = 0;
+			statsSubmitMs = 0.0;
+		}
+
+		// double buffer mechanism to render things smoothly without user seeing the acutal drawings
+		glfwSwapBuffers(window);
+		// checks if any events are created
+		glfwPollEvents();
+	}
+
+	// optional: de-allocate all resources once they've outlived their purpose:
+	// ------------------------------------------------------------------------
+	meshPool.destroy();
+	indirectBuffer.destroy();
+	drawDataBuffer.destroy();
+	glDeleteBuffers(1, &instanceSSBO);
+
+	// glfw: terminate, clearing all previously allocated GLFW resources.
+	// ------------------------------------------------------------------
+	glfwTerminate();
+
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+}
+
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(RIGHT, deltaTime);
+}
+
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (key == GLFW_KEY_M && action == GLFW_PRESS)
+		useMultiDraw = !useMultiDraw;
+}
+
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+	if (firstMouse) // initially set to true
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	float xoffset = xpos - lastX;
+	float yoffset = lastY - ypos; // reversed since y-coordinates range from bottom to top
+	lastX = xpos;
+	lastY = ypos;
+
+	camera.ProcessMouseMovement(xoffset, yoffset, true);
+}
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.ProcessMouseScroll(yoffset);
+}
@@ -7,6 +7,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <SceneGenerator.h>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window);
@@ -24,7 +25,7 @@ const float translateForce = 0.005f;
 const float scaleForce = 0.005f;
 const float rotateForce = 1.0f;
 
-int main()
+int main(int argc, char* argv[])
 {
 	// ---------------------------------------------------------
 	// --------------------------------------------------------- GlAD, GLFW and OpenGL setup
@@ -134,6 +135,16 @@ int main()
 		glm::vec3(-1.3f, 1.0f, -1.5f)
 	};
 
+	// --scene swaps the ten cubes above for a generated scene (see SceneGenerator.h)
+	SceneOptions sceneOptions;
+	std::vector<SceneObject> cubes;
+	if (parseSceneOptions(argc, argv, sceneOptions))
+		cubes = generateScene(sceneOptions);
+	else
+		for (unsigned int i = 0; i < 10; i++)
+			cubes.push_back(SceneObject(cubePositions[i], glm::vec3(1.0f, 0.3f, 0.5f), 20.0f * i));
+	std::cout << cubes.size() << " cubes" << std::endl;
+
 	unsigned int VBO, VAO;
 	glGenBuffers(1, &VBO);
 	glGenVertexArrays(1, &VAO);
@@ -289,13 +300,19 @@ int main()
 		}
 
 		glBindVertexArray(VAO);
-		for (unsigned int i = 0; i < 10; i++)
+		unsigned int boundTexture = 0;
+		for (unsigned int i = 0; i < cubes.size(); i++)
 		{
-			glm::mat4 model = glm::mat4(1.0f);
-			model = glm::translate(model, cubePositions[i]);
-			float angle = 20.0f * i;
-			model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-			ourShader.setMat4("model", model);
+			// generated cubes swap which texture is the base and which the overlay
+			if (cubes[i].texture != boundTexture)
+			{
+				boundTexture = cubes[i].texture;
+				glActiveTexture(GL_TEXTURE0);
+				glBindTexture(GL_TEXTURE_2D, boundTexture == 0 ? texture1 : texture2);
+				glActiveTexture(GL_TEXTURE1);
+				glBindTexture(GL_TEXTURE_2D, boundTexture == 0 ? texture2 : texture1);
+			}
+			ourShader.setMat4("model", cubes[i].modelMatrix());
 
 			glDrawArrays(GL_TRIANGLES, 0, 36);
 		}
@@ -0,0 +1,91 @@
+#pragma once
+#ifndef POINT_LIGHTS_H
+#define POINT_LIGHTS_H
+
+#include <SceneGenerator.h>
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <vector>
+
+// the layout the shaders read, as vertex attributes or two RGBA32F texels: position + radius, color
+struct PointLight
+{
+	glm::vec4 positionRadius;
+	glm::vec4 color;
+};
+
+// A set of point lights drifting on small circles over a scene, for the lighting demos.
+// update() writes the lights of the current time in view space, which is where the shaders light
+class PointLightSet
+{
+public:
+	// lights spread through the box, radius picked between minRadius and maxRadius
+	PointLightSet(unsigned int count, const glm::vec3& boundsMin, const glm::vec3& boundsMax, float minRadius = 3.0f,
+		float maxRadius = 8.0f, unsigned int seed = 7)
+	{
+		SceneRandom random(seed);
+		lights.resize(count);
+		viewLights.resize(count);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			Light& light = lights[i];
+			light.center = glm::vec3(random.range(boundsMin.x, boundsMax.x), random.range(boundsMin.y, boundsMax.y), random.range(boundsMin.z, boundsMax.z));
+			light.radius = random.range(minRadius, maxRadius);
+			light.orbit = random.range(0.5f, 2.0f);
+			light.speed = random.range(-1.0f, 1.0f);
+			light.phase = random.range(0.0f, 6.2831853f);
+			// saturated colors, so overlapping lights are easy to tell apart
+			glm::vec3 color(random.next01(), random.next01(), random.next01());
+			color /= glm::max(color.x, glm::max(color.y, color.z)) + 0.0001f;
+			light.color = color * random.range(0.6f, 1.2f);
+		}
+	}
+
+	// moves the lights to time and transforms them into view space
+	const std::vector<PointLight>& update(float time, const glm::mat4& view)
+	{
+		for (size_t i = 0; i < lights.size(); i++)
+		{
+			const Light& light = lights[i];
+			float angle = light.phase + time * light.speed;
+			glm::vec3 position = light.center + glm::vec3(cosf(angle), 0.0f, sinf(angle)) * light.orbit;
+			viewLights[i].positionRadius = glm::vec4(glm::vec3(view * glm::vec4(position, 1.0f)), light.radius);
+			viewLights[i].color = glm::vec4(light.color, 1.0f);
+		}
+		return viewLights;
+	}
+
+	size_t size() const { return lights.size(); }
+
+private:
+	struct Light
+	{
+		glm::vec3 center;
+		float radius;
+		float orbit;   // radius of the circle it drifts on
+		float speed;   // radians per second
+		float phase;
+		glm::vec3 color;
+	};
+
+	std::vector<Light> lights;
+	std::vector<PointLight> viewLights;
+};
+
+// the box the objects of a scene fill, padded by their size
+inline void sceneBounds(const std::vector<SceneObject>& scene, glm::vec3& boundsMin, glm::vec3& boundsMax)
+{
+	boundsMin = glm::vec3(1e30f);
+	boundsMax = glm::vec3(-1e30f);
+	for (size_t i = 0; i < scene.size(); i++)
+	{
+		boundsMin = glm::min(boundsMin, scene[i].position - scene[i].scale);
+		boundsMax = glm::max(boundsMax, scene[i].position + scene[i].scale);
+	}
+	if (scene.empty())
+		boundsMin = boundsMax = glm::vec3(0.0f);
+}
+
+#endif // !POINT_LIGHTS_H
@@ -0,0 +1,256 @@
+#pragma once
+#ifndef POST_STACK_H
+#define POST_STACK_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <Shader.h>
+#include <RenderTargetPool.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+// the effects in the order they run, bits of a pass mask
+enum PostEffect
+{
+	POST_UPSCALE = 1 << 0,   // the rendered part of the input up to the output size (Catmull-Rom)
+	POST_BLOOM = 1 << 1,     // adds the blurred bright parts
+	POST_TONEMAP = 1 << 2,   // HDR to LDR
+	POST_GRADE = 1 << 3,     // lift / gamma / gain, contrast, saturation
+	POST_FXAA = 1 << 4
+};
+
+struct PostSettings
+{
+	bool bloom = true;
+	bool grade = true;
+	bool fxaa = true;
+	// per pixel effects share a pass with the one before them, off draws every effect on its own
+	bool fuse = true;
+
+	float exposure = 1.0f;
+	float bloomThreshold = 1.0f;
+	float bloomKnee = 0.5f;
+	float bloomIntensity = 0.08f;
+	glm::vec3 lift = glm::vec3(0.0f);
+	glm::vec3 gamma = glm::vec3(1.0f);
+	glm::vec3 gain = glm::vec3(1.0f);
+	float saturation = 1.1f;
+	float contrast = 1.05f;
+};
+
+// Post processing from an HDR buffer to the screen.
+//
+// every effect is a define in post.frags. the enabled ones are split into passes: an effect that only
+// looks at its own pixel is appended to the pass before it, one that reads neighbours (upscaling, FXAA)
+// needs the result before it in a texture and starts a new pass. each distinct pass is compiled once as
+// its own permutation. the targets between passes come from a RenderTargetPool, so consecutive passes
+// ping-pong between the same two textures (they can be bigger than asked for, read them through uvScale).
+// bloom has its own chain of half size levels (bloom.frags) and only its final add is fused into the
+// main passes
+class PostStack
+{
+public:
+	PostSettings settings;
+
+	// ---- stats of the last run()
+	unsigned int passes = 0;        // full screen passes, without the bloom chain
+	unsigned int bloomPasses = 0;
+
+	PostStack(RenderTargetPool& pool)
+		: pool(pool), bloomShader("fullscreen.verts", "bloom.frags")
+	{
+		// the passes make their triangle out of gl_VertexID, core profile still wants a VAO bound
+		glGenVertexArrays(1, &emptyVAO);
+	}
+
+	// input is an HDR texture of which only the bottom left inputUvScale was rendered into. the result goes
+	// into outputFramebuffer, width x height
+	void run(unsigned int input, const glm::vec2& inputUvScale, unsigned int outputFramebuffer, int width, int height)
+	{
+		bool depthTest = glIsEnabled(GL_DEPTH_TEST) == GL_TRUE;
+		glDisable(GL_DEPTH_TEST);
+		glBindVertexArray(emptyVAO);
+
+		// ---- the effects into passes
+		bool upscale = inputUvScale.x < 1.0f || inputUvScale.y < 1.0f;
+		std::vector<unsigned int> passMasks = buildPasses(upscale);
+		passes = (unsigned int)passMasks.size();
+
+		RenderTarget* bloomTarget = settings.bloom ? runBloom(input, inputUvScale, width, height) : NULL;
+
+		// ---- one pass after the other, each reading the one before
+		RenderTarget* previous = NULL;
+		bool tonemapped = false;
+		for (size_t p = 0; p < passMasks.size(); p++)
+		{
+			unsigned int mask = passMasks[p];
+			tonemapped = tonemapped || (mask & POST_TONEMAP) != 0;
+			bool last = p + 1 == passMasks.size();
+
+			RenderTarget* target = NULL;
+			if (last)
+				glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+			else
+			{
+				// 8 bits are enough once it's tonemapped
+				RenderTargetDesc desc = { width, height, (GLenum)(tonemapped ? GL_RGBA8 : GL_RGBA16F), 1 };
+				target = pool.acquire(desc);
+				glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+			}
+			glViewport(0, 0, width, height);
+
+			Shader& shader = program(mask);
+			shader.use();
+			shader.setInt("source", 0);
+			shader.setVec2("sourceUvScale", previous ? previous->uvScale() : inputUvScale);
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, previous ? previous->texture : input);
+			if (mask & POST_BLOOM)
+			{
+				shader.setInt("bloom", 1);
+				shader.setFloat("bloomIntensity", settings.bloomIntensity);
+				shader.setVec2("bloomUvScale", bloomTarget->uvScale());
+				glActiveTexture(GL_TEXTURE1);
+				glBindTexture(GL_TEXTURE_2D, bloomTarget->texture);
+			}
+			if (mask & POST_TONEMAP)
+				shader.setFloat("exposure", settings.exposure);
+			if (mask & POST_GRADE)
+			{
+				shader.setVec3("lift", settings.lift);
+				shader.setVec3("gamma", settings.gamma);
+				shader.setVec3("gain", settings.gain);
+				shader.setFloat("saturation", settings.saturation);
+				shader.setFloat("contrast", settings.contrast);
+			}
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+
+			// read, so it can be the target of the pass after next
+			pool.release(previous);
+			if (mask & POST_BLOOM)
+			{
+				pool.release(bloomTarget);
+				bloomTarget = NULL;
+			}
+			previous = target;
+		}
+
+		glActiveTexture(GL_TEXTURE0);
+		if (depthTest)
+			glEnable(GL_DEPTH_TEST);
+	}
+
+	// how many different permutations got compiled so far
+	size_t programCount() const { return programs.size(); }
+
+	void destroy()
+	{
+		for (size_t i = 0; i < programs.size(); i++)
+			glDeleteProgram(programs[i].second->ID);
+		programs.clear();
+		glDeleteProgram(bloomShader.ID);
+		glDeleteVertexArrays(1, &emptyVAO);
+	}
+
+private:
+	RenderTargetPool& pool;
+	Shader bloomShader;
+	unsigned int emptyVAO;
+	std::vector<std::pair<unsigned int, std::unique_ptr<Shader>>> programs;
+
+	static bool readsNeighbours(unsigned int effect) { return effect == POST_UPSCALE || effect == POST_FXAA; }
+
+	std::vector<unsigned int> buildPasses(bool upscale) const
+	{
+		std::vector<unsigned int> effects;
+		if (upscale)
+			effects.push_back(POST_UPSCALE);
+		if (settings.bloom)
+			effects.push_back(POST_BLOOM);
+		effects.push_back(POST_TONEMAP);
+		if (settings.grade)
+			effects.push_back(POST_GRADE);
+		if (settings.fxaa)
+			effects.push_back(POST_FXAA);
+
+		std::vector<unsigned int> passMasks;
+		for (size_t e = 0; e < effects.size(); e++)
+		{
+			if (passMasks.empty() || !settings.fuse || readsNeighbours(effects[e]))
+				passMasks.push_back(effects[e]);
+			else
+				passMasks.back() |= effects[e];
+		}
+		return passMasks;
+	}
+
+	Shader& program(unsigned int mask)
+	{
+		for (size_t i = 0; i < programs.size(); i++)
+			if (programs[i].first == mask)
+				return *programs[i].second;
+
+		static const char* names[5] = { "UPSCALE", "BLOOM", "TONEMAP", "GRADE", "FXAA" };
+		std::string defines;
+		for (int bit = 0; bit < 5; bit++)
+			if (mask & (1u << bit))
+				defines += std::string("#define ") + names[bit] + "\n";
+		programs.push_back(std::make_pair(mask, std::unique_ptr<Shader>(new Shader("fullscreen.verts", "post.frags", defines))));
+		return *programs.back().second;
+	}
+
+	// the bright parts blurred over a few half size levels, returns the biggest one (still acquired)
+	RenderTarget* runBloom(unsigned int input, const glm::vec2& inputUvScale, int width, int height)
+	{
+		// a fixed chain for the output size, the input's rendered part is mapped onto it
+		RenderTarget* levels[6];
+		int levelCount = 0;
+		for (int w = std::max(1, width / 2), h = std::max(1, height / 2); levelCount < 6 && (levelCount == 0 || (w >= 8 && h >= 8)); w /= 2, h /= 2)
+		{
+			RenderTargetDesc desc = { w, h, GL_R11F_G11F_B10F, 1 };
+			levels[levelCount++] = pool.acquire(desc);
+		}
+		bloomPasses = 0;
+
+		bloomShader.use();
+		bloomShader.setInt("source", 0);
+		bloomShader.setFloat("threshold", settings.bloomThreshold);
+		bloomShader.setFloat("knee", std::max(settings.bloomKnee, 0.0001f));
+		glActiveTexture(GL_TEXTURE0);
+
+		// ---- down: the bright pass into the first level, then every level into the next
+		for (int l = 0; l < levelCount; l++)
+		{
+			bloomShader.setInt("mode", l == 0 ? 0 : 1);
+			bloomShader.setVec2("sourceUvScale", l == 0 ? inputUvScale : levels[l - 1]->uvScale());
+			glBindTexture(GL_TEXTURE_2D, l == 0 ? input : levels[l - 1]->texture);
+			glBindFramebuffer(GL_FRAMEBUFFER, levels[l]->framebuffer);
+			glViewport(0, 0, levels[l]->desc.width, levels[l]->desc.height);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+			bloomPasses++;
+		}
+
+		// ---- up: every level added onto the one above
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE);
+		bloomShader.setInt("mode", 2);
+		for (int l = levelCount - 1; l > 0; l--)
+		{
+			bloomShader.setVec2("sourceUvScale", levels[l]->uvScale());
+			glBindTexture(GL_TEXTURE_2D, levels[l]->texture);
+			glBindFramebuffer(GL_FRAMEBUFFER, levels[l - 1]->framebuffer);
+			glViewport(0, 0, levels[l - 1]->desc.width, levels[l - 1]->desc.height);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+			pool.release(levels[l]);
+			bloomPasses++;
+		}
+		glDisable(GL_BLEND);
+
+		return levels[0];
+	}
+};
+
+#endif // !POST_STACK_H
@@ -0,0 +1,139 @@
+#pragma once
+#ifndef PRIMITIVES_H
+#define PRIMITIVES_H
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <vector>
+
+// vertex layout shared by every indexed mesh: position, normal, texture coords
+struct MeshVertex
+{
+	glm::vec3 position;
+	glm::vec3 normal;
+	glm::vec2 texCoord;
+};
+
+struct MeshData
+{
+	std::vector<MeshVertex> vertices;
+	std::vector<unsigned int> indices;
+};
+
+// unit cube centered on the origin, 4 vertices per face so every face gets its own normal and uvs
+inline MeshData makeCube()
+{
+	MeshData mesh;
+	const glm::vec3 normals[6] = {
+		glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 0.0f, 1.0f),
+		glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f),
+		glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)
+	};
+	for (int face = 0; face < 6; face++)
+	{
+		glm::vec3 n = normals[face];
+		// two axes spanning the face
+		glm::vec3 u = glm::vec3(n.y, n.z, n.x);
+		glm::vec3 v = glm::cross(n, u);
+		unsigned int first = (unsigned int)mesh.vertices.size();
+		const float corners[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+		for (int c = 0; c < 4; c++)
+		{
+			MeshVertex vertex;
+			vertex.position = (n + u * corners[c][0] + v * corners[c][1]) * 0.5f;
+			vertex.normal = n;
+			vertex.texCoord = glm::vec2(corners[c][0] * 0.5f + 0.5f, corners[c][1] * 0.5f + 0.5f);
+			mesh.vertices.push_back(vertex);
+		}
+		unsigned int quad[6] = { 0, 1, 2, 2, 3, 0 };
+		for (int i = 0; i < 6; i++)
+			mesh.indices.push_back(first + quad[i]);
+	}
+	return mesh;
+}
+
+// closed prism with a regular polygon as its base, fits in the unit cube
+inline MeshData makePrism(int sides)
+{
+	MeshData mesh;
+	const float PI = 3.14159265358979f;
+
+	// walls, with their own vertices so the edges stay sharp
+	for (int i = 0; i < sides; i++)
+	{
+		float a0 = 2.0f * PI * i / sides;
+		float a1 = 2.0f * PI * (i + 1) / sides;
+		glm::vec3 p0 = glm::vec3(cos(a0) * 0.5f, 0.0f, sin(a0) * 0.5f);
+		glm::vec3 p1 = glm::vec3(cos(a1) * 0.5f, 0.0f, sin(a1) * 0.5f);
+		glm::vec3 n = glm::normalize(glm::vec3(cos((a0 + a1) * 0.5f), 0.0f, sin((a0 + a1) * 0.5f)));
+		unsigned int first = (unsigned int)mesh.vertices.size();
+		float u0 = (float)i / sides, u1 = (float)(i + 1) / sides;
+		mesh.vertices.push_back({ p0 + glm::vec3(0.0f, -0.5f, 0.0f), n, glm::vec2(u0, 0.0f) });
+		mesh.vertices.push_back({ p1 + glm::vec3(0.0f, -0.5f, 0.0f), n, glm::vec2(u1, 0.0f) });
+		mesh.vertices.push_back({ p1 + glm::vec3(0.0f, 0.5f, 0.0f), n, glm::vec2(u1, 1.0f) });
+		mesh.vertices.push_back({ p0 + glm::vec3(0.0f, 0.5f, 0.0f), n, glm::vec2(u0, 1.0f) });
+		unsigned int quad[6] = { 0, 2, 1, 0, 3, 2 };
+		for (int k = 0; k < 6; k++)
+			mesh.indices.push_back(first + quad[k]);
+	}
+
+	// caps as triangle fans around a center vertex
+	for (int cap = 0; cap < 2; cap++)
+	{
+		float y = cap == 0 ? -0.5f : 0.5f;
+		glm::vec3 n = glm::vec3(0.0f, cap == 0 ? -1.0f : 1.0f, 0.0f);
+		unsigned int center = (unsigned int)mesh.vertices.size();
+		mesh.vertices.push_back({ glm::vec3(0.0f, y, 0.0f), n, glm::vec2(0.5f, 0.5f) });
+		for (int i = 0; i < sides; i++)
+		{
+			float a = 2.0f * PI * i / sides;
+			mesh.vertices.push_back({ glm::vec3(cos(a) * 0.5f, y, sin(a) * 0.5f), n, glm::vec2(cos(a) * 0.5f + 0.5f, sin(a) * 0.5f + 0.5f) });
+		}
+		for (int i = 0; i < sides; i++)
+		{
+			unsigned int a = center + 1 + i;
+			unsigned int b = center + 1 + (i + 1) % sides;
+			mesh.indices.push_back(center);
+			mesh.indices.push_back(cap == 0 ? a : b);
+			mesh.indices.push_back(cap == 0 ? b : a);
+		}
+	}
+	return mesh;
+}
+
+// uv sphere of radius 0.5
+inline MeshData makeSphere(int stacks, int slices)
+{
+	MeshData mesh;
+	const float PI = 3.14159265358979f;
+	for (int y = 0; y <= stacks; y++)
+	{
+		float v = (float)y / stacks;
+		float phi = v * PI;
+		for (int x = 0; x <= slices; x++)
+		{
+			float u = (float)x / slices;
+			float theta = u * 2.0f * PI;
+			glm::vec3 n = glm::vec3(cos(theta) * sin(phi), cos(phi), sin(theta) * sin(phi));
+			mesh.vertices.push_back({ n * 0.5f, n, glm::vec2(u, 1.0f - v) });
+		}
+	}
+	for (int y = 0; y < stacks; y++)
+	{
+		for (int x = 0; x < slices; x++)
+		{
+			unsigned int i0 = y * (slices + 1) + x;
+			unsigned int i1 = i0 + slices + 1;
+			mesh.indices.push_back(i0);
+			mesh.indices.push_back(i0 + 1);
+			mesh.indices.push_back(i1);
+			mesh.indices.push_back(i1);
+			mesh.indices.push_back(i0 + 1);
+			mesh.indices.push_back(i1 + 1);
+		}
+	}
+	return mesh;
+}
+
+#endif // !PRIMITIVES_H
@@ -0,0 +1,509 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <stb_image.h>
+#include <Shader.h>
+#include <Camera.h>
+#include <GLExtensions.h>
+#include <MeshPool.h>
+#include <RenderQueue.h>
+#include <SceneGenerator.h>
+#include <Texture.h>
+#include <ImageWriter.h>
+#include <ImageDiff.h>
+
+// Renders every scene layout from a few fixed camera poses into an offscreen target, compares the frames
+// against golden images and the frame times against a stored baseline, and exits with 1 when anything
+// got worse by more than the thresholds. --update writes new goldens and a new baseline instead.
+//
+// goldens are <dir>/<layout>_<pose>.png and the baseline is <dir>/perf.txt. a failing image also leaves
+// <name>_actual.png and <name>_diff.png next to its golden
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+// the offscreen size, fixed so the goldens don't depend on the window or the display scaling
+const int TARGET_WIDTH = 640;
+const int TARGET_HEIGHT = 360;
+const float FAR_PLANE = 300.0f;
+
+struct CameraPose
+{
+	const char* name;
+	glm::vec3 position;
+	float yaw;
+	float pitch;
+};
+
+// outside looking in, from above at an angle, and from inside the scene
+const CameraPose POSES[] = {
+	{ "front", glm::vec3(0.0f, 5.0f, 70.0f), -90.0f, -4.0f },
+	{ "above", glm::vec3(45.0f, 40.0f, 45.0f), -135.0f, -35.0f },
+	{ "inside", glm::vec3(0.0f, 2.0f, 0.0f), 30.0f, 10.0f }
+};
+const unsigned int POSE_COUNT = sizeof(POSES) / sizeof(POSES[0]);
+
+const SceneLayout LAYOUTS[] = { SCENE_UNIFORM, SCENE_CLUSTERED, SCENE_GRID, SCENE_CITY };
+const char* LAYOUT_NAMES[] = { "uniform", "clustered", "grid", "city" };
+const unsigned int LAYOUT_COUNT = sizeof(LAYOUTS) / sizeof(LAYOUTS[0]);
+
+struct Thresholds
+{
+	unsigned char channelTolerance = 8;   // per channel difference that still counts as the same pixel
+	double maxDifferingFraction = 0.001;  // share of pixels allowed to be off by more than that
+	double perfTolerance = 0.2;           // allowed slowdown over the baseline, 0.2 = 20%
+	double perfSlackMs = 0.25;            // plus this much, so sub millisecond noise doesn't fail short frames
+};
+
+struct FrameMetrics
+{
+	double medianMs = 0.0;   // wall time from the start of the frame until the gpu finished it
+	double p95Ms = 0.0;
+	double gpuMs = 0.0;      // average gpu time of the draws
+};
+
+struct BaselineEntry
+{
+	std::string name;
+	double medianMs;
+	double gpuMs;
+};
+
+std::vector<BaselineEntry> readBaseline(const std::string& path);
+bool writeBaseline(const std::string& path, const std::vector<BaselineEntry>& entries);
+const BaselineEntry* findBaseline(const std::vector<BaselineEntry>& entries, const std::string& name);
+void writeDiffImage(const std::string& path, const unsigned char* a, const unsigned char* b, int width, int height);
+
+int main(int argc, char* argv[])
+{
+	// --golden <dir> where goldens and the baseline live, --update rewrites them, --frames N timed frames per test,
+	// --only <text> runs the tests with that in their name, --no-perf only checks images, --show keeps the window
+	// visible, --tolerance N / --max-differing F / --perf-tolerance F set the thresholds, --report <file> writes
+	// a csv of every result, --count/--seed pick the scene size (the layout is looped over)
+	std::string goldenDirectory = "golden";
+	std::string reportPath;
+	std::string only;
+	bool update = false;
+	bool checkPerf = true;
+	bool show = false;
+	int timedFrames = 60;
+	Thresholds thresholds;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc)
+			goldenDirectory = argv[++i];
+		else if (strcmp(argv[i], "--update") == 0)
+			update = true;
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+			timedFrames = std::max(1, atoi(argv[++i]));
+		else if (strcmp(argv[i], "--only") == 0 && i + 1 < argc)
+			only = argv[++i];
+		else if (strcmp(argv[i], "--no-perf") == 0)
+			checkPerf = false;
+		else if (strcmp(argv[i], "--show") == 0)
+			show = true;
+		else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+			thresholds.channelTolerance = (unsigned char)std::min(255, std::max(0, atoi(argv[++i])));
+		else if (strcmp(argv[i], "--max-differing") == 0 && i + 1 < argc)
+			thresholds.maxDifferingFraction = atof(argv[++i]);
+		else if (strcmp(argv[i], "--perf-tolerance") == 0 && i + 1 < argc)
+			thresholds.perfTolerance = atof(argv[++i]);
+		else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc)
+			reportPath = argv[++i];
+	}
+	SceneOptions sceneOptions;
+	sceneOptions.count = 5000;
+	parseSceneOptions(argc, argv, sceneOptions);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- GlAD, GLFW and OpenGL setup
+	// ---------------------------------------------------------
+
+	// initilize the glfw library
+	glfwInit();
+
+	// ----- Setting glfw options
+
+	// nothing here needs more than 3.3
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+	// we specify that we only want the core features of OpenGL
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	// everything is drawn offscreen, the window is only there for the context
+	if (!show)
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	// -----
+
+	// creating our window and configuring it's width, height and name
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	// we tell the glfw that set our window to the current thread's context
+	glfwMakeContextCurrent(window);
+
+	// GLAD initilization
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initilize GLAD" << std::endl;
+		return -1;
+	}
+	loadGLExtensions();
+
+	// frame times shouldn't include waiting for the display
+	glfwSwapInterval(0);
+
+	// configure global opengl state
+	// -----------------------------
+	// for z buffer
+	glEnable(GL_DEPTH_TEST);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Offscreen target
+	// ---------------------------------------------------------
+
+	// a hidden window's back buffer isn't guaranteed to hold anything, an fbo is
+	unsigned int FBO, colorBuffer, depthBuffer;
+	glGenFramebuffers(1, &FBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glGenRenderbuffers(1, &colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, TARGET_WIDTH, TARGET_HEIGHT);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+	glGenRenderbuffers(1, &depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, TARGET_WIDTH, TARGET_HEIGHT);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "ERROR::REGRESSION::FRAMEBUFFER_NOT_COMPLETE" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	unsigned int frameQuery;
+	glGenQueries(1, &frameQuery);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Shaders, meshes & textures
+	// ---------------------------------------------------------
+
+	// the same programs, meshes and textures as RenderQueueCubes
+	Shader mixShader("textureShader.verts", "textureShader.frags");
+	Shader singleShader("textureShader.verts", "singleTexture.frags");
+	Shader translucentShader("textureShader.verts", "translucent.frags");
+	Shader* shaders[3] = { &mixShader, &singleShader, &translucentShader };
+	for (int s = 0; s < 3; s++)
+	{
+		shaders[s]->use();
+		shaders[s]->setInt("texture1", 0);
+		shaders[s]->setInt("texture2", 1);
+	}
+
+	MeshPool cubePool(1024, 1024), prismPool(1024, 1024), spherePool(1024, 4096);
+	MeshPool* pools[3] = { &cubePool, &prismPool, &spherePool };
+	MeshHandle meshes[3] = { cubePool.add(makeCube()), prismPool.add(makePrism(6)), spherePool.add(makeSphere(8, 16)) };
+
+	unsigned int images[4] = { loadTexture("container.jpg"), loadTexture("awesomeface.png", true), loadTexture("Image.jpg"), loadTexture("star.png", true) };
+	unsigned int textureSets[4][2] = { { images[0], images[1] }, { images[2], images[3] }, { images[1], images[0] }, { images[3], images[2] } };
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Tests
+	// ---------------------------------------------------------
+
+	std::string baselinePath = goldenDirectory + "/perf.txt";
+	std::vector<BaselineEntry> baseline = readBaseline(baselinePath);
+	std::vector<BaselineEntry> measured;
+
+	FILE* report = NULL;
+	if (!reportPath.empty())
+	{
+		report = fopen(reportPath.c_str(), "w");
+		if (report)
+			fprintf(report, "test,median_ms,p95_ms,gpu_ms,baseline_ms,differing_pixels,max_difference,mean_difference,result\n");
+		else
+			std::cout << "ERROR::REGRESSION::FILE_NOT_SUCCESFULLY_WRITTEN " << reportPath << std::endl;
+	}
+
+	std::vector<unsigned char> pixels((size_t)TARGET_WIDTH * TARGET_HEIGHT * 4);
+	std::vector<unsigned char> flipped(pixels.size());
+	const size_t rowSize = (size_t)TARGET_WIDTH * 4;
+	const glm::mat4 projection = glm::perspective(glm::radians(ZOOM), (float)TARGET_WIDTH / (float)TARGET_HEIGHT, 0.1f, FAR_PLANE);
+	RenderQueue queue;
+	unsigned int testCount = 0, failures = 0;
+
+	for (unsigned int l = 0; l < LAYOUT_COUNT && !glfwWindowShouldClose(window); l++)
+	{
+		// the scene only changes with the layout, every pose of it reuses the draw items
+		sceneOptions.layout = LAYOUTS[l];
+		sceneOptions.textureCount = 4;
+		std::vector<SceneObject> scene;
+		std::vector<DrawItem> drawItems;
+
+		for (unsigned int p = 0; p < POSE_COUNT && !glfwWindowShouldClose(window); p++)
+		{
+			std::string name = std::string(LAYOUT_NAMES[l]) + "_" + POSES[p].name;
+			if (!only.empty() && name.find(only) == std::string::npos)
+				continue;
+
+			if (scene.empty())
+			{
+				scene = generateScene(sceneOptions);
+				drawItems.resize(scene.size());
+				for (unsigned int i = 0; i < scene.size(); i++)
+				{
+					DrawItem& item = drawItems[i];
+					item.translucent = i % 10 == 0;
+					item.program = item.translucent ? translucentShader.ID : shaders[(i / 3) % 2]->ID;
+					item.textures[0] = textureSets[scene[i].texture][0];
+					item.textures[1] = textureSets[scene[i].texture][1];
+					item.VAO = pools[i % 3]->VAO;
+					item.mesh = meshes[i % 3];
+					item.model = scene[i].modelMatrix();
+				}
+			}
+
+			// nothing moves, so every frame of a test is the same frame
+			Camera camera(POSES[p].position, glm::vec3(0.0f, 1.0f, 0.0f), POSES[p].yaw, POSES[p].pitch);
+			glm::mat4 view = camera.GetViewMatrix();
+			queue.clear();
+			for (unsigned int i = 0; i < drawItems.size(); i++)
+			{
+				drawItems[i].depth = glm::length(scene[i].position - camera.Position) / FAR_PLANE;
+				queue.add(drawItems[i]);
+			}
+			queue.sort();
+
+			// a few untimed frames first so shader compiles and first uploads don't end up in the numbers
+			const int WARMUP_FRAMES = 5;
+			std::vector<double> frameMs;
+			double gpuSumMs = 0.0;
+			for (int frame = 0; frame < WARMUP_FRAMES + timedFrames; frame++)
+			{
+				auto frameStart = std::chrono::high_resolution_clock::now();
+
+				glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+				glViewport(0, 0, TARGET_WIDTH, TARGET_HEIGHT);
+				glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+				glBeginQuery(GL_TIME_ELAPSED, frameQuery);
+				queue.submit(view, projection);
+				glEndQuery(GL_TIME_ELAPSED);
+
+				// waiting for the gpu every frame makes the time one frame's latency instead of however
+				// much the driver decided to queue up
+				glFinish();
+				double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - frameStart).count();
+
+				if (frame >= WARMUP_FRAMES)
+				{
+					GLuint64 gpuNs = 0;
+					glGetQueryObjectui64v(frameQuery, GL_QUERY_RESULT, &gpuNs);
+					gpuSumMs += gpuNs / 1000000.0;
+					frameMs.push_back(ms);
+				}
+
+				if (show)
+				{
+					int framebufferWidth, framebufferHeight;
+					glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+					glBindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+					glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+					glBlitFramebuffer(0, 0, TARGET_WIDTH, TARGET_HEIGHT, 0, 0, framebufferWidth, framebufferHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+					glfwSwapBuffers(window);
+				}
+				glfwPollEvents();
+			}
+
+			FrameMetrics metrics;
+			std::sort(frameMs.begin(), frameMs.end());
+			metrics.medianMs = frameMs[frameMs.size() / 2];
+			metrics.p95Ms = frameMs[std::min(frameMs.size() - 1, (size_t)(frameMs.size() * 0.95))];
+			metrics.gpuMs = gpuSumMs / frameMs.size();
+
+			// ---- read the last frame back, a stall is fine here
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+			glPixelStorei(GL_PACK_ALIGNMENT, 4);
+			glReadPixels(0, 0, TARGET_WIDTH, TARGET_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			// gl reads bottom row first, images want the top row first
+			for (int y = 0; y < TARGET_HEIGHT; y++)
+				memcpy(&flipped[y * rowSize], &pixels[(TARGET_HEIGHT - 1 - y) * rowSize], rowSize);
+
+			BaselineEntry entry = { name, metrics.medianMs, metrics.gpuMs };
+			measured.push_back(entry);
+			std::string goldenPath = goldenDirectory + "/" + name + ".png";
+			testCount++;
+
+			if (update)
+			{
+				bool written = writePng(goldenPath.c_str(), TARGET_WIDTH, TARGET_HEIGHT, 4, flipped.data());
+				printf("%-18s %s | %.2f ms (p95 %.2f), gpu %.2f ms\n", name.c_str(), written ? "golden written" : "golden NOT written",
+					metrics.medianMs, metrics.p95Ms, metrics.gpuMs);
+				if (!written)
+					failures++;
+				if (report)
+					fprintf(report, "%s,%.3f,%.3f,%.3f,,,,,%s\n", name.c_str(), metrics.medianMs, metrics.p95Ms, metrics.gpuMs, written ? "updated" : "error");
+				continue;
+			}
+
+			// ---- image
+			bool imageOk = false;
+			ImageDiffResult diff;
+			int goldenWidth, goldenHeight, goldenChannels;
+			unsigned char* golden = stbi_load(goldenPath.c_str(), &goldenWidth, &goldenHeight, &goldenChannels, 4);
+			std::string imageStatus;
+			if (!golden)
+				imageStatus = "no golden (run with --update)";
+			else if (goldenWidth != TARGET_WIDTH || goldenHeight != TARGET_HEIGHT)
+				imageStatus = "golden has the wrong size";
+			else
+			{
+				diff = compareImages(golden, flipped.data(), (size_t)TARGET_WIDTH * TARGET_HEIGHT, thresholds.channelTolerance);
+				imageOk = diff.differingFraction() <= thresholds.maxDifferingFraction;
+				char text[128];
+				snprintf(text, sizeof(text), "%.3f%% pixels off (max %u, mean %.2f)", diff.differingFraction() * 100.0, diff.maxDifference, diff.meanDifference);
+				imageStatus = text;
+			}
+			if (!imageOk)
+			{
+				writePng((goldenDirectory + "/" + name + "_actual.png").c_str(), TARGET_WIDTH, TARGET_HEIGHT, 4, flipped.data());
+				if (golden && goldenWidth == TARGET_WIDTH && goldenHeight == TARGET_HEIGHT)
+					writeDiffImage(goldenDirectory + "/" + name + "_diff.png", golden, flipped.data(), TARGET_WIDTH, TARGET_HEIGHT);
+			}
+			if (golden)
+				stbi_image_free(golden);
+
+			// ---- performance
+			bool perfOk = true;
+			const BaselineEntry* reference = findBaseline(baseline, name);
+			if (checkPerf && reference)
+				perfOk = metrics.medianMs <= reference->medianMs * (1.0 + thresholds.perfTolerance) + thresholds.perfSlackMs
+					&& metrics.gpuMs <= reference->gpuMs * (1.0 + thresholds.perfTolerance) + thresholds.perfSlackMs;
+
+			bool passed = imageOk && perfOk;
+			if (!passed)
+				failures++;
+			printf("%-18s %s | image %s: %s | %.2f ms (p95 %.2f), gpu %.2f ms", name.c_str(), passed ? "PASS" : "FAIL",
+				imageOk ? "ok" : "FAILED", imageStatus.c_str(), metrics.medianMs, metrics.p95Ms, metrics.gpuMs);
+			if (reference)
+				printf(", baseline %.2f / gpu %.2f ms%s", reference->medianMs, reference->gpuMs, perfOk ? "" : " SLOWER");
+			else
+				printf(", no baseline");
+			printf("\n");
+
+			if (report)
+				fprintf(report, "%s,%.3f,%.3f,%.3f,%.3f,%zu,%u,%.3f,%s\n", name.c_str(), metrics.medianMs, metrics.p95Ms, metrics.gpuMs,
+					reference ? reference->medianMs : 0.0, diff.differingPixels, diff.maxDifference, diff.meanDifference,
+					passed ? "pass" : (imageOk ? "slower" : "image"));
+		}
+	}
+
+	if (update)
+	{
+		// keep the baseline of tests that weren't run this time
+		for (size_t i = 0; i < baseline.size(); i++)
+			if (!findBaseline(measured, baseline[i].name))
+				measured.push_back(baseline[i]);
+		if (!writeBaseline(baselinePath, measured))
+			failures++;
+	}
+	if (report)
+		fclose(report);
+
+	std::cout << testCount << " tests, " << failures << " failed" << std::endl;
+
+	// optional: de-allocate all resources once they've outlived their purpose:
+	// ------------------------------------------------------------------------
+	for (int p = 0; p < 3; p++)
+		pools[p]->destroy();
+	for (int s = 0; s < 3; s++)
+		glDeleteProgram(shaders[s]->ID);
+	glDeleteTextures(4, images);
+	glDeleteQueries(1, &frameQuery);
+	glDeleteRenderbuffers(1, &colorBuffer);
+	glDeleteRenderbuffers(1, &depthBuffer);
+	glDeleteFramebuffers(1, &FBO);
+
+	// glfw: terminate, clearing all previously allocated GLFW resources.
+	// ------------------------------------------------------------------
+	glfwTerminate();
+
+	// non zero so scripts and ci notice
+	return failures > 0 ? 1 : 0;
+}
+
+// one "<name> <median ms> <gpu ms>" per line, a missing file is just an empty baseline
+std::vector<BaselineEntry> readBaseline(const std::string& path)
+{
+	std::vector<BaselineEntry> entries;
+	FILE* file = fopen(path.c_str(), "r");
+	if (!file)
+		return entries;
+	char name[128];
+	double medianMs, gpuMs;
+	while (fscanf(file, "%127s %lf %lf", name, &medianMs, &gpuMs) == 3)
+	{
+		BaselineEntry entry = { name, medianMs, gpuMs };
+		entries.push_back(entry);
+	}
+	fclose(file);
+	return entries;
+}
+
+bool writeBaseline(const std::string& path, const std::vector<BaselineEntry>& entries)
+{
+	FILE* file = fopen(path.c_str(), "w");
+	if (!file)
+	{
+		std::cout << "ERROR::REGRESSION::FILE_NOT_SUCCESFULLY_WRITTEN " << path << std::endl;
+		return false;
+	}
+	for (size_t i = 0; i < entries.size(); i++)
+		fprintf(file, "%s %.3f %.3f\n", entries[i].name.c_str(), entries[i].medianMs, entries[i].gpuMs);
+	fclose(file);
+	return true;
+}
+
+const BaselineEntry* findBaseline(const std::vector<BaselineEntry>& entries, const std::string& name)
+{
+	for (size_t i = 0; i < entries.size(); i++)
+		if (entries[i].name == name)
+			return &entries[i];
+	return NULL;
+}
+
+// gray where the images match, the largest channel difference scaled up in red where they don't
+void writeDiffImage(const std::string& path, const unsigned char* a, const unsigned char* b, int width, int height)
+{
+	std::vector<unsigned char> out((size_t)width * height * 4);
+	for (size_t i = 0; i < (size_t)width * height; i++)
+	{
+		int largest = 0;
+		for (int c = 0; c < 4; c++)
+			largest = std::max(largest, abs((int)a[i * 4 + c] - (int)b[i * 4 + c]));
+		int gray = (a[i * 4] + a[i * 4 + 1] + a[i * 4 + 2]) / 12;
+		out[i * 4 + 0] = (unsigned char)(largest > 0 ? std::min(255, 64 + largest * 4) : gray);
+		out[i * 4 + 1] = (unsigned char)gray;
+		out[i * 4 + 2] = (unsigned char)gray;
+		out[i * 4 + 3] = 255;
+	}
+	writePng(path.c_str(), width, height, 4, out.data());
+}
@@ -0,0 +1,438 @@
+#pragma once
+#ifndef RENDER_GRAPH_H
+#define RENDER_GRAPH_H
+
+#include <GLExtensions.h>
+#include <RenderTargetPool.h>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// how a pass touches a resource, several can be or'ed together. decides which barrier a later pass needs:
+// image stores and storage buffer writes are the only ones gl doesn't order by itself
+enum RenderGraphAccess
+{
+	ACCESS_RENDER_TARGET = 1 << 0,    // drawn into, cleared or blitted as a framebuffer attachment
+	ACCESS_TEXTURE = 1 << 1,          // sampled (texture buffers too)
+	ACCESS_IMAGE = 1 << 2,            // imageLoad / imageStore
+	ACCESS_STORAGE_BUFFER = 1 << 3,   // a shader storage block
+	ACCESS_INDIRECT = 1 << 4,         // indirect draw / dispatch commands
+	ACCESS_VERTEX = 1 << 5,           // vertex attributes
+	ACCESS_BUFFER_TRANSFER = 1 << 6   // glBufferSubData / glGetBufferSubData / mapping
+};
+
+// A frame as a list of passes that say what they read and write, instead of straight code.
+//
+// the graph is built again every frame: reset(), the resources and passes, output() for what the frame is for,
+// then compile() and execute(). a pass only runs if an output depends on it (or it has a side effect), so
+// everything behind a switched off feature is left out without an if around it. the passes run in the order
+// they were added unless a dependency says otherwise.
+//
+// every write makes a new version of the resource: write() returns the handle later readers use, and the
+// writing pass depends on the one that made the version it writes over (a write keeps what was there, like
+// blending onto it). two passes may write over the same version only if at most one of them survives the culling,
+// that's how alternatives are expressed: both branch off the same version and the output picks one.
+//
+// transient targets come out of the RenderTargetPool right before the first pass that uses them and go back
+// after the last one, so the pool can alias them. before every pass the graph puts in the glMemoryBarrier its
+// accesses need after earlier image stores and storage buffer writes, also ones from the frame before
+class RenderGraph
+{
+public:
+	typedef std::function<void()> Execute;
+
+	// declares what one pass reads and writes, handed out by addPass()
+	class PassBuilder
+	{
+	public:
+		PassBuilder(RenderGraph& graph, int pass) : graph(graph), pass(pass) {}
+
+		PassBuilder& read(int handle, unsigned int access)
+		{
+			graph.passes[pass].reads.push_back(Use(handle, access));
+			return *this;
+		}
+
+		// returns the new version of the resource
+		int write(int handle, unsigned int access)
+		{
+			Version version = { graph.versions[handle].resource, pass, handle };
+			graph.versions.push_back(version);
+			int written = (int)graph.versions.size() - 1;
+			graph.passes[pass].writes.push_back(Use(written, access));
+			return written;
+		}
+
+		// runs even when nothing reads what it writes (readbacks, things kept for the next frame)
+		PassBuilder& sideEffect()
+		{
+			graph.passes[pass].sideEffect = true;
+			return *this;
+		}
+
+	private:
+		RenderGraph& graph;
+		int pass;
+	};
+
+	RenderGraph(RenderTargetPool& pool) : pool(pool) {}
+
+	// ---- building, every frame
+	void reset()
+	{
+		resources.clear();
+		versions.clear();
+		passes.clear();
+		order.clear();
+		outputs.clear();
+	}
+
+	// a target of the pool, only acquired if a pass that uses it runs
+	int createTarget(const char* name, const RenderTargetDesc& desc)
+	{
+		Resource resource;
+		resource.name = name;
+		resource.transient = true;
+		resource.target.desc = desc;
+		return addResource(resource);
+	}
+
+	// a target owned by someone else (framebuffer 0 for the screen)
+	int importTarget(const char* name, unsigned int texture, unsigned int framebuffer, int width, int height, GLenum internalFormat = GL_RGBA8)
+	{
+		Resource resource;
+		resource.name = name;
+		RenderTargetDesc desc = { width, height, internalFormat, 1 };
+		resource.target.desc = desc;
+		resource.target.texture = texture;
+		resource.target.framebuffer = framebuffer;
+		resource.target.textureWidth = width;
+		resource.target.textureHeight = height;
+		return addResource(resource);
+	}
+
+	int importBuffer(const char* name, unsigned int buffer)
+	{
+		Resource resource;
+		resource.name = name;
+		resource.buffer = buffer;
+		return addResource(resource);
+	}
+
+	PassBuilder addPass(const char* name, Execute execute)
+	{
+		Pass pass;
+		pass.name = name;
+		pass.execute = execute;
+		passes.push_back(pass);
+		return PassBuilder(*this, (int)passes.size() - 1);
+	}
+
+	// what the frame is for, the passes it needs and nothing else run
+	void output(int handle) { outputs.push_back(handle); }
+
+	// culls and orders the passes
+	void compile()
+	{
+		// ---- from the outputs back through whatever made each version
+		std::vector<int> stack;
+		for (size_t i = 0; i < outputs.size(); i++)
+			stack.push_back(versions[outputs[i]].writer);
+		for (size_t p = 0; p < passes.size(); p++)
+		{
+			passes[p].needed = false;
+			if (passes[p].sideEffect)
+				stack.push_back((int)p);
+		}
+		while (!stack.empty())
+		{
+			int p = stack.back();
+			stack.pop_back();
+			if (p < 0 || passes[p].needed)
+				continue;
+			passes[p].needed = true;
+			for (size_t i = 0; i < passes[p].reads.size(); i++)
+				stack.push_back(versions[passes[p].reads[i].handle].writer);
+			for (size_t i = 0; i < passes[p].writes.size(); i++)
+				stack.push_back(versions[versions[passes[p].writes[i].handle].previous].writer);
+		}
+
+		// ---- dependencies of what's left: after the writer of everything a pass reads, and after the writer and
+		// the readers of every version it writes over. a version written over twice can't be ordered
+		std::vector<std::vector<int>> readers(versions.size());
+		for (size_t p = 0; p < passes.size(); p++)
+			for (size_t i = 0; i < passes[p].reads.size() && passes[p].needed; i++)
+				readers[passes[p].reads[i].handle].push_back((int)p);
+		std::vector<std::vector<int>> dependents(passes.size());
+		std::vector<int> waitingFor(passes.size(), 0);
+		std::vector<int> overwrittenBy(versions.size(), -1);
+		culledPasses = 0;
+		for (size_t p = 0; p < passes.size(); p++)
+		{
+			if (!passes[p].needed)
+			{
+				culledPasses++;
+				continue;
+			}
+			std::vector<int> after;
+			for (size_t i = 0; i < passes[p].reads.size(); i++)
+				after.push_back(versions[passes[p].reads[i].handle].writer);
+			for (size_t i = 0; i < passes[p].writes.size(); i++)
+			{
+				int previous = versions[passes[p].writes[i].handle].previous;
+				after.push_back(versions[previous].writer);
+				after.insert(after.end(), readers[previous].begin(), readers[previous].end());
+				if (overwrittenBy[previous] >= 0 && overwrittenBy[previous] != (int)p)
+					std::cout << "ERROR::RENDER_GRAPH::WRITE_CONFLICT " << passes[overwrittenBy[previous]].name << " and "
+						<< passes[p].name << " both write over " << resources[versions[previous].resource].name << std::endl;
+				overwrittenBy[previous] = (int)p;
+			}
+			for (size_t i = 0; i < after.size(); i++)
+			{
+				int before = after[i];
+				if (before < 0 || before == (int)p || std::find(dependents[before].begin(), dependents[before].end(), (int)p) != dependents[before].end())
+					continue;
+				dependents[before].push_back((int)p);
+				waitingFor[p]++;
+			}
+		}
+
+		// ---- every time the first pass, in the order they were added, that has nothing left to wait for
+		order.clear();
+		std::vector<bool> scheduled(passes.size(), false);
+		for (size_t count = 0; count < passes.size() - culledPasses; count++)
+		{
+			int next = -1;
+			for (size_t p = 0; p < passes.size() && next < 0; p++)
+				if (passes[p].needed && !scheduled[p] && waitingFor[p] == 0)
+					next = (int)p;
+			if (next < 0)
+			{
+				std::cout << "ERROR::RENDER_GRAPH::CYCLE" << std::endl;
+				break;
+			}
+			scheduled[next] = true;
+			order.push_back(next);
+			for (size_t i = 0; i < dependents[next].size(); i++)
+				waitingFor[dependents[next][i]]--;
+		}
+
+		// ---- lifetimes of the transient targets
+		for (size_t r = 0; r < resources.size(); r++)
+			resources[r].firstUse = resources[r].lastUse = -1;
+		for (size_t n = 0; n < order.size(); n++)
+		{
+			const Pass& pass = passes[order[n]];
+			for (int rw = 0; rw < 2; rw++)
+			{
+				const std::vector<Use>& uses = rw == 0 ? pass.reads : pass.writes;
+				for (size_t i = 0; i < uses.size(); i++)
+				{
+					Resource& resource = resources[versions[uses[i].handle].resource];
+					if (resource.firstUse < 0)
+						resource.firstUse = (int)n;
+					resource.lastUse = (int)n;
+				}
+			}
+		}
+
+		// ---- a readable version for the log
+		schedule.clear();
+		for (size_t n = 0; n < order.size(); n++)
+			schedule += (n > 0 ? " -> " : "") + passes[order[n]].name;
+		if (culledPasses > 0)
+		{
+			schedule += " (culled:";
+			for (size_t p = 0; p < passes.size(); p++)
+				if (!passes[p].needed)
+					schedule += " " + passes[p].name;
+			schedule += ")";
+		}
+	}
+
+	void execute()
+	{
+		barriers = 0;
+		for (size_t n = 0; n < order.size(); n++)
+		{
+			Pass& pass = passes[order[n]];
+			for (size_t r = 0; r < resources.size(); r++)
+				if (resources[r].transient && resources[r].firstUse == (int)n)
+					resources[r].pooled = pool.acquire(resources[r].target.desc);
+
+			// ---- what earlier incoherent writes this pass has to see
+			GLbitfield needed = 0;
+			for (int rw = 0; rw < 2; rw++)
+			{
+				const std::vector<Use>& uses = rw == 0 ? pass.reads : pass.writes;
+				for (size_t i = 0; i < uses.size(); i++)
+					needed |= pendingBits(resources[versions[uses[i].handle].resource]) & barrierBits(uses[i].access);
+			}
+			if (needed != 0 && glMemoryBarrier != NULL)
+			{
+				glMemoryBarrier(needed);
+				barriers++;
+				for (size_t i = 0; i < pending.size();)
+				{
+					pending[i].bits &= ~needed;
+					if (pending[i].bits == 0)
+					{
+						pending.erase(pending.begin() + i);
+						continue;
+					}
+					i++;
+				}
+			}
+
+			pass.execute();
+
+			for (size_t i = 0; i < pass.writes.size(); i++)
+				if (pass.writes[i].access & (ACCESS_IMAGE | ACCESS_STORAGE_BUFFER))
+					markPending(resources[versions[pass.writes[i].handle].resource]);
+
+			for (size_t r = 0; r < resources.size(); r++)
+			{
+				if (resources[r].transient && resources[r].lastUse == (int)n)
+				{
+					pool.release(resources[r].pooled);
+					resources[r].pooled = NULL;
+				}
+			}
+		}
+	}
+
+	// ---- while executing
+	RenderTarget* target(int handle)
+	{
+		Resource& resource = resources[versions[handle].resource];
+		return resource.transient ? resource.pooled : &resource.target;
+	}
+
+	unsigned int buffer(int handle) const { return resources[versions[handle].resource].buffer; }
+
+	// ---- stats, of the last compile() / execute()
+	const std::string& scheduleString() const { return schedule; }
+	size_t passCount() const { return passes.size(); }
+	unsigned int culledPasses = 0;
+	unsigned int barriers = 0;
+
+private:
+	struct Use
+	{
+		int handle;
+		unsigned int access;
+		Use(int handle, unsigned int access) : handle(handle), access(access) {}
+	};
+
+	struct Resource
+	{
+		std::string name;
+		bool transient = false;
+		RenderTarget target;            // imported ones, and the desc of transient ones
+		RenderTarget* pooled = NULL;    // transient ones while they're alive
+		unsigned int buffer = 0;
+		int firstUse = -1, lastUse = -1;
+	};
+
+	struct Version
+	{
+		int resource;
+		int writer;     // -1 for what was there before the frame
+		int previous;   // the version it was written over, -1 for the first one
+	};
+
+	struct Pass
+	{
+		std::string name;
+		Execute execute;
+		std::vector<Use> reads, writes;
+		bool sideEffect = false;
+		bool needed = false;
+	};
+
+	// barrier bits not issued since the last incoherent write into a gl object. kept across frames
+	struct Pending
+	{
+		bool buffer;
+		unsigned int object;
+		GLbitfield bits;
+	};
+
+	RenderTargetPool& pool;
+	std::vector<Resource> resources;
+	std::vector<Version> versions;
+	std::vector<Pass> passes;
+	std::vector<int> order;
+	std::vector<int> outputs;
+	std::vector<Pending> pending;
+	std::string schedule;
+
+	int addResource(const Resource& resource)
+	{
+		resources.push_back(resource);
+		Version version = { (int)resources.size() - 1, -1, -1 };
+		versions.push_back(version);
+		return (int)versions.size() - 1;
+	}
+
+	// the barrier that makes incoherent writes visible to this kind of access
+	static GLbitfield barrierBits(unsigned int access)
+	{
+		GLbitfield bits = 0;
+		if (access & ACCESS_RENDER_TARGET)
+			bits |= GL_FRAMEBUFFER_BARRIER_BIT;
+		if (access & ACCESS_TEXTURE)
+			bits |= GL_TEXTURE_FETCH_BARRIER_BIT;
+		if (access & ACCESS_IMAGE)
+			bits |= GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+		if (access & ACCESS_STORAGE_BUFFER)
+			bits |= GL_SHADER_STORAGE_BARRIER_BIT;
+		if (access & ACCESS_INDIRECT)
+			bits |= GL_COMMAND_BARRIER_BIT;
+		if (access & ACCESS_VERTEX)
+			bits |= GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT;
+		if (access & ACCESS_BUFFER_TRANSFER)
+			bits |= GL_BUFFER_UPDATE_BARRIER_BIT;
+		return bits;
+	}
+
+	unsigned int objectOf(const Resource& resource, bool& isBuffer) const
+	{
+		isBuffer = resource.buffer != 0;
+		if (isBuffer)
+			return resource.buffer;
+		return resource.transient ? (resource.pooled != NULL ? resource.pooled->texture : 0) : resource.target.texture;
+	}
+
+	GLbitfield pendingBits(const Resource& resource) const
+	{
+		bool isBuffer;
+		unsigned int object = objectOf(resource, isBuffer);
+		for (size_t i = 0; i < pending.size(); i++)
+			if (pending[i].buffer == isBuffer && pending[i].object == object)
+				return pending[i].bits;
+		return 0;
+	}
+
+	void markPending(const Resource& resource)
+	{
+		bool isBuffer;
+		unsigned int object = objectOf(resource, isBuffer);
+		GLbitfield all = barrierBits(~0u);
+		for (size_t i = 0; i < pending.size(); i++)
+		{
+			if (pending[i].buffer == isBuffer && pending[i].object == object)
+			{
+				pending[i].bits = all;
+				return;
+			}
+		}
+		Pending entry = { isBuffer, object, all };
+		pending.push_back(entry);
+	}
+};
+
+#endif // !RENDER_GRAPH_H
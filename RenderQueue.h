@@ -0,0 +1,297 @@
+#pragma once
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <MeshPool.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// everything one draw needs. state is referred to by GL names, the queue turns them into small ids for the key
+struct DrawItem
+{
+	unsigned int pass = 0;          // earlier passes draw first (0..15)
+	bool translucent = false;       // drawn after the opaque ones, back to front, with blending
+	unsigned int program = 0;
+	unsigned int textures[2] = { 0, 0 };   // bound to units 0 and 1
+	unsigned int VAO = 0;
+	unsigned int positionVAO = 0;   // position only stream for depth prepasses (MeshPool::positionVAO), VAO if 0
+	MeshHandle mesh = { 0, 0, 0 };
+	glm::mat4 model = glm::mat4(1.0f);
+	float depth = 0.0f;             // 0 near .. 1 far
+};
+
+// state changes a submission order costs
+struct RenderQueueStats
+{
+	unsigned int draws = 0;
+	unsigned int programChanges = 0;
+	unsigned int textureChanges = 0;
+	unsigned int vaoChanges = 0;
+	unsigned int blendChanges = 0;
+};
+
+// Draws are collected for a frame, sorted by a 64 bit key and then submitted, binding state only when
+// it actually changes. from the top bit down the key is
+//
+//   opaque       pass:4 | 0 | program:10 | textures:12 | VAO:10 | depth:24 (front to back) | 3 unused
+//   translucent  pass:4 | 1 | depth:24 (back to front) | program:10 | textures:12 | VAO:10 | 3 unused
+//
+// so opaque draws are grouped by the most expensive state first, translucent ones are ordered for
+// correct blending first and only grouped within the same depth.
+class RenderQueue
+{
+public:
+	RenderQueueStats unsortedStats;  // what submitting in the order of add() would have cost
+	RenderQueueStats sortedStats;
+
+	void clear()
+	{
+		items.clear();
+		entries.clear();
+	}
+
+	void add(const DrawItem& item)
+	{
+		SortEntry entry;
+		entry.key = makeKey(item);
+		entry.index = (unsigned int)items.size();
+		items.push_back(item);
+		entries.push_back(entry);
+	}
+
+	size_t size() const { return items.size(); }
+
+	// LSD radix sort on the keys, 8 bits at a time. passes where every key has the same digit are skipped,
+	// which is most of them when a scene only uses a handful of programs and textures
+	void sort()
+	{
+		unsortedStats = countStateChanges();
+		sortScratch.resize(entries.size());
+		for (int shift = 0; shift < 64; shift += 8)
+		{
+			size_t counts[256] = {};
+			for (size_t i = 0; i < entries.size(); i++)
+				counts[(entries[i].key >> shift) & 0xFF]++;
+			if (entries.empty() || counts[(entries[0].key >> shift) & 0xFF] == entries.size())
+				continue;
+
+			size_t offsets[256];
+			size_t sum = 0;
+			for (int d = 0; d < 256; d++)
+			{
+				offsets[d] = sum;
+				sum += counts[d];
+			}
+			for (size_t i = 0; i < entries.size(); i++)
+				sortScratch[offsets[(entries[i].key >> shift) & 0xFF]++] = entries[i];
+			entries.swap(sortScratch);
+		}
+		sortedStats = countStateChanges();
+	}
+
+	// depth of the opaque draws only, with one program and no color writes. the program needs the same
+	// "model", "view" and "projection" uniforms and has to compute gl_Position exactly like the color
+	// programs (invariant), so submit(..., true) can draw on top of it with GL_EQUAL
+	void submitDepthPrepass(unsigned int depthProgram, const glm::mat4& view, const glm::mat4& projection)
+	{
+		glUseProgram(depthProgram);
+		glUniformMatrix4fv(glGetUniformLocation(depthProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
+		glUniformMatrix4fv(glGetUniformLocation(depthProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+		int modelLocation = modelUniform(depthProgram);
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+		unsigned int VAO = 0;
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			const DrawItem& item = items[entries[i].index];
+			if (item.translucent)
+				continue;
+			unsigned int itemVAO = item.positionVAO != 0 ? item.positionVAO : item.VAO;
+			if (itemVAO != VAO)
+			{
+				VAO = itemVAO;
+				glBindVertexArray(VAO);
+			}
+			glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(item.model));
+			glDrawElementsBaseVertex(GL_TRIANGLES, item.mesh.indexCount, GL_UNSIGNED_INT,
+				(void*)(item.mesh.firstIndex * sizeof(unsigned int)), item.mesh.baseVertex);
+		}
+
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	}
+
+	// draws everything in the current order (sorted if sort() was called). view and projection are set once
+	// on every program the first time it gets bound, the programs need "model", "view" and "projection" uniforms.
+	// after submitDepthPrepass() the opaque draws only shade the one fragment per pixel that is left (GL_EQUAL)
+	// and leave the depth buffer alone
+	void submit(const glm::mat4& view, const glm::mat4& projection, bool afterDepthPrepass = false)
+	{
+		unsigned int program = 0, VAO = 0;
+		unsigned int textures[2] = { 0, 0 };
+		bool blending = false;
+		programsSet.clear();
+		int modelLocation = -1;
+		if (afterDepthPrepass)
+		{
+			glDepthFunc(GL_EQUAL);
+			glDepthMask(GL_FALSE);
+		}
+
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			const DrawItem& item = items[entries[i].index];
+			if (item.translucent != blending)
+			{
+				blending = item.translucent;
+				if (blending)
+				{
+					glEnable(GL_BLEND);
+					glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+					glDepthMask(GL_FALSE);
+					// translucent draws never made it into the prepass
+					if (afterDepthPrepass)
+						glDepthFunc(GL_LESS);
+				}
+				else
+				{
+					glDisable(GL_BLEND);
+					glDepthMask(afterDepthPrepass ? GL_FALSE : GL_TRUE);
+					if (afterDepthPrepass)
+						glDepthFunc(GL_EQUAL);
+				}
+			}
+			if (item.program != program)
+			{
+				program = item.program;
+				glUseProgram(program);
+				modelLocation = modelUniform(program);
+				if (std::find(programsSet.begin(), programsSet.end(), program) == programsSet.end())
+				{
+					glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(view));
+					glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+					programsSet.push_back(program);
+				}
+			}
+			for (int t = 0; t < 2; t++)
+			{
+				if (item.textures[t] != textures[t])
+				{
+					textures[t] = item.textures[t];
+					glActiveTexture(GL_TEXTURE0 + t);
+					glBindTexture(GL_TEXTURE_2D, textures[t]);
+				}
+			}
+			if (item.VAO != VAO)
+			{
+				VAO = item.VAO;
+				glBindVertexArray(VAO);
+			}
+
+			glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(item.model));
+			glDrawElementsBaseVertex(GL_TRIANGLES, item.mesh.indexCount, GL_UNSIGNED_INT,
+				(void*)(item.mesh.firstIndex * sizeof(unsigned int)), item.mesh.baseVertex);
+		}
+
+		if (blending)
+			glDisable(GL_BLEND);
+		glDepthMask(GL_TRUE);
+		glDepthFunc(GL_LESS);
+	}
+
+	// walks the current order the same way submit() does and counts what would get rebound
+	RenderQueueStats countStateChanges() const
+	{
+		RenderQueueStats stats;
+		unsigned int program = 0, VAO = 0;
+		unsigned int textures[2] = { 0, 0 };
+		bool blending = false;
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			const DrawItem& item = items[entries[i].index];
+			if (item.translucent != blending)
+			{
+				blending = item.translucent;
+				stats.blendChanges++;
+			}
+			if (item.program != program)
+			{
+				program = item.program;
+				stats.programChanges++;
+			}
+			for (int t = 0; t < 2; t++)
+			{
+				if (item.textures[t] != textures[t])
+				{
+					textures[t] = item.textures[t];
+					stats.textureChanges++;
+				}
+			}
+			if (item.VAO != VAO)
+			{
+				VAO = item.VAO;
+				stats.vaoChanges++;
+			}
+			stats.draws++;
+		}
+		return stats;
+	}
+
+private:
+	struct SortEntry
+	{
+		uint64_t key;
+		unsigned int index;
+	};
+
+	std::vector<DrawItem> items;
+	std::vector<SortEntry> entries;
+	std::vector<SortEntry> sortScratch;
+
+	// GL names -> the small ids that go in the key. stays the same across frames so the keys do too
+	std::vector<unsigned int> programIds;
+	std::vector<std::pair<unsigned int, unsigned int> > textureSetIds;
+	std::vector<unsigned int> vaoIds;
+	std::vector<std::pair<unsigned int, int> > modelLocations;
+	std::vector<unsigned int> programsSet;   // programs that got view and projection this submit
+
+	template <typename T>
+	static uint64_t idOf(std::vector<T>& table, const T& value, uint64_t bits)
+	{
+		for (size_t i = 0; i < table.size(); i++)
+			if (table[i] == value)
+				return i & ((1ull << bits) - 1);
+		table.push_back(value);
+		return (table.size() - 1) & ((1ull << bits) - 1);
+	}
+
+	uint64_t makeKey(const DrawItem& item)
+	{
+		uint64_t program = idOf(programIds, item.program, 10);
+		uint64_t textureSet = idOf(textureSetIds, std::make_pair(item.textures[0], item.textures[1]), 12);
+		uint64_t vao = idOf(vaoIds, item.VAO, 10);
+		uint64_t depth = (uint64_t)(std::min(std::max(item.depth, 0.0f), 1.0f) * 16777215.0f);
+		uint64_t key = (uint64_t)(item.pass & 0xF) << 60;
+		if (!item.translucent)
+			return key | (program << 49) | (textureSet << 37) | (vao << 27) | (depth << 3);
+
+		return key | (1ull << 59) | ((16777215ull - depth) << 35) | (program << 25) | (textureSet << 13) | (vao << 3);
+	}
+
+	int modelUniform(unsigned int program)
+	{
+		for (size_t i = 0; i < modelLocations.size(); i++)
+			if (modelLocations[i].first == program)
+				return modelLocations[i].second;
+		int location = glGetUniformLocation(program, "model");
+		modelLocations.push_back(std::make_pair(program, location));
+		return location;
+	}
+};
+
+#endif // !RENDER_QUEUE_H
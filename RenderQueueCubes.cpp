@@ -0,0 +1,449 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <Shader.h>
+#include <Camera.h>
+#include <GLExtensions.h>
+#include <MeshPool.h>
+#include <RenderQueue.h>
+#include <SceneGenerator.h>
+#include <Texture.h>
+#include <FrameCapture.h>
+#include <GLTrace.h>
+#include <string>
+#include <algorithm>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+const float FAR_PLANE = 300.0f;
+
+// P switches the depth prepass, O the overdraw measurement
+bool depthPrepass = false;
+bool measureOverdraw = false;
+
+// timing
+float deltaTime = 0.0f;	// Time between current frame and last frame
+float lastFrame = 0.0f; // Time of last frame
+
+// camera
+Camera camera(glm::vec3(0.0f, 0.0f, 0.0f));
+float lastX = SCR_WIDTH / 2.0f;
+float lastY = SCR_HEIGHT / 2.0f;
+bool firstMouse = true;
+
+int main(int argc, char* argv[])
+{
+	// --unsorted submits in scene order to compare against, --headless renders into a hidden window,
+	// --frames N quits after N frames, --scene/--count/--seed pick the scene (see SceneGenerator.h),
+	// --capture <dir> saves every frame there as PNG (or as raw RGBA with --capture-raw),
+	// --trace <file> records every GL call into a trace for GLTraceReplay,
+	// --prepass starts with a depth prepass (P switches), --overdraw counts shaded fragments per pixel (O switches)
+	bool sorted = true;
+	bool headless = false;
+	int maxFrames = -1;
+	std::string captureDirectory;
+	std::string tracePath;
+	CaptureFormat captureFormat = CAPTURE_PNG;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--unsorted") == 0)
+			sorted = false;
+		else if (strcmp(argv[i], "--headless") == 0)
+			headless = true;
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+			maxFrames = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+			captureDirectory = argv[++i];
+		else if (strcmp(argv[i], "--capture-raw") == 0)
+			captureFormat = CAPTURE_RAW;
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+			tracePath = argv[++i];
+		else if (strcmp(argv[i], "--prepass") == 0)
+			depthPrepass = true;
+		else if (strcmp(argv[i], "--overdraw") == 0)
+			measureOverdraw = true;
+	}
+	SceneOptions sceneOptions;
+	sceneOptions.count = 20000;
+	parseSceneOptions(argc, argv, sceneOptions);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- GlAD, GLFW and OpenGL setup
+	// ---------------------------------------------------------
+
+	// initilize the glfw library
+	glfwInit();
+
+	// ----- Setting glfw options
+
+	// nothing here needs more than 3.3
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+	// we specify that we only want the core features of OpenGL
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	// headless runs still need a context, they just never show the window
+	if (headless)
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	// the overdraw measurement counts fragments in the stencil buffer
+	glfwWindowHint(GLFW_STENCIL_BITS, 8);
+	// -----
+
+	// creating our window and configuring it's width, height and name
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	// we tell the glfw that set our window to the current thread's context
+	glfwMakeContextCurrent(window);
+
+	// a callback to resize the window when the user resized the window
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	// for toggles that should only fire once per key press
+	glfwSetKeyCallback(window, key_callback);
+
+	if (!headless)
+	{
+		// a callback to know the mouse position and calculate the direction of the camera
+		glfwSetCursorPosCallback(window, mouse_callback);
+
+		// to get mouse scroller input
+		glfwSetScrollCallback(window, scroll_callback);
+
+		// tell GLFW to capture our mouse
+		glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	}
+
+	// GLAD initilization
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initilize GLAD" << std::endl;
+		return -1;
+	}
+	loadGLExtensions();
+
+	// before anything is created, so the trace has every object the frames use
+	if (!tracePath.empty())
+	{
+		int framebufferWidth, framebufferHeight;
+		glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+		startGLTrace(tracePath.c_str(), framebufferWidth, framebufferHeight);
+	}
+
+	// configure global opengl state
+	// -----------------------------
+	// for z buffer
+	glEnable(GL_DEPTH_TEST);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Shaders, meshes & textures
+	// ---------------------------------------------------------
+
+	// three programs, one of them translucent
+	Shader mixShader("textureShader.verts", "textureShader.frags");
+	Shader singleShader("textureShader.verts", "singleTexture.frags");
+	Shader translucentShader("textureShader.verts", "translucent.frags");
+	Shader* shaders[3] = { &mixShader, &singleShader, &translucentShader };
+	for (int s = 0; s < 3; s++)
+	{
+		shaders[s]->use();
+		shaders[s]->setInt("texture1", 0);
+		shaders[s]->setInt("texture2", 1);
+	}
+
+	// depth only, for the prepass
+	Shader depthShader("depthOnly.verts", "depthOnly.frags");
+
+	// one pool per mesh so every mesh has its own VAO
+	MeshPool cubePool(1024, 1024), prismPool(1024, 1024), spherePool(1024, 4096);
+	MeshPool* pools[3] = { &cubePool, &prismPool, &spherePool };
+	MeshHandle meshes[3] = { cubePool.add(makeCube()), prismPool.add(makePrism(6)), spherePool.add(makeSphere(8, 16)) };
+
+	// four texture sets out of four images
+	unsigned int images[4] = { loadTexture("container.jpg"), loadTexture("awesomeface.png", true), loadTexture("Image.jpg"), loadTexture("star.png", true) };
+	unsigned int textureSets[4][2] = { { images[0], images[1] }, { images[2], images[3] }, { images[1], images[0] }, { images[3], images[2] } };
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Scene
+	// ---------------------------------------------------------
+
+	// the state of every object is picked so that neighbours in the scene order rarely share it,
+	// which is the worst case for drawing in array order
+	sceneOptions.textureCount = 4;
+	std::vector<SceneObject> scene = generateScene(sceneOptions);
+	std::vector<DrawItem> drawItems(scene.size());
+	for (unsigned int i = 0; i < scene.size(); i++)
+	{
+		DrawItem& item = drawItems[i];
+		item.translucent = i % 10 == 0;
+		item.program = item.translucent ? translucentShader.ID : shaders[(i / 3) % 2]->ID;
+		item.textures[0] = textureSets[scene[i].texture][0];
+		item.textures[1] = textureSets[scene[i].texture][1];
+		item.VAO = pools[i % 3]->VAO;
+		item.positionVAO = pools[i % 3]->positionVAO;
+		item.mesh = meshes[i % 3];
+		item.model = scene[i].modelMatrix();
+	}
+	std::cout << scene.size() << " objects, " << (sorted ? "sorted" : "unsorted") << " submission, depth prepass "
+		<< (depthPrepass ? "on" : "off") << " (P switches)" << std::endl;
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- our render loop (smth like update in unity!)
+	// ---------------------------------------------------------
+
+	glm::mat4 view = glm::mat4(1.0f);
+	glm::mat4 projection = glm::mat4(1.0f);
+	RenderQueue queue;
+
+	// the capture size is fixed to the framebuffer the window started with
+	FrameCapture* capture = NULL;
+	if (!captureDirectory.empty())
+	{
+		int framebufferWidth, framebufferHeight;
+		glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+		capture = new FrameCapture(framebufferWidth, framebufferHeight, captureDirectory, captureFormat);
+	}
+
+	// gpu time of the prepass and of the color pass, read back a frame later so it doesn't stall
+	unsigned int passQueries[2][2];
+	glGenQueries(4, &passQueries[0][0]);
+	bool queriesIssued[2] = { false, false };
+	std::vector<unsigned char> stencilCounts;
+
+	double statsStart = glfwGetTime();
+	unsigned int statsFrames = 0;
+	double statsSortMs = 0.0, statsPrepassMs = 0.0, statsColorMs = 0.0;
+	int frame = 0;
+
+	while (!glfwWindowShouldClose(window) && (maxFrames < 0 || frame < maxFrames))
+	{
+		// ---- Calculating deltaTime
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// ---- input handler
+		processInput(window);
+
+		// without a mouse the camera just turns around so the depth order keeps changing
+		if (headless)
+			camera.ProcessMouseMovement(20.0f, 0.0f, true);
+
+		view = camera.GetViewMatrix();
+		projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, FAR_PLANE);
+
+		// ---- fill the queue, depth is the distance to the camera
+		queue.clear();
+		for (unsigned int i = 0; i < drawItems.size(); i++)
+		{
+			drawItems[i].depth = glm::length(scene[i].position - camera.Position) / FAR_PLANE;
+			queue.add(drawItems[i]);
+		}
+
+		auto sortStart = std::chrono::high_resolution_clock::now();
+		if (sorted)
+			queue.sort();
+		statsSortMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - sortStart).count();
+
+		// ----- Rendering stuff
+
+		// seting the clear color
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		// clear the window color buffer bit and z buffer bit (and the fragment counts)
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | (measureOverdraw ? GL_STENCIL_BUFFER_BIT : 0));
+
+		// the queries of two frames ago are done by now, or close to it
+		unsigned int* queries = passQueries[frame % 2];
+		if (queriesIssued[frame % 2])
+		{
+			GLuint64 prepassNs = 0, colorNs = 0;
+			glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &prepassNs);
+			glGetQueryObjectui64v(queries[1], GL_QUERY_RESULT, &colorNs);
+			statsPrepassMs += prepassNs / 1000000.0;
+			statsColorMs += colorNs / 1000000.0;
+		}
+
+		// ---- depth prepass: only positions and no color, so the color pass shades every pixel once
+		glBeginQuery(GL_TIME_ELAPSED, queries[0]);
+		if (depthPrepass)
+			queue.submitDepthPrepass(depthShader.ID, view, projection);
+		glEndQuery(GL_TIME_ELAPSED);
+
+		// every fragment that passes the depth test adds one to its pixel's stencil value
+		if (measureOverdraw)
+		{
+			glEnable(GL_STENCIL_TEST);
+			glStencilFunc(GL_ALWAYS, 0, 0xFF);
+			glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+		}
+		glBeginQuery(GL_TIME_ELAPSED, queries[1]);
+		queue.submit(view, projection, depthPrepass);
+		glEndQuery(GL_TIME_ELAPSED);
+		queriesIssued[frame % 2] = true;
+		if (measureOverdraw)
+			glDisable(GL_STENCIL_TEST);
+
+		// start reading this frame back before the swap, it's collected a few frames later
+		if (capture)
+			capture->capture(frame);
+
+		frame++;
+		statsFrames++;
+		if (glfwGetTime() - statsStart >= 1.0 || frame == maxFrames)
+		{
+			RenderQueueStats before = sorted ? queue.unsortedStats : queue.countStateChanges();
+			RenderQueueStats after = sorted ? queue.sortedStats : before;
+			std::cout << before.draws << " draws, state changes unsorted / sorted: program " << before.programChanges << " / " << after.programChanges
+				<< ", texture " << before.textureChanges << " / " << after.textureChanges
+				<< ", VAO " << before.vaoChanges << " / " << after.vaoChanges
+				<< ", blend " << before.blendChanges << " / " << after.blendChanges
+				<< " | sort " << statsSortMs / statsFrames << " ms, " << statsFrames << " fps" << std::endl;
+			std::cout << "depth prepass " << (depthPrepass ? "on" : "off") << ": prepass " << statsPrepassMs / statsFrames
+				<< " ms, color pass " << statsColorMs / statsFrames << " ms" << std::endl;
+
+			// reading the counts back waits for the frame, fine once a second
+			if (measureOverdraw)
+			{
+				int framebufferWidth, framebufferHeight;
+				glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+				stencilCounts.resize((size_t)framebufferWidth * framebufferHeight);
+				glPixelStorei(GL_PACK_ALIGNMENT, 1);
+				glReadPixels(0, 0, framebufferWidth, framebufferHeight, GL_STENCIL_INDEX, GL_UNSIGNED_BYTE, stencilCounts.data());
+				glPixelStorei(GL_PACK_ALIGNMENT, 4);
+				size_t fragments = 0, covered = 0;
+				unsigned int deepest = 0;
+				for (size_t p = 0; p < stencilCounts.size(); p++)
+				{
+					fragments += stencilCounts[p];
+					covered += stencilCounts[p] != 0;
+					deepest = std::max(deepest, (unsigned int)stencilCounts[p]);
+				}
+				std::cout << "overdraw: " << (covered ? (double)fragments / covered : 0.0) << " shaded fragments per covered pixel (max "
+					<< deepest << (deepest == 255 ? "+" : "") << "), " << 100.0 * covered / std::max((size_t)1, stencilCounts.size())
+					<< "% of the screen covered" << std::endl;
+			}
+			if (capture)
+				std::cout << "capture: " << capture->captured << " read back, " << capture->dropped << " dropped, "
+					<< capture->written << " written" << std::endl;
+			statsStart = glfwGetTime();
+			statsFrames = 0;
+			statsSortMs = statsPrepassMs = statsColorMs = 0.0;
+		}
+
+		traceFrameEnd();
+
+		// double buffer mechanism to render things smoothly without user seeing the acutal drawings
+		glfwSwapBuffers(window);
+		// checks if any events are created
+		glfwPollEvents();
+
+		if (capture)
+			capture->poll();
+	}
+
+	if (GLTrace.active())
+	{
+		stopGLTrace();
+		std::cout << "trace: " << GLTrace.frames << " frames, " << GLTrace.calls << " calls, " << GLTrace.bytesWritten / 1024
+			<< " KB written to " << tracePath << std::endl;
+	}
+
+	// optional: de-allocate all resources once they've outlived their purpose:
+	// ------------------------------------------------------------------------
+	for (int p = 0; p < 3; p++)
+		pools[p]->destroy();
+	for (int s = 0; s < 3; s++)
+		glDeleteProgram(shaders[s]->ID);
+	glDeleteProgram(depthShader.ID);
+	glDeleteQueries(4, &passQueries[0][0]);
+	glDeleteTextures(4, images);
+	if (capture)
+	{
+		capture->destroy();
+		std::cout << "capture: " << capture->written << " frames written to " << captureDirectory << ", " << capture->dropped << " dropped" << std::endl;
+		delete capture;
+	}
+
+	// glfw: terminate, clearing all previously allocated GLFW resources.
+	// ------------------------------------------------------------------
+	glfwTerminate();
+
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+}
+
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(RIGHT, deltaTime);
+}
+
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (key == GLFW_KEY_P && action == GLFW_PRESS)
+	{
+		depthPrepass = !depthPrepass;
+		std::cout << "depth prepass " << (depthPrepass ? "on" : "off") << std::endl;
+	}
+	if (key == GLFW_KEY_O && action == GLFW_PRESS)
+	{
+		measureOverdraw = !measureOverdraw;
+		std::cout << "overdraw measurement " << (measureOverdraw ? "on" : "off") << std::endl;
+	}
+}
+
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+	if (firstMouse) // initially set to true
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	float xoffset = xpos - lastX;
+	float yoffset = lastY - ypos; // reversed since y-coordinates range from bottom to top
+	lastX = xpos;
+	lastY = ypos;
+
+	camera.ProcessMouseMovement(xoffset, yoffset, true);
+}
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.ProcessMouseScroll(yoffset);
+}
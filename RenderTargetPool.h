@@ -0,0 +1,517 @@
+#pragma once
+#ifndef RENDER_TARGET_POOL_H
+#define RENDER_TARGET_POOL_H
+
+#include <GLExtensions.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+// what a target is made of, targets with the same description are interchangeable
+struct RenderTargetDesc
+{
+	int width, height;
+	GLenum internalFormat;
+	int samples;
+
+	bool operator==(const RenderTargetDesc& other) const
+	{
+		return width == other.width && height == other.height && internalFormat == other.internalFormat && samples == other.samples;
+	}
+};
+
+struct RenderTargetAllocation;
+
+// a texture of the asked for format and a framebuffer that has it attached (as depth for depth formats, color 0
+// otherwise). the texture can be bigger than desc when the memory is shared with a bigger target, only the
+// bottom left desc.width x desc.height is this one's: draw with that viewport and sample through uvScale()
+struct RenderTarget
+{
+	RenderTargetDesc desc;
+	unsigned int texture = 0;
+	unsigned int framebuffer = 0;
+	int textureWidth = 0, textureHeight = 0;
+
+	glm::vec2 uvScale() const { return glm::vec2((float)desc.width / textureWidth, (float)desc.height / textureHeight); }
+
+	// the pool's bookkeeping
+	RenderTargetAllocation* allocation = NULL;
+	int request = -1;
+};
+
+// the memory behind one or more targets, which never use it at the same time. the first target is the
+// storage texture itself, the others are views of it in another format of the same texel size
+struct RenderTargetAllocation
+{
+	GLenum storageFormat;
+	int width, height, samples;
+	bool viewable;   // immutable storage other formats can be views of
+	unsigned int storage = 0;
+	std::vector<std::unique_ptr<RenderTarget>> targets;
+	bool inUse = false;
+	unsigned int lastUsedFrame = 0;
+};
+
+// size in bytes of one texel, for the memory stats. only the formats the demos use
+inline int renderTargetBytesPerPixel(GLenum internalFormat)
+{
+	switch (internalFormat)
+	{
+	case GL_R8: return 1;
+	case GL_RG8: case GL_R16F: return 2;
+	case GL_RGBA8: case GL_RG16F: case GL_R32F: case GL_R11F_G11F_B10F: case GL_DEPTH24_STENCIL8: case GL_DEPTH_COMPONENT32F: return 4;
+	case GL_RGBA16F: case GL_RG32F: return 8;
+	case GL_RGBA32F: return 16;
+	default: return 4;
+	}
+}
+
+// color formats with the same view class can be views of each other's storage (ARB_texture_view), for these
+// it's the texel size. 0 for the rest, depth can't be looked at as color
+inline int renderTargetViewClass(GLenum internalFormat)
+{
+	switch (internalFormat)
+	{
+	case GL_R8: return 1;
+	case GL_RG8: case GL_R16F: return 2;
+	case GL_RGBA8: case GL_RG16F: case GL_R32F: case GL_R11F_G11F_B10F: return 4;
+	case GL_RGBA16F: case GL_RG32F: return 8;
+	case GL_RGBA32F: return 16;
+	default: return 0;
+	}
+}
+
+// Render targets handed out for a part of a frame and given back when whatever reads them is done.
+// a target that is given back is reused by the next acquire() with the same size, format and sample count,
+// in the same frame or a later one, so passes that come one after the other ping-pong between the same
+// few textures without anything being created per effect. targets nobody asked for in a while are deleted.
+//
+// with aliasing, targets whose lifetimes don't overlap also share memory when their size or format differs:
+// a smaller target goes into the bottom left of a bigger texture, and with texture views (GL 4.3) a format
+// can live in the storage of another one with the same texel size. which targets share is planned from the
+// acquire() / release() order of the last frame: biggest first, every target goes into the smallest memory
+// nothing alive at the same time is using. the next frame follows the plan as long as it asks for the same
+// targets in the same order, anything else falls back to the best fitting free memory at the time
+class RenderTargetPool
+{
+public:
+	// frames a free target survives without being used
+	unsigned int maxIdleFrames = 60;
+	// off only ever reuses a target for the exact same size, format and sample count
+	bool aliasing = true;
+
+	// a free target like desc, or a new one. stays yours until release()
+	RenderTarget* acquire(const RenderTargetDesc& desc)
+	{
+		RenderTargetAllocation* allocation = planned(desc);
+		if (allocation == NULL)
+			allocation = findFree(desc);
+		if (allocation == NULL)
+			allocation = createAllocation(desc);
+		allocation->inUse = true;
+		allocation->lastUsedFrame = frame;
+
+		RenderTarget* target = targetFor(*allocation, desc.internalFormat);
+		target->desc = desc;
+		target->request = (int)requests.size();
+		Request request = { desc, events++, -1 };
+		requests.push_back(request);
+		return target;
+	}
+
+	void release(RenderTarget* target)
+	{
+		if (target == NULL)
+			return;
+		target->allocation->inUse = false;
+		if (target->request >= 0)
+			requests[target->request].released = events++;
+		target->request = -1;
+	}
+
+	// once a frame, after the last release. plans the next frame and deletes what hasn't been used for maxIdleFrames
+	void endFrame()
+	{
+		report();
+		plan();
+
+		for (size_t i = 0; i < allocations.size();)
+		{
+			RenderTargetAllocation* allocation = allocations[i].get();
+			if (!allocation->inUse && frame - allocation->lastUsedFrame > maxIdleFrames)
+			{
+				destroyAllocation(*allocation);
+				allocations.erase(allocations.begin() + i);
+				continue;
+			}
+			i++;
+		}
+
+		// targets kept past the end of the frame aren't part of the next one's log
+		for (size_t i = 0; i < allocations.size(); i++)
+			for (size_t t = 0; t < allocations[i]->targets.size(); t++)
+				allocations[i]->targets[t]->request = -1;
+		requests.clear();
+		events = 0;
+		planCursor = 0;
+		frame++;
+	}
+
+	// textures with their own memory
+	size_t size() const { return allocations.size(); }
+
+	// bytes of every texture the pool owns right now, views don't add any
+	size_t memoryBytes() const
+	{
+		size_t bytes = 0;
+		for (size_t i = 0; i < allocations.size(); i++)
+		{
+			const RenderTargetAllocation& allocation = *allocations[i];
+			bytes += bytesOf(allocation.width, allocation.height, allocation.storageFormat, allocation.samples);
+		}
+		return bytes;
+	}
+
+	void destroy()
+	{
+		for (size_t i = 0; i < allocations.size(); i++)
+			destroyAllocation(*allocations[i]);
+		allocations.clear();
+		slotAllocations.clear();
+		plannedTargets.clear();
+	}
+
+	// ---- stats
+	unsigned int created = 0;   // textures made since the start, stays low when the reuse works
+
+	// ---- memory report of the last finished frame
+	unsigned int frameTargets = 0;   // acquire() calls
+	size_t separateBytes = 0;        // if every target had a texture of its own
+	size_t reusedBytes = 0;          // reusing only for the same size, format and samples, so before aliasing
+	size_t aliasedBytes = 0;         // what the plan needs, after aliasing
+
+private:
+	// one acquire() of this frame, the times count acquires and releases
+	struct Request
+	{
+		RenderTargetDesc desc;
+		int acquired;
+		int released;   // -1 while it's held
+	};
+
+	// memory in the plan and the lifetimes of the targets in it
+	struct Slot
+	{
+		GLenum format;
+		int width, height, samples;
+		std::vector<std::pair<int, int>> lifetimes;
+	};
+
+	struct PlannedTarget
+	{
+		RenderTargetDesc desc;
+		int slot;   // -1 for the ones held past the end of the frame
+	};
+
+	std::vector<std::unique_ptr<RenderTargetAllocation>> allocations;
+	std::vector<Request> requests;
+	int events = 0;
+	unsigned int frame = 0;
+
+	// for the next frame: what every acquire() should get, in order
+	std::vector<PlannedTarget> plannedTargets;
+	std::vector<RenderTargetAllocation*> slotAllocations;
+	size_t planCursor = 0;
+
+	static bool isDepthFormat(GLenum internalFormat)
+	{
+		return internalFormat == GL_DEPTH24_STENCIL8 || internalFormat == GL_DEPTH_COMPONENT32F
+			|| internalFormat == GL_DEPTH_COMPONENT24 || internalFormat == GL_DEPTH_COMPONENT16;
+	}
+
+	static size_t bytesOf(int width, int height, GLenum internalFormat, int samples)
+	{
+		return (size_t)width * height * renderTargetBytesPerPixel(internalFormat) * samples;
+	}
+
+	static size_t bytesOf(const RenderTargetDesc& desc) { return bytesOf(desc.width, desc.height, desc.internalFormat, desc.samples); }
+
+	static bool isViewable(GLenum internalFormat, int samples)
+	{
+		return GLCaps.textureViews && samples == 1 && renderTargetViewClass(internalFormat) != 0;
+	}
+
+	// whether a target of desc can live in memory of this format and size, without alias only if it's the same
+	bool fits(GLenum storageFormat, int width, int height, int samples, const RenderTargetDesc& desc, bool alias) const
+	{
+		if (samples != desc.samples)
+			return false;
+		if (!alias)
+			return storageFormat == desc.internalFormat && width == desc.width && height == desc.height;
+		bool formatFits = storageFormat == desc.internalFormat
+			|| (isViewable(storageFormat, samples) && renderTargetViewClass(storageFormat) == renderTargetViewClass(desc.internalFormat));
+		return formatFits && width >= desc.width && height >= desc.height;
+	}
+
+	// the next planned target like desc. targets the plan doesn't know are skipped, so one extra
+	// acquire() doesn't throw the rest of the frame off
+	RenderTargetAllocation* planned(const RenderTargetDesc& desc)
+	{
+		if (!aliasing)
+			return NULL;
+		for (size_t n = planCursor; n < plannedTargets.size(); n++)
+		{
+			if (!(plannedTargets[n].desc == desc))
+				continue;
+			planCursor = n + 1;
+			if (plannedTargets[n].slot < 0)
+				return NULL;
+			RenderTargetAllocation* allocation = slotAllocations[plannedTargets[n].slot];
+			return allocation == NULL || allocation->inUse ? NULL : allocation;
+		}
+		return NULL;
+	}
+
+	// the smallest free memory desc fits in, the same format when there's a choice
+	RenderTargetAllocation* findFree(const RenderTargetDesc& desc)
+	{
+		RenderTargetAllocation* best = NULL;
+		for (size_t i = 0; i < allocations.size(); i++)
+		{
+			RenderTargetAllocation* allocation = allocations[i].get();
+			if (allocation->inUse || !fits(allocation->storageFormat, allocation->width, allocation->height, allocation->samples, desc, aliasing))
+				continue;
+			if (best == NULL)
+			{
+				best = allocation;
+				continue;
+			}
+			size_t area = (size_t)allocation->width * allocation->height, bestArea = (size_t)best->width * best->height;
+			if (area < bestArea || (area == bestArea && allocation->storageFormat == desc.internalFormat && best->storageFormat != desc.internalFormat))
+				best = allocation;
+		}
+		return best;
+	}
+
+	// ---- planning, always with aliasing so the report has it. only followed with aliasing on
+	void plan()
+	{
+		// biggest first, ties in the order they were asked for
+		std::vector<size_t> order(requests.size());
+		for (size_t i = 0; i < order.size(); i++)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			return bytesOf(requests[a].desc) > bytesOf(requests[b].desc);
+		});
+
+		std::vector<Slot> slots;
+		plannedTargets.resize(requests.size());
+		for (size_t n = 0; n < order.size(); n++)
+		{
+			const Request& request = requests[order[n]];
+			PlannedTarget& target = plannedTargets[order[n]];
+			target.desc = request.desc;
+			target.slot = -1;
+			if (request.released < 0)
+				continue;
+
+			for (size_t s = 0; s < slots.size(); s++)
+			{
+				const Slot& slot = slots[s];
+				if (!fits(slot.format, slot.width, slot.height, slot.samples, request.desc, true) || overlaps(slot, request))
+					continue;
+				if (target.slot < 0 || slot.width * slot.height < slots[target.slot].width * slots[target.slot].height)
+					target.slot = (int)s;
+			}
+			if (target.slot < 0)
+			{
+				Slot slot = { request.desc.internalFormat, request.desc.width, request.desc.height, request.desc.samples, {} };
+				slots.push_back(slot);
+				target.slot = (int)slots.size() - 1;
+			}
+			slots[target.slot].lifetimes.push_back(std::make_pair(request.acquired, request.released));
+		}
+
+		aliasedBytes = 0;
+		for (size_t s = 0; s < slots.size(); s++)
+			aliasedBytes += bytesOf(slots[s].width, slots[s].height, slots[s].format, slots[s].samples);
+
+		// ---- the slots onto memory, what's there already where it matches
+		slotAllocations.assign(slots.size(), NULL);
+		if (!aliasing)
+			return;
+		for (size_t s = 0; s < slots.size(); s++)
+		{
+			const Slot& slot = slots[s];
+			for (size_t i = 0; i < allocations.size() && slotAllocations[s] == NULL; i++)
+			{
+				RenderTargetAllocation* allocation = allocations[i].get();
+				if (!allocation->inUse && allocation->storageFormat == slot.format && allocation->width == slot.width
+					&& allocation->height == slot.height && allocation->samples == slot.samples
+					&& std::find(slotAllocations.begin(), slotAllocations.end(), allocation) == slotAllocations.end())
+					slotAllocations[s] = allocation;
+			}
+			if (slotAllocations[s] == NULL)
+			{
+				RenderTargetDesc desc = { slot.width, slot.height, slot.format, slot.samples };
+				slotAllocations[s] = createAllocation(desc);
+			}
+			// planned memory counts as used, so it isn't deleted before the frame it's planned for
+			slotAllocations[s]->lastUsedFrame = frame;
+		}
+	}
+
+	static bool overlaps(const Slot& slot, const Request& request)
+	{
+		for (size_t i = 0; i < slot.lifetimes.size(); i++)
+			if (request.acquired < slot.lifetimes[i].second && slot.lifetimes[i].first < request.released)
+				return true;
+		return false;
+	}
+
+	// the frame's log replayed with reuse for identical targets only
+	void report()
+	{
+		frameTargets = (unsigned int)requests.size();
+		separateBytes = reusedBytes = 0;
+
+		std::vector<std::pair<int, int>> timeline;   // time, request + 1 (negative for a release)
+		for (size_t i = 0; i < requests.size(); i++)
+		{
+			separateBytes += bytesOf(requests[i].desc);
+			timeline.push_back(std::make_pair(requests[i].acquired, (int)i + 1));
+			if (requests[i].released >= 0)
+				timeline.push_back(std::make_pair(requests[i].released, -(int)i - 1));
+		}
+		std::sort(timeline.begin(), timeline.end());
+
+		// free targets per description
+		std::vector<std::pair<RenderTargetDesc, int>> free;
+		for (size_t e = 0; e < timeline.size(); e++)
+		{
+			const RenderTargetDesc& desc = requests[std::abs(timeline[e].second) - 1].desc;
+			size_t f = 0;
+			while (f < free.size() && !(free[f].first == desc))
+				f++;
+			if (timeline[e].second < 0)
+			{
+				if (f == free.size())
+					free.push_back(std::make_pair(desc, 0));
+				free[f].second++;
+			}
+			else if (f < free.size() && free[f].second > 0)
+				free[f].second--;
+			else
+				reusedBytes += bytesOf(desc);
+		}
+	}
+
+	// ---- gl objects
+	RenderTargetAllocation* createAllocation(const RenderTargetDesc& desc)
+	{
+		std::unique_ptr<RenderTargetAllocation> allocation(new RenderTargetAllocation());
+		allocation->storageFormat = desc.internalFormat;
+		allocation->width = desc.width;
+		allocation->height = desc.height;
+		allocation->samples = desc.samples;
+		allocation->viewable = isViewable(desc.internalFormat, desc.samples);
+
+		glGenTextures(1, &allocation->storage);
+		if (desc.samples > 1)
+		{
+			glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, allocation->storage);
+			glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, desc.samples, desc.internalFormat, desc.width, desc.height, GL_TRUE);
+			glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+		}
+		else
+		{
+			glBindTexture(GL_TEXTURE_2D, allocation->storage);
+			// views can only be made of immutable storage
+			if (allocation->viewable)
+				glTexStorage2D(GL_TEXTURE_2D, 1, desc.internalFormat, desc.width, desc.height);
+			else
+			{
+				// the format and type only matter for the data, and there is none
+				bool depth = isDepthFormat(desc.internalFormat);
+				GLenum format = desc.internalFormat == GL_DEPTH24_STENCIL8 ? GL_DEPTH_STENCIL : depth ? GL_DEPTH_COMPONENT : GL_RGBA;
+				GLenum type = desc.internalFormat == GL_DEPTH24_STENCIL8 ? GL_UNSIGNED_INT_24_8 : GL_FLOAT;
+				glTexImage2D(GL_TEXTURE_2D, 0, desc.internalFormat, desc.width, desc.height, 0, format, type, NULL);
+			}
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
+
+		allocations.push_back(std::move(allocation));
+		created++;
+		targetFor(*allocations.back(), desc.internalFormat);
+		return allocations.back().get();
+	}
+
+	// the target for using allocation as format, made the first time it's needed
+	RenderTarget* targetFor(RenderTargetAllocation& allocation, GLenum format)
+	{
+		for (size_t t = 0; t < allocation.targets.size(); t++)
+			if (allocation.targets[t]->desc.internalFormat == format)
+				return allocation.targets[t].get();
+
+		std::unique_ptr<RenderTarget> target(new RenderTarget());
+		RenderTargetDesc desc = { allocation.width, allocation.height, format, allocation.samples };
+		target->desc = desc;
+		target->textureWidth = allocation.width;
+		target->textureHeight = allocation.height;
+		target->allocation = &allocation;
+
+		bool depth = isDepthFormat(format);
+		GLenum textureTarget = allocation.samples > 1 ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D;
+		if (format == allocation.storageFormat)
+			target->texture = allocation.storage;
+		else
+		{
+			glGenTextures(1, &target->texture);
+			glTextureView(target->texture, GL_TEXTURE_2D, allocation.storage, format, 0, 1, 0, 1);
+		}
+		if (allocation.samples == 1)
+		{
+			glBindTexture(GL_TEXTURE_2D, target->texture);
+			// color targets get read filtered by the passes after them (upscaling, blurring), depth one to one
+			GLint filter = depth ? GL_NEAREST : GL_LINEAR;
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
+
+		glGenFramebuffers(1, &target->framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+		GLenum attachment = format == GL_DEPTH24_STENCIL8 ? GL_DEPTH_STENCIL_ATTACHMENT : depth ? GL_DEPTH_ATTACHMENT : GL_COLOR_ATTACHMENT0;
+		glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, textureTarget, target->texture, 0);
+		if (depth)
+			glDrawBuffer(GL_NONE);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			std::cout << "ERROR::RENDER_TARGET_POOL::FRAMEBUFFER_NOT_COMPLETE" << std::endl;
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+		allocation.targets.push_back(std::move(target));
+		return allocation.targets.back().get();
+	}
+
+	void destroyAllocation(RenderTargetAllocation& allocation)
+	{
+		for (size_t t = 0; t < allocation.targets.size(); t++)
+		{
+			RenderTarget& target = *allocation.targets[t];
+			glDeleteFramebuffers(1, &target.framebuffer);
+			if (target.texture != allocation.storage)
+				glDeleteTextures(1, &target.texture);
+		}
+		allocation.targets.clear();
+		glDeleteTextures(1, &allocation.storage);
+		allocation.storage = 0;
+	}
+};
+
+#endif // !RENDER_TARGET_POOL_H
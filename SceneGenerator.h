@@ -0,0 +1,202 @@
+#pragma once
+#ifndef SCENE_GENERATOR_H
+#define SCENE_GENERATOR_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+enum SceneLayout
+{
+	SCENE_UNIFORM,    // scattered evenly through a box
+	SCENE_CLUSTERED,  // dense clumps with empty space in between
+	SCENE_GRID,       // a flat square grid
+	SCENE_CITY        // city blocks of towers made of stacked cubes, with streets in between
+};
+
+// one cube of a generated scene
+struct SceneObject
+{
+	glm::vec3 position;
+	glm::vec3 rotationAxis;
+	float angle;             // degrees
+	glm::vec3 scale;
+	unsigned int texture;    // which of the demo's textures the cube uses
+
+	SceneObject(const glm::vec3& position, const glm::vec3& rotationAxis = glm::vec3(0.0f, 1.0f, 0.0f), float angle = 0.0f,
+		const glm::vec3& scale = glm::vec3(1.0f), unsigned int texture = 0)
+		: position(position), rotationAxis(rotationAxis), angle(angle), scale(scale), texture(texture)
+	{
+	}
+
+	glm::mat4 modelMatrix() const
+	{
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
+		model = glm::rotate(model, glm::radians(angle), rotationAxis);
+		return glm::scale(model, scale);
+	}
+};
+
+struct SceneOptions
+{
+	SceneLayout layout = SCENE_UNIFORM;
+	unsigned int count = 10000;
+	unsigned int seed = 1;
+	unsigned int textureCount = 2;
+};
+
+// small LCG, the same seed gives the same scene on every platform (unlike rand())
+struct SceneRandom
+{
+	unsigned int state;
+
+	SceneRandom(unsigned int seed) : state(seed * 747796405u + 2891336453u) {}
+
+	unsigned int next()
+	{
+		state = state * 1664525u + 1013904223u;
+		return state >> 8;
+	}
+
+	float next01() { return next() * (1.0f / 16777216.0f); }
+	float range(float min, float max) { return min + (max - min) * next01(); }
+	unsigned int below(unsigned int max) { return next() % max; }
+
+	glm::vec3 direction()
+	{
+		glm::vec3 d(range(-1.0f, 1.0f), range(-1.0f, 1.0f), range(-1.0f, 1.0f));
+		float length = glm::length(d);
+		return length > 0.001f ? d / length : glm::vec3(0.0f, 1.0f, 0.0f);
+	}
+};
+
+// ---------------------------------------------------------
+// --------------------------------------------------------- layouts
+// ---------------------------------------------------------
+
+inline std::vector<SceneObject> generateScene(const SceneOptions& options)
+{
+	SceneRandom random(options.seed);
+	std::vector<SceneObject> objects;
+	objects.reserve(options.count);
+	unsigned int textureCount = options.textureCount > 0 ? options.textureCount : 1;
+
+	// scenes grow with the count so the density stays about the same
+	const float spacing = 3.0f;
+	float halfSize = spacing * cbrtf((float)options.count) * 0.5f;
+
+	switch (options.layout)
+	{
+	case SCENE_UNIFORM:
+		for (unsigned int i = 0; i < options.count; i++)
+		{
+			glm::vec3 position(random.range(-halfSize, halfSize), random.range(-halfSize, halfSize), random.range(-halfSize, halfSize));
+			objects.push_back(SceneObject(position, random.direction(), random.range(0.0f, 360.0f),
+				glm::vec3(random.range(0.5f, 1.5f)), random.below(textureCount)));
+		}
+		break;
+
+	case SCENE_CLUSTERED:
+	{
+		// about a thousand cubes per cluster, spread out like a rough gaussian
+		unsigned int clusterCount = options.count / 1000 + 1;
+		float clusterRadius = spacing * 5.0f;
+		std::vector<glm::vec3> centers;
+		for (unsigned int c = 0; c < clusterCount; c++)
+			centers.push_back(glm::vec3(random.range(-halfSize, halfSize), random.range(-halfSize, halfSize), random.range(-halfSize, halfSize)) * 2.0f);
+		for (unsigned int i = 0; i < options.count; i++)
+		{
+			unsigned int cluster = random.below(clusterCount);
+			glm::vec3 offset;
+			for (int axis = 0; axis < 3; axis++)
+				offset[axis] = (random.next01() + random.next01() + random.next01() - 1.5f) * clusterRadius;
+			objects.push_back(SceneObject(centers[cluster] + offset, random.direction(), random.range(0.0f, 360.0f),
+				glm::vec3(random.range(0.5f, 1.5f)), cluster % textureCount));
+		}
+		break;
+	}
+
+	case SCENE_GRID:
+	{
+		unsigned int side = (unsigned int)ceil(sqrt((double)options.count));
+		for (unsigned int i = 0; i < options.count; i++)
+		{
+			float x = ((float)(i % side) - side / 2.0f) * 1.5f;
+			float z = ((float)(i / side) - side / 2.0f) * 1.5f;
+			objects.push_back(SceneObject(glm::vec3(x, 0.0f, z), random.direction(), random.range(0.0f, 360.0f),
+				glm::vec3(1.0f), random.below(textureCount)));
+		}
+		break;
+	}
+
+	case SCENE_CITY:
+	{
+		// blocks of 4x4 lots with two cube wide streets in between. every lot gets an axis aligned
+		// tower of stacked cubes, the blocks are laid out on a square so the city stays square too
+		const unsigned int LOTS = 4;
+		const float blockSize = LOTS + 2.0f;
+		unsigned int averageHeight = 8;
+		unsigned int blockCount = options.count / (LOTS * LOTS * averageHeight) + 1;
+		unsigned int side = (unsigned int)ceil(sqrt((double)blockCount));
+		unsigned int lot = 0;
+		while (objects.size() < options.count)
+		{
+			unsigned int block = lot / (LOTS * LOTS);
+			unsigned int inBlock = lot % (LOTS * LOTS);
+			float x = ((float)(block % side) - side / 2.0f) * blockSize + (inBlock % LOTS);
+			float z = ((float)(block / side) - side / 2.0f) * blockSize + (inBlock / LOTS);
+			unsigned int height = 1 + random.below(averageHeight * 2 - 1);
+			unsigned int texture = random.below(textureCount);
+			for (unsigned int y = 0; y < height && objects.size() < options.count; y++)
+				objects.push_back(SceneObject(glm::vec3(x, (float)y, z), glm::vec3(0.0f, 1.0f, 0.0f), 0.0f, glm::vec3(1.0f), texture));
+			lot++;
+		}
+		break;
+	}
+	}
+	return objects;
+}
+
+// ---------------------------------------------------------
+// --------------------------------------------------------- command line
+// ---------------------------------------------------------
+
+// --scene <uniform|clustered|grid|city> [--count N] [--seed N]
+// returns true when a scene was asked for, otherwise the demo keeps its own cubes
+inline bool parseSceneOptions(int argc, char* argv[], SceneOptions& options)
+{
+	bool sceneRequested = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--scene") == 0 && i + 1 < argc)
+		{
+			const char* layout = argv[++i];
+			sceneRequested = true;
+			if (strcmp(layout, "uniform") == 0)
+				options.layout = SCENE_UNIFORM;
+			else if (strcmp(layout, "clustered") == 0)
+				options.layout = SCENE_CLUSTERED;
+			else if (strcmp(layout, "grid") == 0)
+				options.layout = SCENE_GRID;
+			else if (strcmp(layout, "city") == 0)
+				options.layout = SCENE_CITY;
+			else
+			{
+				std::cout << "ERROR::SCENE::UNKNOWN_LAYOUT " << layout << " (uniform, clustered, grid or city)" << std::endl;
+				sceneRequested = false;
+			}
+		}
+		else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+			options.count = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+			options.seed = (unsigned int)atoi(argv[++i]);
+	}
+	return sceneRequested;
+}
+
+#endif // !SCENE_GENERATOR_H
@@ -0,0 +1,174 @@
+#pragma once
+#ifndef SCENE_GRAPH_H
+#define SCENE_GRAPH_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <vector>
+
+// a node's transform relative to its parent, the local matrix is translate * rotate * scale
+struct LocalTransform
+{
+	glm::vec3 position = glm::vec3(0.0f);
+	glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	glm::vec3 scale = glm::vec3(1.0f);
+};
+
+// one contiguous [first, last) range of world matrices that changed in the last update
+struct NodeRange
+{
+	unsigned int first;
+	unsigned int last;
+};
+
+// Parent/child transform hierarchy kept in depth first order: a node's whole subtree is the
+// contiguous range right after it, and a parent always comes before its children. so a subtree
+// is recomputed with one linear pass where every node only looks back at its parent's world matrix.
+//
+// changing a node marks it dirty. update() only walks the subtrees of dirty nodes, a scene where
+// nothing moved costs nothing. nodes are referred to by ids that stay valid when nodes get inserted,
+// the arrays themselves are indexed in depth first order (see indexOf()).
+class SceneGraph
+{
+public:
+	// -1 as a parent adds a new root
+	unsigned int addNode(int parentId, const LocalTransform& transform = LocalTransform())
+	{
+		// a new node goes at the end of its parent's subtree, so everything after it moves up by one
+		unsigned int index = (unsigned int)parent.size();
+		int parentIndex = -1;
+		if (parentId >= 0)
+		{
+			parentIndex = (int)indices[parentId];
+			index = parentIndex + subtreeSize[parentIndex];
+			for (int p = parentIndex; p >= 0; p = parent[p])
+				subtreeSize[p]++;
+		}
+		for (unsigned int i = index; i < parent.size(); i++)
+			if (parent[i] >= (int)index)
+				parent[i]++;
+
+		unsigned int id = (unsigned int)indices.size();
+		parent.insert(parent.begin() + index, parentIndex);
+		subtreeSize.insert(subtreeSize.begin() + index, 1u);
+		local.insert(local.begin() + index, transform);
+		world.insert(world.begin() + index, glm::mat4(1.0f));
+		ids.insert(ids.begin() + index, id);
+		indices.push_back(index);
+		for (unsigned int i = index + 1; i < ids.size(); i++)
+			indices[ids[i]] = i;
+
+		// everything after the insert moved, so the next update redoes and reports the whole scene.
+		// adding nodes is meant for load time, not every frame
+		structureChanged = true;
+		return id;
+	}
+
+	const LocalTransform& getLocal(unsigned int id) const { return local[indices[id]]; }
+
+	void setLocal(unsigned int id, const LocalTransform& transform)
+	{
+		local[indices[id]] = transform;
+		markDirty(indices[id]);
+	}
+
+	void setPosition(unsigned int id, const glm::vec3& position)
+	{
+		local[indices[id]].position = position;
+		markDirty(indices[id]);
+	}
+
+	void setRotation(unsigned int id, const glm::quat& rotation)
+	{
+		local[indices[id]].rotation = rotation;
+		markDirty(indices[id]);
+	}
+
+	void setScale(unsigned int id, const glm::vec3& scale)
+	{
+		local[indices[id]].scale = scale;
+		markDirty(indices[id]);
+	}
+
+	// recomputes the world matrices of every dirty subtree. returns how many nodes were recomputed
+	unsigned int update()
+	{
+		updatedRanges.clear();
+		if (structureChanged)
+		{
+			dirty.clear();
+			for (unsigned int i = 0; i < parent.size(); i += subtreeSize[i])
+				dirty.push_back(i);
+			structureChanged = false;
+		}
+		if (dirty.empty())
+			return 0;
+
+		// in depth first order a dirty node either starts a new range or lies inside the last one
+		std::sort(dirty.begin(), dirty.end());
+		unsigned int updated = 0;
+		for (unsigned int i = 0; i < dirty.size(); i++)
+		{
+			unsigned int first = dirty[i];
+			unsigned int last = first + subtreeSize[first];
+			if (!updatedRanges.empty() && first < updatedRanges.back().last)
+				continue;
+
+			for (unsigned int n = first; n < last; n++)
+			{
+				glm::mat4 model = glm::translate(glm::mat4(1.0f), local[n].position);
+				model = model * glm::mat4_cast(local[n].rotation);
+				model = glm::scale(model, local[n].scale);
+				world[n] = parent[n] < 0 ? model : world[parent[n]] * model;
+			}
+			updated += last - first;
+			if (!updatedRanges.empty() && updatedRanges.back().last == first)
+				updatedRanges.back().last = last;
+			else
+				updatedRanges.push_back({ first, last });
+		}
+		dirty.clear();
+		sceneVersion++;
+		return updated;
+	}
+
+	const glm::mat4& getWorld(unsigned int id) const { return world[indices[id]]; }
+
+	// world matrices in depth first order, ready to be uploaded as they are
+	const std::vector<glm::mat4>& worldMatrices() const { return world; }
+
+	// ranges of worldMatrices() that update() changed, upload only these
+	const std::vector<NodeRange>& changedRanges() const { return updatedRanges; }
+
+	// goes up every time update() changes something. a renderer that remembers the version it last drew
+	// can skip frames where nothing moved
+	unsigned int version() const { return sceneVersion; }
+
+	unsigned int indexOf(unsigned int id) const { return indices[id]; }
+	unsigned int size() const { return (unsigned int)parent.size(); }
+
+private:
+	// all of these are in depth first order
+	std::vector<int> parent;                 // index of the parent, -1 for roots
+	std::vector<unsigned int> subtreeSize;   // the node itself and all of its descendants
+	std::vector<LocalTransform> local;
+	std::vector<glm::mat4> world;
+	std::vector<unsigned int> ids;           // node id at each index
+
+	std::vector<unsigned int> indices;       // index of each node id
+	std::vector<unsigned int> dirty;         // indices of the nodes changed since the last update
+	std::vector<NodeRange> updatedRanges;
+	bool structureChanged = false;
+	unsigned int sceneVersion = 0;
+
+	void markDirty(unsigned int index)
+	{
+		if (!structureChanged)
+			dirty.push_back(index);
+	}
+};
+
+#endif // !SCENE_GRAPH_H
@@ -3,6 +3,7 @@
 #define SHADER_H
 
 #include<glad/glad.h>
+#include<glm/glm.hpp>
 
 #include<string>
 #include<fstream>
@@ -15,8 +16,9 @@ public:
 	// program id
 	unsigned int ID;
 
-	// shader
-	Shader(const char* vertexPath, const char* fragmentPath)
+	// shader. defines (lines like "#define FXAA\n") go in right after the #version line of both files,
+	// for compiling permutations of one source
+	Shader(const char* vertexPath, const char* fragmentPath, const std::string& defines = std::string())
 	{
 		// -------------------------------------
 		// open shader files and find their code
@@ -49,6 +51,11 @@ public:
 		{
 			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
 		}
+		if (!defines.empty())
+		{
+			vertexCode.insert(vertexCode.find('\n') + 1, defines);
+			fragmentCode.insert(fragmentCode.find('\n') + 1, defines);
+		}
 		const char* vShaderCode = vertexCode.c_str();
 		const char* fShaderCode = fragmentCode.c_str();
 		
@@ -115,6 +122,10 @@ public:
 	{
 		glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
 	}
+	void setUint(const std::string& name, unsigned int value) const
+	{
+		glUniform1ui(glGetUniformLocation(ID, name.c_str()), value);
+	}
 	void setFloat(const std::string& name, float value) const
 	{
 		glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
@@ -161,6 +172,10 @@ public:
 	{
 		glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
 	}
+
+protected:
+	// for ComputeShader, which builds the program itself
+	Shader() : ID(0) {}
 };
 
 #endif // !SHADER_H
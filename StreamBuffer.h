@@ -0,0 +1,176 @@
+#pragma once
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <GLExtensions.h>
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+
+// how many frames the cpu is allowed to run ahead of the gpu
+const int STREAM_BUFFER_FRAMES = 3;
+
+// Ring allocator for data that changes every frame (instance transforms and such).
+// On GL 4.4+ the buffer is mapped once with GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT and split
+// into STREAM_BUFFER_FRAMES regions, each guarded by a fence, so writing never waits on a buffer the
+// gpu is still reading. On GL 3.3 it falls back to orphaning the buffer every frame instead.
+//
+// usage per frame: beginFrame(), allocate() as many times as needed, flush(), draw using the returned offsets, endFrame()
+class StreamBuffer
+{
+public:
+	struct Allocation
+	{
+		void* ptr;
+		GLintptr offset; // offset into the buffer object, to use with glVertexAttribPointer / glBindBufferRange
+	};
+
+	// buffer object id
+	unsigned int ID;
+	GLenum target;
+
+	// ----- stats of the last finished frame
+	size_t lastFrameBytes = 0;     // bytes written through allocate()
+	double lastFenceWaitMs = 0.0;  // time beginFrame() spent waiting on the gpu
+
+	StreamBuffer(GLenum bufferTarget, size_t bytesPerFrame, bool allowPersistent = true)
+		: target(bufferTarget)
+	{
+		// regions start on a 256 byte boundary so aligned allocations stay aligned in the whole buffer
+		// (covers the uniform and storage buffer offset alignment of every driver we care about)
+		frameSize = (bytesPerFrame + 255) / 256 * 256;
+
+		persistent = allowPersistent && GLCaps.bufferStorage;
+
+		glGenBuffers(1, &ID);
+		glBindBuffer(target, ID);
+		if (persistent)
+		{
+			GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glBufferStorage(target, frameSize * STREAM_BUFFER_FRAMES, NULL, flags);
+			mapped = (char*)glMapBufferRange(target, 0, frameSize * STREAM_BUFFER_FRAMES, flags);
+			if (mapped == NULL)
+			{
+				std::cout << "ERROR::STREAM_BUFFER::PERSISTENT_MAP_FAILED, falling back to orphaning" << std::endl;
+				// immutable storage can't be respecified, so start over with a mutable buffer
+				glDeleteBuffers(1, &ID);
+				glGenBuffers(1, &ID);
+				glBindBuffer(target, ID);
+				persistent = false;
+			}
+		}
+		if (!persistent)
+			glBufferData(target, frameSize, NULL, GL_STREAM_DRAW);
+
+		for (int i = 0; i < STREAM_BUFFER_FRAMES; i++)
+			fences[i] = 0;
+	}
+
+	// frees the gl objects, call before the context goes away
+	void destroy()
+	{
+		for (int i = 0; i < STREAM_BUFFER_FRAMES; i++)
+			if (fences[i])
+				glDeleteSync(fences[i]);
+		glBindBuffer(target, ID);
+		if (persistent || current != NULL)
+			glUnmapBuffer(target);
+		glDeleteBuffers(1, &ID);
+		mapped = current = NULL;
+		persistent = false;
+	}
+
+	bool isPersistent() const { return persistent; }
+	size_t capacity() const { return frameSize; }
+
+	// waits (if it has to) until the region for this frame is free and makes it writable
+	void beginFrame()
+	{
+		frameBytes = 0;
+		frameWaitMs = 0.0;
+
+		if (persistent)
+		{
+			GLsync& fence = fences[region];
+			if (fence)
+			{
+				auto start = std::chrono::high_resolution_clock::now();
+				GLbitfield waitFlags = 0;
+				while (true)
+				{
+					GLenum result = glClientWaitSync(fence, waitFlags, 1000000); // 1ms
+					if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+						break;
+					// make sure the fence actually gets to the gpu before we wait on it again
+					waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+				}
+				frameWaitMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+				glDeleteSync(fence);
+				fence = 0;
+			}
+			current = mapped + region * frameSize;
+		}
+		else
+		{
+			// orphaning: hand the old storage to the driver and get a fresh block, no sync needed
+			glBindBuffer(target, ID);
+			glBufferData(target, frameSize, NULL, GL_STREAM_DRAW);
+			current = (char*)glMapBufferRange(target, 0, frameSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		}
+	}
+
+	// sub-allocates bytes from this frame's region. returns a null ptr if the region is full
+	Allocation allocate(size_t bytes, size_t alignment = 16)
+	{
+		size_t start = (frameBytes + alignment - 1) / alignment * alignment;
+		if (current == NULL || start + bytes > frameSize)
+		{
+			std::cout << "ERROR::STREAM_BUFFER::OUT_OF_SPACE (" << start + bytes << " > " << frameSize << " bytes)" << std::endl;
+			return { NULL, 0 };
+		}
+		frameBytes = start + bytes;
+		Allocation a;
+		a.ptr = current + start;
+		a.offset = (GLintptr)(regionOffset() + start);
+		return a;
+	}
+
+	// call after writing and before drawing. the persistent mapping is coherent so this only matters for the fallback
+	void flush()
+	{
+		if (!persistent && current != NULL)
+		{
+			glBindBuffer(target, ID);
+			glUnmapBuffer(target);
+		}
+		current = NULL;
+	}
+
+	// call after the last draw that reads from this frame's region
+	void endFrame()
+	{
+		flush();
+		if (persistent)
+		{
+			fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			region = (region + 1) % STREAM_BUFFER_FRAMES;
+		}
+		lastFrameBytes = frameBytes;
+		lastFenceWaitMs = frameWaitMs;
+	}
+
+private:
+	size_t frameSize;
+	bool persistent;
+	char* mapped = NULL;   // whole persistent mapping
+	char* current = NULL;  // start of the region being written this frame
+	int region = 0;
+	GLsync fences[STREAM_BUFFER_FRAMES];
+	size_t frameBytes = 0;
+	double frameWaitMs = 0.0;
+
+	size_t regionOffset() const { return persistent ? region * frameSize : 0; }
+};
+
+#endif // !STREAM_BUFFER_H
@@ -0,0 +1,422 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <Shader.h>
+#include <stb_image.h>
+#include <Camera.h>
+#include <GLExtensions.h>
+#include <StreamBuffer.h>
+#include <SceneGenerator.h>
+#include <FixedTimestep.h>
+#include <cmath>
+#include <cstdlib>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// the cubes are laid out on a CUBE_GRID x CUBE_GRID floor and every one of them spins, so all the
+// model matrices have to be streamed to the gpu again each frame
+const unsigned int CUBE_GRID = 100;
+const unsigned int NUM_CUBES = CUBE_GRID * CUBE_GRID;
+
+// timing, deltaTime is the fixed simulation step now, not the frame time
+float deltaTime = 0.0f;
+
+// camera
+Camera camera(glm::vec3(0.0f, 5.0f, 20.0f));
+float lastX = SCR_WIDTH / 2.0f;
+float lastY = SCR_HEIGHT / 2.0f;
+bool firstMouse = true;
+
+int main(int argc, char* argv[])
+{
+	// --orphan forces the GL 3.3 path even when persistent mapping is available,
+	// --scene <layout> spins a generated scene instead of the grid (see SceneGenerator.h),
+	// --hz N runs the simulation N times a second (60 by default) however fast it renders
+	bool forceOrphaning = false;
+	double simulationHz = 60.0;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--orphan") == 0)
+			forceOrphaning = true;
+		else if (strcmp(argv[i], "--hz") == 0 && i + 1 < argc)
+		{
+			// a rate of 0, below 0 or not a number would make the step infinite or negative
+			simulationHz = atof(argv[++i]);
+			if (!(simulationHz > 0.0 && simulationHz <= 10000.0))
+			{
+				std::cout << "ERROR::ARGS::INVALID_HZ " << argv[i] << ", using 60" << std::endl;
+				simulationHz = 60.0;
+			}
+		}
+	}
+
+	SceneOptions sceneOptions;
+	std::vector<SceneObject> cubes;
+	if (parseSceneOptions(argc, argv, sceneOptions))
+		cubes = generateScene(sceneOptions);
+	else
+		for (unsigned int i = 0; i < NUM_CUBES; i++)
+		{
+			float x = (float)(i % CUBE_GRID) - CUBE_GRID / 2.0f;
+			float z = (float)(i / CUBE_GRID) - CUBE_GRID / 2.0f;
+			cubes.push_back(SceneObject(glm::vec3(x * 1.5f, 0.0f, z * 1.5f), glm::vec3(0.5f, 1.0f, 0.0f), glm::degrees(i * 0.1f)));
+		}
+	unsigned int numCubes = (unsigned int)cubes.size();
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- GlAD, GLFW and OpenGL setup
+	// ---------------------------------------------------------
+
+	// initilize the glfw library
+	glfwInit();
+
+	// ----- Setting glfw options
+
+	// ask for 4.5 so we get persistent mapping, and drop back to 3.3 if the driver can't do it
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+
+	// we specify that we only want the core features of OpenGL
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	// -----
+
+	// creating our window and configuring it's width, height and name
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+	}
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	// we tell the glfw that set our window to the current thread's context
+	glfwMakeContextCurrent(window);
+
+	// a callback to resize the window when the user resized the window
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	// a callback to know the mouse position and calculate the direction of the camera
+	glfwSetCursorPosCallback(window, mouse_callback);
+
+	// to get mouse scroller input
+	glfwSetScrollCallback(window, scroll_callback);
+
+	// tell GLFW to capture our mouse
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	// GLAD initilization
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initilize GLAD" << std::endl;
+		return -1;
+	}
+	loadGLExtensions();
+
+	// configure global opengl state
+	// -----------------------------
+	// for z buffer
+	glEnable(GL_DEPTH_TEST);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- VBO, VAO & instance buffer
+	// ---------------------------------------------------------
+
+	// loading the shader
+	Shader ourShader("instancedShader.verts", "textureShader.frags");
+
+	// cube with texture
+	float vertices[] = {
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+	};
+
+	unsigned int VBO, VAO;
+	glGenBuffers(1, &VBO);
+	glGenVertexArrays(1, &VAO);
+
+	glBindVertexArray(VAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+	// for positions
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	// for texture coords
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+
+	// per instance model matrices. a mat4 attribute is 4 vec4 attributes, one per column,
+	// and the actual offset gets pointed at every frame once we know where this frame's data is
+	StreamBuffer instanceBuffer(GL_ARRAY_BUFFER, numCubes * sizeof(glm::mat4), !forceOrphaning);
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		glEnableVertexAttribArray(2 + i);
+		glVertexAttribDivisor(2 + i, 1);
+	}
+	std::cout << "instance data: " << (instanceBuffer.isPersistent() ? "persistent mapped ring" : "orphaned buffer") << std::endl;
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Texture
+	// ---------------------------------------------------------
+
+	unsigned int texture1;
+	glGenTextures(1, &texture1);
+	glBindTexture(GL_TEXTURE_2D, texture1);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int width1, height1, nrChannels1;
+	unsigned char* data1 = stbi_load("container.jpg", &width1, &height1, &nrChannels1, 0);
+	if (data1)
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width1, height1, 0, GL_RGB, GL_UNSIGNED_BYTE, data1);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else
+	{
+		std::cout << "Failed to load texture1" << std::endl;
+	}
+	stbi_image_free(data1);
+
+	unsigned int texture2;
+	glGenTextures(1, &texture2);
+	glBindTexture(GL_TEXTURE_2D, texture2);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int width2, height2, nrChannels2;
+	stbi_set_flip_vertically_on_load(true);
+	unsigned char* data2 = stbi_load("awesomeface.png", &width2, &height2, &nrChannels2, 0);
+	if (data2)
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width2, height2, 0, GL_RGBA, GL_UNSIGNED_BYTE, data2);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else
+	{
+		std::cout << "Failed to load texture2" << std::endl;
+	}
+	stbi_image_free(data2);
+
+	ourShader.use(); // don't forget to activate the shader before setting uniforms!
+	ourShader.setInt("texture1", 0);
+	ourShader.setInt("texture2", 1);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- our render loop (smth like update in unity!)
+	// ---------------------------------------------------------
+
+	glm::mat4 view = glm::mat4(1.0f);
+	glm::mat4 projection = glm::mat4(1.0f);
+
+	// stats are averaged and printed once a second
+	double statsStart = glfwGetTime();
+	unsigned int statsFrames = 0;
+	size_t statsBytes = 0;
+	double statsWaitMs = 0.0;
+
+	FixedTimestep timestep(1.0 / simulationHz);
+	glm::vec3 previousCameraPosition = camera.Position;
+
+	while (!glfwWindowShouldClose(window))
+	{
+		// ---- simulation, input moves the camera in fixed steps so its speed doesn't depend on the frame rate
+		unsigned int steps = timestep.advance(glfwGetTime());
+		deltaTime = timestep.stepSeconds();
+		for (unsigned int s = 0; s < steps; s++)
+		{
+			previousCameraPosition = camera.Position;
+			processInput(window);
+		}
+
+		// ---- the frame shows the scene between the last two steps. the spin only needs the angle so the
+		// double time is wrapped before it becomes a float, it stays as precise after days as in the first second
+		float alpha = timestep.alpha();
+		Camera renderCamera = camera;
+		renderCamera.Position = interpolate(previousCameraPosition, camera.Position, alpha);
+		float spin = (float)fmod(timestep.renderTime(), 2.0 * glm::pi<double>());
+
+		// ---- write this frame's model matrices straight into the mapped buffer
+		instanceBuffer.beginFrame();
+		StreamBuffer::Allocation models = instanceBuffer.allocate(numCubes * sizeof(glm::mat4));
+		if (models.ptr != NULL)
+		{
+			glm::mat4* out = (glm::mat4*)models.ptr;
+			for (unsigned int i = 0; i < numCubes; i++)
+			{
+				glm::mat4 model = glm::mat4(1.0f);
+				model = glm::translate(model, cubes[i].position);
+				model = glm::rotate(model, spin + glm::radians(cubes[i].angle), cubes[i].rotationAxis);
+				out[i] = glm::scale(model, cubes[i].scale);
+			}
+		}
+		instanceBuffer.flush();
+
+		// ----- Rendering stuff
+
+		// seting the clear color
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		// clear the window color buffer bit and z buffer bit
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture1);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, texture2);
+
+		ourShader.use();
+		view = renderCamera.GetViewMatrix();
+		projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 300.0f);
+		ourShader.setMat4("view", view);
+		ourShader.setMat4("projection", projection);
+
+		glBindVertexArray(VAO);
+		if (models.ptr != NULL)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer.ID);
+			for (unsigned int i = 0; i < 4; i++)
+				glVertexAttribPointer(2 + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(models.offset + i * sizeof(glm::vec4)));
+			glDrawArraysInstanced(GL_TRIANGLES, 0, 36, numCubes);
+		}
+
+		// fence the region we just drew from so we don't overwrite it while the gpu still reads it
+		instanceBuffer.endFrame();
+
+		statsFrames++;
+		statsBytes += instanceBuffer.lastFrameBytes;
+		statsWaitMs += instanceBuffer.lastFenceWaitMs;
+		if (glfwGetTime() - statsStart >= 1.0)
+		{
+			std::cout << "streamed " << statsBytes / statsFrames / 1024 << " KB/frame, fence wait "
+				<< statsWaitMs / statsFrames << " ms/frame, " << statsFrames << " fps" << std::endl;
+			statsStart = glfwGetTime();
+			statsFrames = 0;
+			statsBytes = 0;
+			statsWaitMs = 0.0;
+		}
+
+		// double buffer mechanism to render things smoothly without user seeing the acutal drawings
+		glfwSwapBuffers(window);
+		// checks if any events are created
+		glfwPollEvents();
+	}
+
+	// optional: de-allocate all resources once they've outlived their purpose:
+	// ------------------------------------------------------------------------
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	instanceBuffer.destroy();
+
+	// glfw: terminate, clearing all previously allocated GLFW resources.
+	// ------------------------------------------------------------------
+	glfwTerminate();
+
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+}
+
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(RIGHT, deltaTime);
+}
+
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+	if (firstMouse) // initially set to true
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	float xoffset = xpos - lastX;
+	float yoffset = lastY - ypos; // reversed since y-coordinates range from bottom to top
+	lastX = xpos;
+	lastY = ypos;
+
+	camera.ProcessMouseMovement(xoffset, yoffset, true);
+}
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.ProcessMouseScroll(yoffset);
+}
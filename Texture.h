@@ -0,0 +1,86 @@
+#pragma once
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// pixels of a decoded image, waiting to be uploaded
+struct TextureImage
+{
+	unsigned char* data = nullptr;
+	int width = 0;
+	int height = 0;
+	int channels = 0;
+};
+
+// reads and decodes an image file without touching GL, so it can run on any thread.
+// data stays nullptr when the file can't be loaded
+inline TextureImage decodeTexture(const char* path, bool flipVertically = false)
+{
+	// stbi_set_flip_vertically_on_load is global, flipping here keeps this safe to call from several threads
+	TextureImage image;
+	image.data = stbi_load(path, &image.width, &image.height, &image.channels, 0);
+	if (!image.data)
+	{
+		std::cout << "ERROR::TEXTURE::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+		return image;
+	}
+
+	if (flipVertically)
+	{
+		size_t rowSize = (size_t)image.width * image.channels;
+		std::vector<unsigned char> row(rowSize);
+		for (int y = 0; y < image.height / 2; y++)
+		{
+			unsigned char* top = image.data + y * rowSize;
+			unsigned char* bottom = image.data + (image.height - 1 - y) * rowSize;
+			memcpy(row.data(), top, rowSize);
+			memcpy(top, bottom, rowSize);
+			memcpy(bottom, row.data(), rowSize);
+		}
+	}
+	return image;
+}
+
+// uploads into a new mipmapped 2D texture, picking the format from the channel count, and frees the pixels.
+// returns 0 for an image that failed to decode
+inline unsigned int uploadTexture(TextureImage& image)
+{
+	if (!image.data)
+		return 0;
+
+	GLenum format = image.channels == 1 ? GL_RED : (image.channels == 4 ? GL_RGBA : GL_RGB);
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// rows of 3 channel images aren't 4 byte aligned
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.data);
+	glGenerateMipmap(GL_TEXTURE_2D);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	stbi_image_free(image.data);
+	image.data = nullptr;
+	return texture;
+}
+
+// decode and upload in one go, for loading on the GL thread
+inline unsigned int loadTexture(const char* path, bool flipVertically = false)
+{
+	TextureImage image = decodeTexture(path, flipVertically);
+	return uploadTexture(image);
+}
+
+#endif // !TEXTURE_H
@@ -1,14 +1,17 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <cstring>
 #include <Windows.h>
 #include <Shader.h>
 #include <stb_image.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <SceneGraph.h>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void window_refresh_callback(GLFWwindow* window);
 void processInput(GLFWwindow* window);
 
 // settings
@@ -17,15 +20,25 @@ const unsigned int SCR_HEIGHT = 600;
 
 bool inputing = false;
 bool resetShape = false;
-glm::mat4 transByInput = glm::mat4(1.0f);
-glm::mat4 scaleByInput = glm::mat4(1.0f);
-glm::mat4 rotateByInput = glm::mat4(1.0f);
+// input gathered this frame, applied to the shape's node in the scene graph
+glm::vec3 moveByInput = glm::vec3(0.0f);
+float scaleByInput = 1.0f;
+float rotateByInput = 0.0f;
 const float translateForce = 0.005f;
 const float scaleForce = 0.005f;
 const float rotateForce = 1.0f;
 
-int main()
+// set when the window needs a redraw even though the scene didn't change (resized, uncovered)
+bool windowDirty = true;
+
+int main(int argc, char* argv[])
 {
+	// the window only gets redrawn when something changed, --continuous redraws every frame like before
+	bool continuous = false;
+	for (int i = 1; i < argc; i++)
+		if (strcmp(argv[i], "--continuous") == 0)
+			continuous = true;
+
 	// ---------------------------------------------------------
 	// --------------------------------------------------------- GlAD, GLFW and OpenGL setup
 	// ---------------------------------------------------------
@@ -58,6 +71,9 @@ int main()
 	// a callback to resize the window when the user resized the window
 	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
+	// the os asks for a redraw when the window contents got lost, e.g. after being covered
+	glfwSetWindowRefreshCallback(window, window_refresh_callback);
+
 	// GLAD initilization
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
 	{
@@ -187,36 +203,58 @@ int main()
 
 	unsigned int transformLoc = glGetUniformLocation(ourShader.ID, "transform");
 	glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
-	glm::mat4 shapeTransform = glm::mat4(1.0f);
-	glm::mat4 shapeScale = glm::mat4(1.0f);
-	glm::mat4 shapeRotate = glm::mat4(1.0f);
+
+	// the shape is a single node, its world matrix only gets recomputed and sent when the input changed it
+	SceneGraph scene;
+	unsigned int shape = scene.addNode(-1);
+	unsigned int drawnVersion = 0;
+	unsigned int framesDrawn = 0, wakeups = 0;
+	double startTime = glfwGetTime();
 	while (!glfwWindowShouldClose(window))
 	{
+		wakeups++;
+
 		// input handler
 		processInput(window);
 
+		// held keys keep changing the shape every frame without sending new events
+		bool animating = inputing || resetShape;
 		if (inputing)
 		{
 			inputing = false;
-			shapeTransform = transByInput * shapeTransform;
-			shapeScale = scaleByInput * shapeScale;
-			shapeRotate = rotateByInput * shapeRotate;
-			transByInput = glm::mat4(1.0f);
-			scaleByInput = glm::mat4(1.0f);
-			rotateByInput = glm::mat4(1.0f);
-			glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(shapeScale * shapeRotate * shapeTransform));
+			LocalTransform transform = scene.getLocal(shape);
+			transform.position += moveByInput;
+			transform.scale *= scaleByInput;
+			transform.rotation = glm::angleAxis(glm::radians(rotateByInput), glm::vec3(0.0f, 0.0f, 1.0f)) * transform.rotation;
+			scene.setLocal(shape, transform);
+			moveByInput = glm::vec3(0.0f);
+			scaleByInput = 1.0f;
+			rotateByInput = 0.0f;
 		}
 		if (resetShape)
 		{
 			resetShape = false;
-			glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
-			shapeTransform = glm::mat4(1.0f);
-			shapeScale = glm::mat4(1.0f);
-			shapeRotate = glm::mat4(1.0f);
+			scene.setLocal(shape, LocalTransform());
+		}
+		if (scene.update() > 0)
+		{
+			ourShader.use();
+			glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(scene.getWorld(shape)));
 		}
 
 		// ----- Rendering stuff
 
+		// nothing changed since the last frame we drew, the one on screen is still right. block until
+		// something happens instead of drawing the same frame again (resizes and key presses are events)
+		if (!continuous && !windowDirty && scene.version() == drawnVersion)
+		{
+			glfwWaitEvents();
+			continue;
+		}
+		drawnVersion = scene.version();
+		windowDirty = false;
+		framesDrawn++;
+
 		// seting the clear color
 		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 		// clear the window color buffer bit
@@ -232,9 +270,11 @@ int main()
 
 		// double buffer mechanism to render things smoothly without user seeing the acutal drawings
 		glfwSwapBuffers(window);
-		// checks if any events are created
-		glfwPollEvents();
+		// checks if any events are created. while nothing is animating the next loop waits for events anyway
+		if (continuous || animating)
+			glfwPollEvents();
 	}
+	std::cout << framesDrawn << " frames drawn, " << wakeups << " wakeups in " << glfwGetTime() - startTime << " s" << std::endl;
 
 	// optional: de-allocate all resources once they've outlived their purpose:
 	// ------------------------------------------------------------------------
@@ -252,6 +292,12 @@ int main()
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
 	glViewport(0, 0, width, height);
+	windowDirty = true;
+}
+
+void window_refresh_callback(GLFWwindow* window)
+{
+	windowDirty = true;
 }
 
 void processInput(GLFWwindow* window)
@@ -262,44 +308,44 @@ void processInput(GLFWwindow* window)
 
 	if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) // move right
 	{
-		transByInput = glm::translate(transByInput, glm::vec3(translateForce, 0.0f, 0.0f));
+		moveByInput.x += translateForce;
 		inputing = true;
 	}
 	if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) // move up
 	{
-		transByInput = glm::translate(transByInput, glm::vec3(0.0f, translateForce, 0.0f));
+		moveByInput.y += translateForce;
 		inputing = true;
 	}
 	if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) // move left
 	{
-		transByInput = glm::translate(transByInput, glm::vec3(-translateForce, 0.0f, 0.0f));
+		moveByInput.x -= translateForce;
 		inputing = true;
 	}
 	if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) // move down
 	{
-		transByInput = glm::translate(transByInput, glm::vec3(0.0f, -translateForce, 0.0f));
+		moveByInput.y -= translateForce;
 		inputing = true;
 	}
 
 	if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS) // scale down
 	{
-		scaleByInput = glm::scale(scaleByInput, glm::vec3(1 - scaleForce, 1 - scaleForce, 1 - scaleForce));
+		scaleByInput *= 1 - scaleForce;
 		inputing = true;
 	}
 	if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS) // scale up
 	{
-		scaleByInput = glm::scale(scaleByInput, glm::vec3(1 + scaleForce, 1 + scaleForce, 1 + scaleForce));
+		scaleByInput *= 1 + scaleForce;
 		inputing = true;
 	}
 
 	if (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS) // Z axis rotate right
 	{
-		rotateByInput = glm::rotate(rotateByInput, glm::radians(rotateForce), glm::vec3(0.0f, 0.0f, 1.0f));
+		rotateByInput += rotateForce;
 		inputing = true;
 	}
 	if (glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS) // Z axis rotate lefts
 	{
-		rotateByInput = glm::rotate(rotateByInput, glm::radians(-rotateForce), glm::vec3(0.0f, 0.0f, 1.0f));
+		rotateByInput -= rotateForce;
 		inputing = true;
 	}
 
@@ -0,0 +1,128 @@
+#pragma once
+#ifndef TRANSFORM_STORE_H
+#define TRANSFORM_STORE_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <JobSystem.h>
+
+// Transforms of a lot of objects kept as structure of arrays: every component in its own tightly
+// packed array, so the batched kernels below read memory linearly and the compiler can vectorize them.
+// rotations are unit quaternions, model matrices come out as translate * rotate * scale.
+class TransformStore
+{
+public:
+	std::vector<float> posX, posY, posZ;
+	std::vector<float> rotX, rotY, rotZ, rotW;
+	std::vector<float> scaleX, scaleY, scaleZ;
+
+	// returns the index of the new transform
+	unsigned int add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+	{
+		posX.push_back(position.x);
+		posY.push_back(position.y);
+		posZ.push_back(position.z);
+		rotX.push_back(rotation.x);
+		rotY.push_back(rotation.y);
+		rotZ.push_back(rotation.z);
+		rotW.push_back(rotation.w);
+		scaleX.push_back(scale.x);
+		scaleY.push_back(scale.y);
+		scaleZ.push_back(scale.z);
+		return (unsigned int)posX.size() - 1;
+	}
+
+	void reserve(size_t count)
+	{
+		std::vector<float>* arrays[10] = { &posX, &posY, &posZ, &rotX, &rotY, &rotZ, &rotW, &scaleX, &scaleY, &scaleZ };
+		for (int i = 0; i < 10; i++)
+			arrays[i]->reserve(count);
+	}
+
+	size_t size() const { return posX.size(); }
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- batched kernels, work on [first, last)
+	// ---------------------------------------------------------
+
+	// writes packed column major mat4s (16 floats each) for [first, last) to out[first * 16 ...].
+	// out is only ever written front to back, so it can point straight into a mapped gpu buffer
+	void computeMatrices(float* out, size_t first, size_t last) const
+	{
+		const float* px = posX.data(); const float* py = posY.data(); const float* pz = posZ.data();
+		const float* qx = rotX.data(); const float* qy = rotY.data(); const float* qz = rotZ.data(); const float* qw = rotW.data();
+		const float* sx = scaleX.data(); const float* sy = scaleY.data(); const float* sz = scaleZ.data();
+
+		for (size_t i = first; i < last; i++)
+		{
+			float xx = qx[i] * qx[i], yy = qy[i] * qy[i], zz = qz[i] * qz[i];
+			float xy = qx[i] * qy[i], xz = qx[i] * qz[i], yz = qy[i] * qz[i];
+			float wx = qw[i] * qx[i], wy = qw[i] * qy[i], wz = qw[i] * qz[i];
+
+			float* m = out + i * 16;
+			m[0] = (1.0f - 2.0f * (yy + zz)) * sx[i];
+			m[1] = 2.0f * (xy + wz) * sx[i];
+			m[2] = 2.0f * (xz - wy) * sx[i];
+			m[3] = 0.0f;
+			m[4] = 2.0f * (xy - wz) * sy[i];
+			m[5] = (1.0f - 2.0f * (xx + zz)) * sy[i];
+			m[6] = 2.0f * (yz + wx) * sy[i];
+			m[7] = 0.0f;
+			m[8] = 2.0f * (xz + wy) * sz[i];
+			m[9] = 2.0f * (yz - wx) * sz[i];
+			m[10] = (1.0f - 2.0f * (xx + yy)) * sz[i];
+			m[11] = 0.0f;
+			m[12] = px[i];
+			m[13] = py[i];
+			m[14] = pz[i];
+			m[15] = 1.0f;
+		}
+	}
+
+	// rotation = delta * rotation for [first, last), renormalized so error doesn't build up over time
+	void applyRotation(const glm::quat& delta, size_t first, size_t last)
+	{
+		float* qx = rotX.data(); float* qy = rotY.data(); float* qz = rotZ.data(); float* qw = rotW.data();
+		for (size_t i = first; i < last; i++)
+		{
+			float x = delta.w * qx[i] + delta.x * qw[i] + delta.y * qz[i] - delta.z * qy[i];
+			float y = delta.w * qy[i] - delta.x * qz[i] + delta.y * qw[i] + delta.z * qx[i];
+			float z = delta.w * qz[i] + delta.x * qy[i] - delta.y * qx[i] + delta.z * qw[i];
+			float w = delta.w * qw[i] - delta.x * qx[i] - delta.y * qy[i] - delta.z * qz[i];
+			float invLength = 1.0f / sqrtf(x * x + y * y + z * z + w * w);
+			qx[i] = x * invLength;
+			qy[i] = y * invLength;
+			qz[i] = z * invLength;
+			qw[i] = w * invLength;
+		}
+	}
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- multithreaded versions
+	// ---------------------------------------------------------
+
+	void computeMatricesParallel(float* out, JobSystem& jobs)
+	{
+		jobs.parallelFor((unsigned int)size(), grainFor(jobs), [&](unsigned int first, unsigned int last) { computeMatrices(out, first, last); });
+	}
+
+	void applyRotationParallel(const glm::quat& delta, JobSystem& jobs)
+	{
+		jobs.parallelFor((unsigned int)size(), grainFor(jobs), [&](unsigned int first, unsigned int last) { applyRotation(delta, first, last); });
+	}
+
+private:
+	// a few ranges per thread so the ones that finish early can steal from the others. ranges are
+	// multiples of 16 objects so two threads never write into the same cache line of a float array
+	size_t grainFor(const JobSystem& jobs) const
+	{
+		size_t grain = size() / (jobs.threadCount() * 4);
+		return std::max((size_t)16, (grain + 15) / 16 * 16);
+	}
+};
+
+#endif // !TRANSFORM_STORE_H
@@ -0,0 +1,428 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <Shader.h>
+#include <stb_image.h>
+#include <Camera.h>
+#include <GLExtensions.h>
+#include <StreamBuffer.h>
+#include <JobSystem.h>
+#include <TransformStore.h>
+#include <SceneGenerator.h>
+#include <FixedTimestep.h>
+#include <chrono>
+#include <cstdlib>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// spacing of the cube grid
+const float CUBE_SPACING = 1.5f;
+
+// timing, deltaTime is the fixed simulation step now, not the frame time
+float deltaTime = 0.0f;
+
+// camera
+Camera camera(glm::vec3(0.0f, 20.0f, 60.0f));
+float lastX = SCR_WIDTH / 2.0f;
+float lastY = SCR_HEIGHT / 2.0f;
+bool firstMouse = true;
+
+int main(int argc, char* argv[])
+{
+	// --count N cubes (a million by default), --threads N to pin the worker count (0 = one per core),
+	// --scene <layout> to start from a generated scene instead of the grid (see SceneGenerator.h),
+	// --hz N how many times a second the cubes get rotated (60 by default)
+	unsigned int numCubes = 1000000;
+	unsigned int threadCount = 0;
+	double simulationHz = 60.0;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+			numCubes = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			threadCount = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--hz") == 0 && i + 1 < argc)
+		{
+			// a rate of 0, below 0 or not a number would make the step infinite or negative
+			simulationHz = atof(argv[++i]);
+			if (!(simulationHz > 0.0 && simulationHz <= 10000.0))
+			{
+				std::cout << "ERROR::ARGS::INVALID_HZ " << argv[i] << ", using 60" << std::endl;
+				simulationHz = 60.0;
+			}
+		}
+	}
+	SceneOptions sceneOptions;
+	sceneOptions.count = numCubes;
+	bool generatedScene = parseSceneOptions(argc, argv, sceneOptions);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- GlAD, GLFW and OpenGL setup
+	// ---------------------------------------------------------
+
+	// initilize the glfw library
+	glfwInit();
+
+	// ----- Setting glfw options
+
+	// ask for 4.5 so we get persistent mapping, and drop back to 3.3 if the driver can't do it
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+
+	// we specify that we only want the core features of OpenGL
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	// -----
+
+	// creating our window and configuring it's width, height and name
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+	}
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	// we tell the glfw that set our window to the current thread's context
+	glfwMakeContextCurrent(window);
+
+	// a callback to resize the window when the user resized the window
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	// a callback to know the mouse position and calculate the direction of the camera
+	glfwSetCursorPosCallback(window, mouse_callback);
+
+	// to get mouse scroller input
+	glfwSetScrollCallback(window, scroll_callback);
+
+	// tell GLFW to capture our mouse
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	// GLAD initilization
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initilize GLAD" << std::endl;
+		return -1;
+	}
+	loadGLExtensions();
+
+	// configure global opengl state
+	// -----------------------------
+	// for z buffer
+	glEnable(GL_DEPTH_TEST);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- VBO, VAO & instance buffer
+	// ---------------------------------------------------------
+
+	// loading the shader
+	Shader ourShader("instancedShader.verts", "textureShader.frags");
+
+	// cube with texture
+	float vertices[] = {
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+	};
+
+	unsigned int VBO, VAO;
+	glGenBuffers(1, &VBO);
+	glGenVertexArrays(1, &VAO);
+
+	glBindVertexArray(VAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+	// for positions
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	// for texture coords
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+
+	// per instance model matrices. a mat4 attribute is 4 vec4 attributes, one per column,
+	// and the actual offset gets pointed at every frame once we know where this frame's data is
+	StreamBuffer instanceBuffer(GL_ARRAY_BUFFER, numCubes * sizeof(glm::mat4));
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		glEnableVertexAttribArray(2 + i);
+		glVertexAttribDivisor(2 + i, 1);
+	}
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Transforms
+	// ---------------------------------------------------------
+
+	TransformStore transforms;
+	transforms.reserve(numCubes);
+	if (generatedScene)
+	{
+		std::vector<SceneObject> scene = generateScene(sceneOptions);
+		for (unsigned int i = 0; i < numCubes; i++)
+			transforms.add(scene[i].position, glm::angleAxis(glm::radians(scene[i].angle), scene[i].rotationAxis), scene[i].scale);
+	}
+
+	// or cubes on a square grid, each one starting at a different angle and size
+	unsigned int grid = (unsigned int)ceil(sqrt((double)numCubes));
+	for (unsigned int i = 0; i < numCubes && !generatedScene; i++)
+	{
+		float x = ((float)(i % grid) - grid / 2.0f) * CUBE_SPACING;
+		float z = ((float)(i / grid) - grid / 2.0f) * CUBE_SPACING;
+		glm::quat rotation = glm::angleAxis(glm::radians(20.0f * (i % 18)), glm::normalize(glm::vec3(0.5f, 1.0f, 0.0f)));
+		transforms.add(glm::vec3(x, 0.0f, z), rotation, glm::vec3(0.5f + 0.5f * (i % 3) / 2.0f));
+	}
+
+	// the transform kernels are split into jobs, the workers live as long as the demo
+	JobSystem jobs(threadCount);
+	std::cout << numCubes << " transforms, " << jobs.threadCount() << " threads" << std::endl;
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- Texture
+	// ---------------------------------------------------------
+
+	unsigned int texture1;
+	glGenTextures(1, &texture1);
+	glBindTexture(GL_TEXTURE_2D, texture1);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int width1, height1, nrChannels1;
+	unsigned char* data1 = stbi_load("container.jpg", &width1, &height1, &nrChannels1, 0);
+	if (data1)
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width1, height1, 0, GL_RGB, GL_UNSIGNED_BYTE, data1);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else
+	{
+		std::cout << "Failed to load texture1" << std::endl;
+	}
+	stbi_image_free(data1);
+
+	unsigned int texture2;
+	glGenTextures(1, &texture2);
+	glBindTexture(GL_TEXTURE_2D, texture2);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int width2, height2, nrChannels2;
+	stbi_set_flip_vertically_on_load(true);
+	unsigned char* data2 = stbi_load("awesomeface.png", &width2, &height2, &nrChannels2, 0);
+	if (data2)
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width2, height2, 0, GL_RGBA, GL_UNSIGNED_BYTE, data2);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else
+	{
+		std::cout << "Failed to load texture2" << std::endl;
+	}
+	stbi_image_free(data2);
+
+	ourShader.use(); // don't forget to activate the shader before setting uniforms!
+	ourShader.setInt("texture1", 0);
+	ourShader.setInt("texture2", 1);
+
+	// ---------------------------------------------------------
+	// --------------------------------------------------------- our render loop (smth like update in unity!)
+	// ---------------------------------------------------------
+
+	glm::mat4 view = glm::mat4(1.0f);
+	glm::mat4 projection = glm::mat4(1.0f);
+
+	// stats are averaged and printed once a second
+	double statsStart = glfwGetTime();
+	unsigned int statsFrames = 0;
+	double statsTransformMs = 0.0;
+
+	FixedTimestep timestep(1.0 / simulationHz);
+	glm::vec3 previousCameraPosition = camera.Position;
+
+	while (!glfwWindowShouldClose(window))
+	{
+		// ---- simulation: input and spinning the cubes run at a fixed rate, a faster frame rate
+		// doesn't make rotating a million quaternions happen more often
+		unsigned int steps = timestep.advance(glfwGetTime());
+		deltaTime = timestep.stepSeconds();
+		auto transformStart = std::chrono::high_resolution_clock::now();
+		for (unsigned int s = 0; s < steps; s++)
+		{
+			previousCameraPosition = camera.Position;
+			processInput(window);
+			transforms.applyRotationParallel(glm::angleAxis(deltaTime, glm::vec3(0.0f, 1.0f, 0.0f)), jobs);
+		}
+
+		// ---- write the model matrices straight into the mapped buffer. the cubes are drawn as of the last step,
+		// interpolating a million rotations would cost about as much as the step, only the camera is interpolated
+		instanceBuffer.beginFrame();
+		StreamBuffer::Allocation models = instanceBuffer.allocate(numCubes * sizeof(glm::mat4));
+		if (models.ptr != NULL)
+			transforms.computeMatricesParallel((float*)models.ptr, jobs);
+		statsTransformMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - transformStart).count();
+		instanceBuffer.flush();
+
+		// ----- Rendering stuff
+
+		// seting the clear color
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		// clear the window color buffer bit and z buffer bit
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture1);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, texture2);
+
+		ourShader.use();
+		Camera renderCamera = camera;
+		renderCamera.Position = interpolate(previousCameraPosition, camera.Position, timestep.alpha());
+		view = renderCamera.GetViewMatrix();
+		projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 2000.0f);
+		ourShader.setMat4("view", view);
+		ourShader.setMat4("projection", projection);
+
+		glBindVertexArray(VAO);
+		if (models.ptr != NULL)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer.ID);
+			for (unsigned int i = 0; i < 4; i++)
+				glVertexAttribPointer(2 + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(models.offset + i * sizeof(glm::vec4)));
+			glDrawArraysInstanced(GL_TRIANGLES, 0, 36, numCubes);
+		}
+
+		// fence the region we just drew from so we don't overwrite it while the gpu still reads it
+		instanceBuffer.endFrame();
+
+		statsFrames++;
+		if (glfwGetTime() - statsStart >= 1.0)
+		{
+			std::cout << "transform update " << statsTransformMs / statsFrames << " ms/frame, fence wait "
+				<< instanceBuffer.lastFenceWaitMs << " ms, " << statsFrames << " fps" << std::endl;
+			statsStart = glfwGetTime();
+			statsFrames = 0;
+			statsTransformMs = 0.0;
+		}
+
+		// double buffer mechanism to render things smoothly without user seeing the acutal drawings
+		glfwSwapBuffers(window);
+		// checks if any events are created
+		glfwPollEvents();
+	}
+
+	// optional: de-allocate all resources once they've outlived their purpose:
+	// ------------------------------------------------------------------------
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	instanceBuffer.destroy();
+
+	// glfw: terminate, clearing all previously allocated GLFW resources.
+	// ------------------------------------------------------------------
+	glfwTerminate();
+
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+}
+
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(RIGHT, deltaTime);
+}
+
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+	if (firstMouse) // initially set to true
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	float xoffset = xpos - lastX;
+	float yoffset = lastY - ypos; // reversed since y-coordinates range from bottom to top
+	lastX = xpos;
+	lastY = ypos;
+
+	camera.ProcessMouseMovement(xoffset, yoffset, true);
+}
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.ProcessMouseScroll(yoffset);
+}
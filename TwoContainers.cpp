@@ -7,6 +7,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <SceneGraph.h>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window);
@@ -17,9 +18,10 @@ const unsigned int SCR_HEIGHT = 600;
 
 bool inputing = false;
 bool resetShape = false;
-glm::mat4 transByInput = glm::mat4(1.0f);
-glm::mat4 scaleByInput = glm::mat4(1.0f);
-glm::mat4 rotateByInput = glm::mat4(1.0f);
+// input gathered this frame, applied to the shape's node in the scene graph
+glm::vec3 moveByInput = glm::vec3(0.0f);
+float scaleByInput = 1.0f;
+float rotateByInput = 0.0f;
 const float translateForce = 0.005f;
 const float scaleForce = 0.005f;
 const float rotateForce = 1.0f;
@@ -187,10 +189,15 @@ int main()
 
 	unsigned int transformLoc = glGetUniformLocation(ourShader.ID, "transform");
 	glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
-	glm::mat4 shapeTransform = glm::mat4(1.0f);
-	glm::mat4 shape2Transform = glm::mat4(1.0f);
-	glm::mat4 shapeScale = glm::mat4(1.0f);
-	glm::mat4 shapeRotate = glm::mat4(1.0f);
+
+	// the small container is a child of the big one: it sits on its top right corner, spins by
+	// itself and follows the big one around when the input moves, scales or rotates it
+	SceneGraph scene;
+	unsigned int container = scene.addNode(-1);
+	LocalTransform smallTransform;
+	smallTransform.position = glm::vec3(0.75f, 0.75f, 0.0f);
+	smallTransform.scale = glm::vec3(0.25f, 0.25f, 0.25f);
+	unsigned int smallContainer = scene.addNode(container, smallTransform);
 	while (!glfwWindowShouldClose(window))
 	{
 		// input handler
@@ -199,23 +206,22 @@ int main()
 		if (inputing)
 		{
 			inputing = false;
-			shapeTransform = transByInput * shapeTransform;
-			shape2Transform = -transByInput * shapeTransform;
-			shapeScale = scaleByInput * shapeScale;
-			shapeRotate = rotateByInput * shapeRotate;
-			transByInput = glm::mat4(1.0f);
-			scaleByInput = glm::mat4(1.0f);
-			rotateByInput = glm::mat4(1.0f);
-			glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(shapeScale * shapeRotate * shapeTransform));
+			LocalTransform transform = scene.getLocal(container);
+			transform.position += moveByInput;
+			transform.scale *= scaleByInput;
+			transform.rotation = glm::angleAxis(glm::radians(rotateByInput), glm::vec3(0.0f, 0.0f, 1.0f)) * transform.rotation;
+			scene.setLocal(container, transform);
+			moveByInput = glm::vec3(0.0f);
+			scaleByInput = 1.0f;
+			rotateByInput = 0.0f;
 		}
 		if (resetShape)
 		{
 			resetShape = false;
-			glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
-			shapeTransform = glm::mat4(1.0f);
-			shapeScale = glm::mat4(1.0f);
-			shapeRotate = glm::mat4(1.0f);
+			scene.setLocal(container, LocalTransform());
 		}
+		scene.setRotation(smallContainer, glm::angleAxis((float)glfwGetTime(), glm::vec3(0.0f, 0.0f, 1.0f)));
+		scene.update();
 
 		// ----- Rendering stuff
 
@@ -230,17 +236,9 @@ int main()
 
 		ourShader.use();
 		glBindVertexArray(VAO);
-		glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(shapeScale * shapeRotate * shapeTransform));
+		glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(scene.getWorld(container)));
 		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
-
-		glm::mat4 shape2Scale = glm::mat4(1.0f);
-		shape2Scale = glm::scale(shape2Scale, glm::vec3(0.25f, 0.25f, 0.25f));
-		glm::mat4 shape2Trans = glm::mat4(1.0f);
-		shape2Trans = glm::translate(shape2Trans, glm::vec3(-0.75f, 0.75f, 0.75f));
-		glm::mat4 shape2Rot = glm::mat4(1.0f);
-		shape2Rot = glm::rotate(shape2Rot, (float)glfwGetTime(), glm::vec3(0.0f, 0.0f, 1.0f));
-		glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(shape2Scale * shape2Rot * shape2Trans));
+		glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(scene.getWorld(smallContainer)));
 		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
 		// double buffer mechanism to render things smoothly without user seeing the acutal drawings
@@ -275,44 +273,44 @@ void processInput(GLFWwindow* window)
 
 	if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) // move right
 	{
-		transByInput = glm::translate(transByInput, glm::vec3(translateForce, 0.0f, 0.0f));
+		moveByInput.x += translateForce;
 		inputing = true;
 	}
 	if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) // move up
 	{
-		transByInput = glm::translate(transByInput, glm::vec3(0.0f, translateForce, 0.0f));
+		moveByInput.y += translateForce;
 		inputing = true;
 	}
 	if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) // move left
 	{
-		transByInput = glm::translate(transByInput, glm::vec3(-translateForce, 0.0f, 0.0f));
+		moveByInput.x -= translateForce;
 		inputing = true;
 	}
 	if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) // move down
 	{
-		transByInput = glm::translate(transByInput, glm::vec3(0.0f, -translateForce, 0.0f));
+		moveByInput.y -= translateForce;
 		inputing = true;
 	}
 
 	if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS) // scale down
 	{
-		scaleByInput = glm::scale(scaleByInput, glm::vec3(1 - scaleForce, 1 - scaleForce, 1 - scaleForce));
+		scaleByInput *= 1 - scaleForce;
 		inputing = true;
 	}
 	if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS) // scale up
 	{
-		scaleByInput = glm::scale(scaleByInput, glm::vec3(1 + scaleForce, 1 + scaleForce, 1 + scaleForce));
+		scaleByInput *= 1 + scaleForce;
 		inputing = true;
 	}
 
 	if (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS) // Z axis rotate right
 	{
-		rotateByInput = glm::rotate(rotateByInput, glm::radians(rotateForce), glm::vec3(0.0f, 0.0f, 1.0f));
+		rotateByInput += rotateForce;
 		inputing = true;
 	}
 	if (glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS) // Z axis rotate lefts
 	{
-		rotateByInput = glm::rotate(rotateByInput, glm::radians(-rotateForce), glm::vec3(0.0f, 0.0f, 1.0f));
+		rotateByInput -= rotateForce;
 		inputing = true;
 	}
 